@@ -1,5 +1,8 @@
 /*
- * Benchmark: Montgomery vs __uint128_t for Miller-Rabin
+ * Benchmark: Montgomery vs __uint128_t for Miller-Rabin, and the
+ * Montgomery kernel variants of arith_montgomery.h (reduced, lazy, MULX)
+ *
+ * Compile: make benchmark-montgomery
  */
 #include <stdio.h>
 #include <stdint.h>
@@ -57,6 +60,47 @@ static inline bool is_prime_fj64_montgomery(uint64_t n) {
     return mr_witness_montgomery(n, fj64_bases[fj64_hash(n)]);
 }
 
+/* FJ64 test as is_prime_fj64_fast, with the given Montgomery kernel (n < 2^63) */
+static inline __attribute__((always_inline)) bool is_prime_fj64_kernel(uint64_t n, int kernel) {
+    uint64_t n_inv = montgomery_inverse(n);
+    uint64_t one_m = montgomery_one(n);
+    if (!mr_witness_montgomery_base2_k(n, n_inv, one_m, kernel))
+        return false;
+    uint64_t a = fj64_bases[fj64_hash(n)];
+    if (a >= n) a %= n;
+    if (a == 0) return true;
+    uint64_t r_sq = montgomery_r_squared_fast(n, n_inv, one_m);
+    return mr_witness_montgomery_form_k(n, montgomery_mul(a, r_sq, n, n_inv), n_inv,
+                                        one_m, kernel);
+}
+
+/* Best of 10 passes over the candidates, seconds per pass; *primes = count */
+static double time_kernel(const uint64_t *candidates, int num, int kernel, int *primes) {
+    double best = 1e30;
+    for (int rep = 0; rep < 10; rep++) {
+        int count = 0;
+        clock_t t0 = clock();
+        switch (kernel) {
+        case MONTGOMERY_KERNEL_LAZY:
+            for (int i = 0; i < num; i++)
+                count += is_prime_fj64_kernel(candidates[i], MONTGOMERY_KERNEL_LAZY);
+            break;
+        case MONTGOMERY_KERNEL_MULX:
+            for (int i = 0; i < num; i++)
+                count += is_prime_fj64_kernel(candidates[i], MONTGOMERY_KERNEL_MULX);
+            break;
+        default:
+            for (int i = 0; i < num; i++)
+                count += is_prime_fj64_kernel(candidates[i], MONTGOMERY_KERNEL_REDUCED);
+            break;
+        }
+        double t = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        if (t < best) best = t;
+        *primes = count;
+    }
+    return best;
+}
+
 /* Generate prime candidates (simple sieve for small values) */
 static inline bool is_candidate_for_bench(uint64_t n) {
     if (n < 2) return false;
@@ -83,7 +127,6 @@ int main(void) {
 
     for (int t = 0; t < 4; t++) {
         uint64_t start = starts[t];
-        uint64_t count = 100000;
 
         /* Generate candidates that would pass trial division */
         uint64_t candidates[10000];
@@ -130,7 +173,24 @@ int main(void) {
         printf("  Montgomery: %.4f sec (%.0f tests/sec)\n",
                time_mont, num_candidates / time_mont);
         printf("  Speedup:    %.2fx\n", time_std / time_mont);
-        printf("  Primes found: %d\n\n", prime_count_std);
+        printf("  Primes found: %d\n", prime_count_std);
+
+        /* Kernel variants (is_prime_fj64_fast with each) */
+        double time_reduced = 0;
+        for (int k = 0; k < 3; k++) {
+            int primes;
+            double time_k = time_kernel(candidates, num_candidates, k, &primes);
+            if (k == 0) time_reduced = time_k;
+            printf("  Kernel %-8s %6.1f ns/test  %.2fx%s%s\n", MONTGOMERY_KERNEL_NAMES[k],
+                   time_k / num_candidates * 1e9, time_reduced / time_k,
+                   k == MONTGOMERY_KERNEL ? "  (default)" : "",
+                   k == MONTGOMERY_KERNEL_MULX && !MONTGOMERY_HAVE_MULX
+                       ? "  (no BMI2/ADX: reduced)" : "");
+            if (primes != prime_count_std) {
+                printf("  ERROR: kernel %s found %d primes\n", MONTGOMERY_KERNEL_NAMES[k], primes);
+            }
+        }
+        printf("\n");
     }
 
     /* Verify correctness on known primes and composites */
@@ -153,6 +213,10 @@ int main(void) {
         if (n < 128) continue;  /* Skip small primes handled specially */
         bool std = is_prime_fj64_standard(n);
         bool mont = is_prime_fj64_montgomery(n);
+        if (n < MONTGOMERY_SAFE_THRESHOLD) {
+            mont &= is_prime_fj64_kernel(n, MONTGOMERY_KERNEL_LAZY) &&
+                    is_prime_fj64_kernel(n, MONTGOMERY_KERNEL_MULX);
+        }
         if (std != mont || !std) {
             printf("  FAIL: %llu should be prime (std=%d, mont=%d)\n",
                    (unsigned long long)n, std, mont);
@@ -0,0 +1,154 @@
+/*
+ * Generate include/fj32_table.h (FJ32 single-witness bases)
+ *
+ * Finds, for each of the FJ32_BUCKETS hash buckets, a Miller-Rabin base
+ * that no odd composite n < 2^32 in that bucket passes, considering only
+ * composites without a prime factor <= 127 (trial division removes the
+ * rest before the search calls is_prime_fj32_fast()).
+ *
+ * Every bucket starts at base 2. Each round sieves [131, 2^32) in segments
+ * and runs mr_witness_montgomery32() on the trial-division survivors of the
+ * buckets still open; a bucket with a strong pseudoprime moves to its next
+ * base and stays open for the next round. The first round also tests every
+ * survivor that is prime, as a check on the 32-bit Montgomery arithmetic.
+ *
+ * Compile: make fj32-table   (writes include/fj32_table.h, ~8 minutes)
+ * Usage:   ./analysis/gen_fj32_table > include/fj32_table.h
+ */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime */
+#define FJ32_GENERATOR
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/prime32.h"
+
+#define LIMIT        (1ULL << 32)
+#define SEGMENT_ODDS (1u << 20)          /* Odd numbers per segment */
+#define SIEVE_LIMIT  65536               /* > sqrt(2^32) */
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t sieve_primes[8192];
+static int num_sieve_primes;
+
+static void init_sieve_primes(void) {
+    static bool composite[SIEVE_LIMIT];
+    for (uint32_t i = 3; i < SIEVE_LIMIT; i += 2) {
+        if (composite[i]) continue;
+        sieve_primes[num_sieve_primes++] = i;
+        for (uint32_t j = i * i; j < SIEVE_LIMIT; j += 2 * i) composite[j] = true;
+    }
+}
+
+/* Mark odd multiples of p in [lo, lo + 2*SEGMENT_ODDS), lo odd */
+static void mark(uint8_t *flags, uint64_t lo, uint32_t p, uint64_t from) {
+    uint64_t first = (lo + p - 1) / p * p;
+    if (first < from) first = from;
+    if ((first & 1) == 0) first += p;
+    for (uint64_t m = first; m < lo + 2ULL * SEGMENT_ODDS; m += 2ULL * p) {
+        flags[(m - lo) >> 1] = 1;
+    }
+}
+
+/*
+ * One pass over [131, 2^32). Tests survivors in open buckets with the
+ * bucket's current base; sets failed[] for buckets with a pseudoprime.
+ * Returns the number of Miller-Rabin tests run, or 0 on an arithmetic error.
+ */
+static uint64_t run_round(const uint16_t *bases, const bool *open, bool *failed,
+                          bool check_primes) {
+    static uint8_t small[SEGMENT_ODDS], composite[SEGMENT_ODDS];
+    uint64_t tests = 0;
+
+    for (uint64_t lo = 131; lo < LIMIT; lo += 2ULL * SEGMENT_ODDS) {
+        memset(small, 0, sizeof(small));
+        memset(composite, 0, sizeof(composite));
+        for (int i = 0; i < num_sieve_primes; i++) {
+            uint32_t p = sieve_primes[i];
+            if ((uint64_t)p * p >= lo + 2ULL * SEGMENT_ODDS) break;
+            if (p <= 127) {
+                mark(small, lo, p, p);
+            } else {
+                mark(composite, lo, p, (uint64_t)p * p);
+            }
+        }
+
+        for (uint32_t i = 0; i < SEGMENT_ODDS; i++) {
+            uint64_t n = lo + 2ULL * i;
+            if (n >= LIMIT) break;
+            if (small[i]) continue;
+            if (!composite[i] && !check_primes) continue;
+            uint32_t bucket = fj32_hash((uint32_t)n);
+            if (!open[bucket]) continue;
+
+            tests++;
+            bool probable = mr_witness_montgomery32((uint32_t)n, bases[bucket]);
+            if (!composite[i] && !probable) {
+                fprintf(stderr, "error: prime %llu fails base %u\n",
+                        (unsigned long long)n, bases[bucket]);
+                return 0;
+            }
+            if (composite[i] && probable) failed[bucket] = true;
+        }
+    }
+    return tests;
+}
+
+int main(void) {
+    static uint16_t bases[FJ32_BUCKETS];
+    static bool open[FJ32_BUCKETS], failed[FJ32_BUCKETS];
+
+    init_sieve_primes();
+    for (int b = 0; b < FJ32_BUCKETS; b++) {
+        bases[b] = 2;
+        open[b] = true;
+    }
+
+    int num_open = FJ32_BUCKETS;
+    for (int round = 1; num_open > 0; round++) {
+        double t0 = get_time();
+        memset(failed, 0, sizeof(failed));
+        uint64_t tests = run_round(bases, open, failed, round == 1);
+        if (tests == 0) return 1;
+
+        num_open = 0;
+        for (int b = 0; b < FJ32_BUCKETS; b++) {
+            open[b] = failed[b];
+            if (failed[b]) {
+                if (bases[b] == UINT16_MAX) {
+                    fprintf(stderr, "error: bucket %d ran out of bases\n", b);
+                    return 1;
+                }
+                bases[b]++;
+                num_open++;
+            }
+        }
+        fprintf(stderr, "round %d: %llu tests, %d buckets still open (%.1f s)\n",
+                round, (unsigned long long)tests, num_open, get_time() - t0);
+    }
+
+    printf("/* Generated by analysis/gen_fj32_table.c - do not edit */\n");
+    printf("static const uint16_t fj32_bases[%d] = {\n", FJ32_BUCKETS);
+    for (int b = 0; b < FJ32_BUCKETS; b++) {
+        char item[16];
+        bool last = (b + 1 == FJ32_BUCKETS);
+        snprintf(item, sizeof(item), "%u%s", bases[b], last ? "};" : ",");
+        if (b % 16 == 0) printf("    ");
+        if (b % 16 == 15 || last) {
+            printf("%s\n", item);
+        } else {
+            printf("%-7s", item);
+        }
+    }
+    return 0;
+}
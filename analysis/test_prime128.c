@@ -0,0 +1,122 @@
+/*
+ * Test prime128.h (BPSW) and isqrt128()
+ *
+ * Checks is_prime_bpsw128() against the exact FJ64_262K test on every
+ * trial-division survivor below 3,000,000 and on random 64-bit survivors,
+ * the strong Lucas component on known strong Lucas pseudoprimes, and
+ * is_prime_128() on known primes and composites above 2^64.
+ *
+ * Compile: make test-128
+ * Usage:   ./analysis/test_prime128 [count]   (default: 200,000 random)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/fmt.h"
+#include "../include/solve.h"
+#include "../include/prime128.h"
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t xorshift64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static __uint128_t u128(uint64_t hi, uint64_t lo) {
+    return ((__uint128_t)hi << 64) | lo;
+}
+
+static uint64_t check(bool got, bool expected, const char *what, __uint128_t n) {
+    if (got == expected) return 0;
+    printf("  MISMATCH (%s): n = 0x%016llx%016llx, expected %d, got %d\n", what,
+           (unsigned long long)(uint64_t)(n >> 64), (unsigned long long)(uint64_t)n,
+           expected, got);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t count = 200000;
+    if (argc > 1) count = strtoull(argv[1], NULL, 10);
+
+    printf("128-bit Primality Test\n");
+    printf("======================\n\n");
+
+    uint64_t errors = 0;
+
+    /* Exhaustive: every trial-division survivor in (127, 3e6) */
+    uint64_t tested = 0;
+    for (uint64_t n = 129; n < 3000000; n += 2) {
+        if (trial_division_check(n) != 2) continue;
+        errors += check(is_prime_bpsw128(n), is_prime_64(n), "small", n);
+        tested++;
+    }
+    printf("  %-32s %s tested\n", "Survivors below 3,000,000", fmt_num(tested));
+
+    /* Random 64-bit survivors */
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t n;
+        do {
+            n = xorshift64() | 1;
+        } while (n <= 127 || trial_division_check(n) != 2);
+        errors += check(is_prime_bpsw128(n), is_prime_64(n), "random", n);
+    }
+    printf("  %-32s %s tested\n", "Random 64-bit survivors", fmt_num(count));
+
+    /* Strong Lucas pseudoprimes: pass the Lucas test, fail BPSW */
+    const uint64_t slpsp[] = {
+        5459, 5777, 10877, 16109, 18971, 22499, 24569, 25199,
+        40309, 58519, 75077, 97439, 100127, 113573, 115639, 130139,
+    };
+    const int num_slpsp = (int)(sizeof(slpsp) / sizeof(slpsp[0]));
+    for (int i = 0; i < num_slpsp; i++) {
+        errors += check(is_slprp_128(slpsp[i]), true, "slpsp Lucas", slpsp[i]);
+        errors += check(is_prime_128(slpsp[i]), false, "slpsp BPSW", slpsp[i]);
+    }
+    printf("  %-32s %d tested\n", "Strong Lucas pseudoprimes", num_slpsp);
+
+    /* Above 2^64 */
+    const __uint128_t m61 = ((__uint128_t)1 << 61) - 1;
+    const struct { __uint128_t n; bool prime; } big[] = {
+        { u128(1, 13), true },                          /* 2^64 + 13 */
+        { ((__uint128_t)1 << 89) - 1, true },           /* Mersenne */
+        { ((__uint128_t)1 << 107) - 1, true },          /* Mersenne */
+        { ((__uint128_t)1 << 127) - 1, true },          /* Mersenne */
+        { u128(UINT64_MAX, UINT64_MAX - 158), true },   /* 2^128 - 159 */
+        { u128(1, 1), false },                          /* 2^64 + 1 = 274177 * 67280421310721 */
+        { u128(1, 11), false },
+        { ((__uint128_t)1 << 67) - 1, false },          /* 193707721 * 761838257287 */
+        { u128(UINT64_MAX, UINT64_MAX), false },        /* 2^128 - 1 */
+        { m61 * m61, false },                           /* Square of a prime */
+        { m61 * (((__uint128_t)1 << 31) - 1), false },  /* Two Mersenne primes */
+        { m61 * 1000000007ULL, false },
+    };
+    const int num_big = (int)(sizeof(big) / sizeof(big[0]));
+    for (int i = 0; i < num_big; i++) {
+        errors += check(is_prime_128(big[i].n), big[i].prime, "big", big[i].n);
+    }
+    printf("  %-32s %d tested\n", "Known values above 2^64", num_big);
+
+    /* isqrt128 around perfect squares */
+    uint64_t sqrt_errors = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t r = xorshift64();
+        if (i < 4) r = UINT64_MAX - i;
+        __uint128_t sq = (__uint128_t)r * r;
+        if (isqrt128(sq) != r) sqrt_errors++;
+        if (isqrt128(sq - 1) != r - 1) sqrt_errors++;
+        if (r < UINT64_MAX && isqrt128(sq + 2 * (__uint128_t)r) != r) sqrt_errors++;
+    }
+    if (isqrt64(UINT64_MAX) != 0xFFFFFFFFULL) sqrt_errors++;
+    printf("  %-32s %s tested, %s errors\n", "isqrt128 around squares",
+           fmt_num(count), fmt_num(sqrt_errors));
+    errors += sqrt_errors;
+
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ * Test and benchmark prime_ifma.h (AVX-512 IFMA Miller-Rabin)
+ *
+ * Checks is_prime_fj64_x8() against is_prime_fj64_standard() on:
+ *   - known strong pseudoprimes to base 2 and primes around 2^52
+ *   - random odd n in (127, 2^52), uniform in bit length
+ *   - random odd n in (127, 2^52) that survive trial division
+ *     (the inputs the search actually produces)
+ *
+ * Compile: make test-ifma
+ * Usage:   ./analysis/test_prime_ifma [count]   (default: 4,000,000 per set)
+ */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "../include/fmt.h"
+#include "../include/solve.h"
+#include "../include/prime_ifma.h"
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t xorshift64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Random odd n in (127, 2^52) with a uniformly chosen bit length */
+static uint64_t random_candidate(void) {
+    while (1) {
+        int bits = 8 + (int)(xorshift64() % 45);  /* 8..52 */
+        uint64_t n = (xorshift64() >> (64 - bits)) | 1 | (1ULL << (bits - 1));
+        if (n > 127 && n < IFMA_LIMIT) return n;
+    }
+}
+
+/* Compare one group of 8 against the scalar reference */
+static uint64_t check_group(const uint64_t *n) {
+    uint8_t mask = is_prime_fj64_x8(n);
+    uint64_t errors = 0;
+    for (int i = 0; i < IFMA_LANES; i++) {
+        bool expected = is_prime_fj64_standard(n[i]);
+        bool got = (mask >> i) & 1;
+        if (got != expected) {
+            if (errors < 10) {
+                printf("  MISMATCH: n = %llu, expected %d, got %d\n",
+                       (unsigned long long)n[i], expected, got);
+            }
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static uint64_t run_random(uint64_t count, bool filtered, const char *label) {
+    uint64_t errors = 0, primes = 0;
+    uint64_t group[IFMA_LANES];
+
+    for (uint64_t done = 0; done < count; done += IFMA_LANES) {
+        for (int i = 0; i < IFMA_LANES; i++) {
+            uint64_t n;
+            do {
+                n = random_candidate();
+            } while (filtered && trial_division_check(n) != 2);
+            group[i] = n;
+        }
+        errors += check_group(group);
+        primes += __builtin_popcount(is_prime_fj64_x8(group));
+    }
+    printf("  %-28s %s tested, %s prime, %s errors\n", label,
+           fmt_num(count), fmt_num(primes), fmt_num(errors));
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t count = 4000000;
+    if (argc > 1) count = strtoull(argv[1], NULL, 10);
+    count = (count + IFMA_LANES - 1) / IFMA_LANES * IFMA_LANES;
+
+    printf("IFMA Miller-Rabin Test\n");
+    printf("======================\n");
+    printf("IFMA kernel: %s\n\n", prime_ifma_available()
+           ? "available (AVX-512 IFMA)" : "not available, testing scalar fallback");
+
+    uint64_t errors = 0;
+
+    /* Strong pseudoprimes to base 2, Carmichael numbers, primes near 2^52 */
+    const uint64_t special[] = {
+        2047, 3277, 4033, 4681, 8321, 15841, 29341, 42799, 49141, 52633,
+        65281, 74665, 80581, 85489, 88357, 90751, 561, 1105, 1729, 2465,
+        3215031751ULL, 2152302898747ULL, 3474749660383ULL, 341550071728321ULL,
+        4503599627370449ULL, 4503599627370353ULL, 4503599627370337ULL,
+        4503599627370495ULL, 4503599627370493ULL, 4503599627370491ULL,
+        131, 137, 139, 149, 65537, 65539, 1000000007ULL, 999999999989ULL,
+    };
+    const int num_special = (int)(sizeof(special) / sizeof(special[0]));
+    uint64_t group[IFMA_LANES];
+    for (int i = 0; i < num_special; i += IFMA_LANES) {
+        for (int j = 0; j < IFMA_LANES; j++) {
+            group[j] = special[(i + j) % num_special];
+        }
+        errors += check_group(group);
+    }
+    printf("  %-28s %d tested, %s errors\n", "Special values", num_special, fmt_num(errors));
+
+    errors += run_random(count, false, "Random odd n < 2^52");
+    errors += run_random(count, true, "Trial-division survivors");
+
+    /* Throughput on trial-division survivors around 10^12 */
+    const uint64_t bench_count = 1 << 20;
+    uint64_t *bench = (uint64_t*)malloc(bench_count * sizeof(uint64_t));
+    if (!bench) return 1;
+    for (uint64_t i = 0; i < bench_count; i++) {
+        uint64_t n;
+        do {
+            n = (xorshift64() >> 24) | 1;
+        } while (n <= 127 || trial_division_check(n) != 2);
+        bench[i] = n;
+    }
+
+    double t0 = get_time();
+    uint64_t scalar_primes = 0;
+    for (uint64_t i = 0; i < bench_count; i++) {
+        scalar_primes += is_prime_fj64_fast(bench[i]);
+    }
+    double t1 = get_time();
+    uint64_t x8_primes = 0;
+    for (uint64_t i = 0; i < bench_count; i += IFMA_LANES) {
+        x8_primes += __builtin_popcount(is_prime_fj64_x8(&bench[i]));
+    }
+    double t2 = get_time();
+
+    printf("\nThroughput (40-bit trial-division survivors):\n");
+    printf("  Scalar is_prime_fj64_fast:  %.1f ns/candidate\n", (t1 - t0) / bench_count * 1e9);
+    printf("  is_prime_fj64_x8:           %.1f ns/candidate (%.2fx)\n",
+           (t2 - t1) / bench_count * 1e9, (t1 - t0) / (t2 - t1));
+    if (scalar_primes != x8_primes) {
+        printf("  MISMATCH: prime counts differ (%llu vs %llu)\n",
+               (unsigned long long)scalar_primes, (unsigned long long)x8_primes);
+        errors++;
+    }
+    free(bench);
+
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * Test and benchmark prime_interleaved.h (FP trial division in Miller-Rabin)
+ *
+ * Checks is_prime_fj64_interleaved() against is_prime_64() on:
+ *   - the primes 131-467 themselves, their products with primes near 2^52,
+ *     n = 1 and -1 mod each of them near 2^52, strong pseudoprimes to base 2
+ *   - every trial-division survivor in windows at 2^32 and below 2^52
+ *   - random trial-division survivors in (127, 2^52), uniform in bit length
+ * and times it against is_prime_fj64_fast() on trial-division survivors.
+ *
+ * Compile: make test-interleaved
+ * Usage:   ./analysis/test_prime_interleaved [count]   (default: 4,000,000)
+ */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "../include/fmt.h"
+#include "../include/solve.h"
+#include "../include/prime_interleaved.h"
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t xorshift64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Random trial-division survivor in (127, 2^52) with a bit length in [lo, hi] */
+static uint64_t random_survivor(int lo, int hi) {
+    while (1) {
+        int bits = lo + (int)(xorshift64() % (uint64_t)(hi - lo + 1));
+        uint64_t n = (xorshift64() >> (64 - bits)) | 1 | (1ULL << (bits - 1));
+        if (n > 127 && n < INTERLEAVED_LIMIT && trial_division_check(n) == 2) return n;
+    }
+}
+
+static uint64_t errors = 0;
+
+/* Compare one n (a trial-division survivor) against the reference */
+static bool check(uint64_t n) {
+    bool expected = is_prime_64(n);
+    bool got = is_prime_fj64_interleaved(n);
+    if (got != expected) {
+        if (errors < 10) {
+            printf("  MISMATCH: n = %llu, expected %d, got %d\n",
+                   (unsigned long long)n, expected, got);
+        }
+        errors++;
+    }
+    return expected;
+}
+
+/* Every odd trial-division survivor in [lo, hi) */
+static void run_window(uint64_t lo, uint64_t hi, const char *label) {
+    uint64_t before = errors, tested = 0, primes = 0;
+    for (uint64_t n = lo | 1; n < hi; n += 2) {
+        if (trial_division_check(n) != 2) continue;
+        primes += check(n);
+        tested++;
+    }
+    printf("  %-36s %s tested, %s prime, %s errors\n", label, fmt_num(tested),
+           fmt_num(primes), fmt_num(errors - before));
+}
+
+static const uint32_t SMALL_PRIMES[] = {
+    131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199,
+    211, 223, 227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283,
+    293, 307, 311, 313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383,
+    389, 397, 401, 409, 419, 421, 431, 433, 439, 443, 449, 457, 461, 463, 467
+};
+#define NUM_SMALL_PRIMES 60
+
+int main(int argc, char *argv[]) {
+    uint64_t count = 4000000;
+    if (argc > 1) count = strtoull(argv[1], NULL, 10);
+
+    printf("Interleaved Trial Division Test\n");
+    printf("===============================\n\n");
+
+    /* The primes 131-467, products with large primes, n = +-1 mod p */
+    uint64_t before = errors, tested = 0;
+    for (int i = 0; i < NUM_SMALL_PRIMES; i++) {
+        uint64_t p = SMALL_PRIMES[i];
+        check(p);
+        check(p * p);
+        tested += 2;
+
+        /* Largest prime q with p q < 2^52, and the survivors next to p q */
+        uint64_t q = (INTERLEAVED_LIMIT - 1) / p;
+        q -= (q & 1) ? 0 : 1;
+        while (!is_prime_64(q)) q -= 2;
+        uint64_t top = (INTERLEAVED_LIMIT - 1) / p * p;
+        const uint64_t near[] = {p * q, top - 1, top + 1, top - p + 1, top - 2 * p - 1,
+                                 p * 1000003ULL, p * 4294967311ULL};
+        for (int j = 0; j < 7; j++) {
+            uint64_t n = near[j];
+            if (n >= INTERLEAVED_LIMIT || !(n & 1) || trial_division_check(n) != 2) continue;
+            check(n);
+            tested++;
+        }
+    }
+
+    /* Strong pseudoprimes to base 2 and Carmichael numbers */
+    const uint64_t special[] = {
+        29341, 42799, 49141, 52633, 65281, 74665, 80581, 85489, 88357, 90751,
+        1105, 1729, 2465, 2821, 6601, 8911, 3215031751ULL, 2152302898747ULL,
+        3474749660383ULL, 341550071728321ULL, 4503599627370449ULL,
+        4503599627370353ULL, 4503599627370337ULL, 4503599627370491ULL,
+        4294967311ULL, 1000000007ULL, 999999999989ULL,
+    };
+    const int num_special = (int)(sizeof(special) / sizeof(special[0]));
+    for (int i = 0; i < num_special; i++) {
+        if (special[i] <= 127 || trial_division_check(special[i]) != 2) continue;
+        check(special[i]);
+        tested++;
+    }
+    printf("  %-36s %s tested, %s errors\n", "Primes 131-467, products, special",
+           fmt_num(tested), fmt_num(errors - before));
+
+    run_window(1ULL << 32, (1ULL << 32) + (1ULL << 22), "All survivors in [2^32, +2^22)");
+    run_window(INTERLEAVED_LIMIT - (1ULL << 22), INTERLEAVED_LIMIT,
+               "All survivors in [2^52 - 2^22, 2^52)");
+
+    before = errors;
+    uint64_t primes = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        primes += check(random_survivor(8, 52));
+    }
+    printf("  %-36s %s tested, %s prime, %s errors\n", "Random survivors < 2^52",
+           fmt_num(count), fmt_num(primes), fmt_num(errors - before));
+
+    /* Throughput on trial-division survivors, best of 5 */
+    const uint64_t bench_count = 1 << 18;
+    uint64_t *bench = (uint64_t*)malloc(bench_count * sizeof(uint64_t));
+    if (!bench) return 1;
+
+    printf("\nThroughput (trial-division survivors, ns per test, best of 5):\n");
+    printf("  %-6s %14s %14s %9s\n", "Bits", "fj64_fast", "interleaved", "Speedup");
+    for (int bits = 34; bits <= 52; bits += 6) {
+        for (uint64_t i = 0; i < bench_count; i++) {
+            bench[i] = random_survivor(bits, bits);
+        }
+        double best_fast = 1e30, best_il = 1e30;
+        uint64_t fast_primes = 0, il_primes = 0;
+        for (int rep = 0; rep < 5; rep++) {
+            double t0 = get_time();
+            fast_primes = 0;
+            for (uint64_t i = 0; i < bench_count; i++) {
+                fast_primes += is_prime_fj64_fast(bench[i]);
+            }
+            double t1 = get_time();
+            il_primes = 0;
+            for (uint64_t i = 0; i < bench_count; i++) {
+                il_primes += is_prime_fj64_interleaved(bench[i]);
+            }
+            double t2 = get_time();
+            if (t1 - t0 < best_fast) best_fast = t1 - t0;
+            if (t2 - t1 < best_il) best_il = t2 - t1;
+        }
+        printf("  %-6d %14.1f %14.1f %8.2fx\n", bits, best_fast / bench_count * 1e9,
+               best_il / bench_count * 1e9, best_fast / best_il);
+        if (fast_primes != il_primes) {
+            printf("  MISMATCH: prime counts differ (%llu vs %llu)\n",
+                   (unsigned long long)fast_primes, (unsigned long long)il_primes);
+            errors++;
+        }
+    }
+    free(bench);
+
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
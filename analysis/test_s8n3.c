@@ -0,0 +1,180 @@
+/*
+ * Test libsearch8n3 (s8n3.h) through its public API only
+ *
+ * Checks that the per-n and pipeline engines test exactly the same
+ * candidates (equal check counts, with and without a sieve, below and past
+ * n = 2^61), that the batched engine covers its range and agrees with the
+ * per-n engine where candidates pass 2^32 (n ~ 10^12), that the chunk
+ * callbacks tile the range, that a context reused for many sub-ranges adds
+ * up to one search over their union, and that s8n3_cancel() from a
+ * callback stops the search.
+ *
+ * Compile: make test-lib (links libsearch8n3.a)
+ * Usage:   ./analysis/test_s8n3
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/fmt.h"
+#include "../include/s8n3.h"
+
+/* ========================================================================== */
+/* Callback Recorders                                                         */
+/* ========================================================================== */
+
+#define MAX_CHUNKS 4096
+
+typedef struct {
+    uint64_t lo[MAX_CHUNKS];
+    uint64_t hi[MAX_CHUNKS];
+    int count;
+    int progress_calls;
+    s8n3_context *cancel_ctx;   /* Cancel after the first chunk if set */
+} Recorder;
+
+static void on_chunk(void *user, const s8n3_stats *chunk) {
+    Recorder *r = (Recorder *)user;
+    if (r->count < MAX_CHUNKS) {
+        r->lo[r->count] = chunk->n_lo;
+        r->hi[r->count] = chunk->n_hi;
+    }
+    r->count++;
+    if (r->cancel_ctx) s8n3_cancel(r->cancel_ctx);
+}
+
+static void on_progress(void *user, uint64_t done, uint64_t total, double seconds) {
+    (void)done; (void)total; (void)seconds;
+    ((Recorder *)user)->progress_calls++;
+}
+
+/* Chunks, sorted by n_lo, tile [lo, hi) exactly */
+static bool tiles(Recorder *r, uint64_t lo, uint64_t hi) {
+    if (r->count > MAX_CHUNKS) return false;
+    for (int i = 1; i < r->count; i++) {
+        for (int j = i; j > 0 && r->lo[j] < r->lo[j - 1]; j--) {
+            uint64_t t = r->lo[j]; r->lo[j] = r->lo[j - 1]; r->lo[j - 1] = t;
+            t = r->hi[j]; r->hi[j] = r->hi[j - 1]; r->hi[j - 1] = t;
+        }
+    }
+    uint64_t pos = lo;
+    for (int i = 0; i < r->count; i++) {
+        if (r->lo[i] != pos) return false;
+        pos = r->hi[i];
+    }
+    return pos == hi;
+}
+
+/* ========================================================================== */
+/* Tests                                                                      */
+/* ========================================================================== */
+
+static int errors = 0;
+
+static void expect(bool ok, const char *what) {
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) errors++;
+}
+
+static int search(s8n3_context *ctx, uint64_t lo, uint64_t hi, s8n3_engine engine,
+                  Recorder *rec, s8n3_result *res) {
+    s8n3_opts opts;
+    s8n3_opts_init(&opts);
+    opts.engine = engine;
+    s8n3_callbacks cb = {0};
+    cb.user = rec;
+    cb.chunk = rec ? on_chunk : NULL;
+    cb.progress = rec ? on_progress : NULL;
+    return s8n3_search(ctx, lo, hi, &opts, &cb, res);
+}
+
+int main(void) {
+    printf("libsearch8n3 %s\n", s8n3_version());
+    printf("=================\n\n");
+
+    int err;
+    s8n3_context *ctx = s8n3_create(NULL, &err);
+    s8n3_opts sieve_opts;
+    s8n3_opts_init(&sieve_opts);
+    sieve_opts.sieve_threshold = 10000000;
+    s8n3_context *sieve_ctx = s8n3_create(&sieve_opts, &err);
+    if (!ctx || !sieve_ctx) {
+        printf("Cannot create contexts (error %d)\n", err);
+        return 1;
+    }
+    printf("Threads: %d\n\n", s8n3_threads(ctx));
+
+    static Recorder rec;
+    s8n3_result per_n, pipe, batched, sieved;
+    const uint64_t lo = 1000000000ULL, hi = lo + 300000;
+
+    /* Per-n and pipeline visit the same candidates */
+    int rc = search(ctx, lo, hi, S8N3_ENGINE_PER_N, &rec, &per_n);
+    expect(rc == S8N3_OK && per_n.n_processed == hi - lo, "per-n engine searches [1e9, 1e9 + 3e5)");
+    expect(tiles(&rec, lo, hi), "per-n chunk callbacks tile the range");
+    expect(rec.progress_calls > 0, "progress callback called");
+
+    rec.count = 0;
+    rc = search(ctx, lo, hi, S8N3_ENGINE_PIPELINE, &rec, &pipe);
+    expect(rc == S8N3_OK && pipe.checks == per_n.checks, "pipeline engine: same checks as per-n");
+    expect(tiles(&rec, lo, hi), "pipeline chunk callbacks tile the range");
+
+    rc = search(sieve_ctx, lo, hi, S8N3_ENGINE_PER_N, NULL, &sieved);
+    expect(rc == S8N3_OK && sieved.checks == per_n.checks && sieved.sieve_hits > 0,
+           "per-n with a sieve: same checks, sieve used");
+
+    rec.count = 0;
+    rc = search(ctx, lo, hi, S8N3_ENGINE_BATCHED, &rec, &batched);
+    expect(rc == S8N3_OK && batched.n_processed == hi - lo && tiles(&rec, lo, hi),
+           "batched engine covers the range");
+
+    /* Candidates past 2^32, across an a_max step (8n + 3 = 2828429^2 at
+       n ~ 1000001326005): batched agrees with per-n */
+    const uint64_t lo12 = 1000001200000ULL, hi12 = lo12 + 200000;
+    s8n3_result per_n12, batched12;
+    search(ctx, lo12, hi12, S8N3_ENGINE_PER_N, NULL, &per_n12);
+    rec.count = 0;
+    rc = search(sieve_ctx, lo12, hi12, S8N3_ENGINE_BATCHED, &rec, &batched12);
+    expect(rc == S8N3_OK && batched12.n_processed == per_n12.n_processed &&
+           batched12.counterexamples == per_n12.counterexamples && tiles(&rec, lo12, hi12),
+           "past 2^32 candidates: batched agrees with per-n");
+
+    /* One context, many sub-ranges */
+    uint64_t sum_checks = 0;
+    bool all_ok = true;
+    for (uint64_t start = lo; start < hi; start += 3000) {
+        s8n3_result part;
+        all_ok &= search(sieve_ctx, start, start + 3000, S8N3_ENGINE_PER_N, NULL, &part) == S8N3_OK;
+        sum_checks += part.checks;
+    }
+    expect(all_ok && sum_checks == per_n.checks, "100 sub-range searches add up to one");
+
+    /* Small n, and past n = 2^61 (128-bit N; pipeline falls back to per-n) */
+    rc = s8n3_search_range(1, 100000, NULL, NULL, &per_n);
+    expect(rc == S8N3_OK && per_n.counterexamples == 0, "one-shot search of [1, 1e5)");
+
+    const uint64_t big = 1ULL << 62;
+    search(ctx, big, big + 20000, S8N3_ENGINE_PER_N, NULL, &per_n);
+    rc = search(ctx, big, big + 20000, S8N3_ENGINE_PIPELINE, NULL, &pipe);
+    expect(rc == S8N3_OK && pipe.checks == per_n.checks, "past 2^61: pipeline equals per-n");
+    expect(search(ctx, big, big + 20000, S8N3_ENGINE_BATCHED, NULL, NULL) == S8N3_ERR_ARGS,
+           "past 2^61: batched engine rejected");
+    expect(search(ctx, hi, lo, S8N3_ENGINE_PER_N, NULL, NULL) == S8N3_ERR_ARGS,
+           "empty range rejected");
+
+    /* Cancel from a callback */
+    rec.count = 0;
+    rec.cancel_ctx = ctx;
+    s8n3_result cancelled;
+    rc = search(ctx, lo, lo + 100000000, S8N3_ENGINE_PER_N, &rec, &cancelled);
+    expect(rc == S8N3_CANCELLED && cancelled.n_processed < 100000000,
+           "s8n3_cancel() from a callback stops the search");
+
+    s8n3_destroy(ctx);
+    s8n3_destroy(sieve_ctx);
+
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
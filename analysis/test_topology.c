@@ -0,0 +1,69 @@
+/*
+ * Test topology.h (CPU detection and --affinity pin orders)
+ *
+ * Checks that topology_detect() leaves the default pin order in place (one
+ * slot per available CPU, so the default thread count and
+ * topology_pin_thread() work without a topology_set_affinity() call), that
+ * every policy's pin order lists only available CPUs, and that pinning to
+ * slot 0 succeeds.
+ *
+ * Compile: make test-topology
+ * Usage:   ./analysis/test_topology
+ */
+
+#define _GNU_SOURCE  /* sched_getaffinity */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "../include/topology.h"
+
+static int errors = 0;
+
+static void expect(bool ok, const char *what) {
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) errors++;
+}
+
+/* Every slot is an available CPU, and none is used twice */
+static bool order_valid(const CpuTopology *t) {
+    for (int s = 0; s < t->num_slots; s++) {
+        bool found = false;
+        for (int k = 0; k < t->num_cpus; k++) found |= t->cpus[k].cpu == t->order[s];
+        if (!found) return false;
+        for (int r = 0; r < s; r++) {
+            if (t->order[r] == t->order[s]) return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    printf("Topology Test\n");
+    printf("=============\n\n");
+
+    CpuTopology *t = (CpuTopology *)malloc(sizeof(CpuTopology));
+    if (!t) return 1;
+    topology_detect(t);
+    printf("CPUs: %d, cores: %d, packages: %d, nodes: %d\n\n",
+           t->num_cpus, t->num_cores, t->num_packages, t->num_nodes);
+
+    expect(t->num_cpus > 0, "detect finds CPUs");
+    expect(t->num_slots == t->num_cpus, "detect: num_slots == num_cpus");
+    expect(t->policy == TOPOLOGY_DEFAULT && order_valid(t), "detect: default pin order");
+    int threads = topology_default_threads(t);
+    expect(threads >= 1 && threads <= t->num_cpus, "default threads in [1, num_cpus]");
+    expect(topology_pin_thread(t, 0), "pin to slot 0 after detect");
+
+    topology_set_affinity(t, TOPOLOGY_COMPACT);
+    expect(t->num_slots == t->num_cpus && order_valid(t), "compact: every CPU once");
+    topology_set_affinity(t, TOPOLOGY_SCATTER);
+    expect(t->num_slots == t->num_cpus && order_valid(t), "scatter: every CPU once");
+    topology_set_affinity(t, TOPOLOGY_CORES_ONLY);
+    expect(t->num_slots == t->num_cores && order_valid(t), "cores-only: one CPU per core");
+
+    free(t);
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
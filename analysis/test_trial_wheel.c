@@ -0,0 +1,157 @@
+/*
+ * Test and benchmark trial_wheel.h (a-walk wheel for the trial primes)
+ *
+ * Walks consecutive n the way a search chunk does (trial_wheel_seek() per
+ * n, so the residues are updated incrementally and a_max grows by 2 now
+ * and then) and compares the wheel's survivor masks, for the first window
+ * and for later ones, with trial_division_check() on every candidate.
+ * Ranges at 10^6, 10^12, 10^18 and past 2^61, and random jumps. Then
+ * times the survivor mask of the first 16 steps: wheel vs trial division.
+ *
+ * Compile: make test-wheel
+ * Usage:   ./analysis/test_trial_wheel [n_count]   (default: 200,000 per range)
+ */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "../include/fmt.h"
+#include "../include/solve.h"
+#include "../include/trial_vector.h"
+#include "../include/trial_wheel.h"
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t xorshift64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static uint64_t errors = 0;
+
+/* Survivors among the 64 steps from a by trial division (candidates > 127) */
+static uint64_t reference_mask(__uint128_t N, uint64_t a) {
+    uint64_t mask = 0;
+    for (int i = 0; i < WHEEL_STEPS && a >= 2 * (uint64_t)i + 1; i++) {
+        uint64_t ai = a - 2 * (uint64_t)i;
+        uint64_t c = (uint64_t)((N - (__uint128_t)ai * ai) >> 1);
+        if (trial_division_check(c) != 0) mask |= 1ULL << i;
+    }
+    return mask;
+}
+
+/* Windows 0-2 of n: the steps whose candidates are > 127 must agree */
+static void check_n(const TrialWheel *w, uint64_t n, uint64_t a_max) {
+    __uint128_t N = 8 * (__uint128_t)n + 3;
+    for (uint64_t win = 0; win < 3; win++) {
+        if (a_max < 2 * WHEEL_STEPS * win + 1) break;
+        uint64_t a = a_max - 2 * WHEEL_STEPS * win;
+        uint64_t got = trial_wheel_survivors64(w, win);
+        uint64_t expected = reference_mask(N, a);
+
+        /* Compare steps with 127 < candidate < 2^64 */
+        uint64_t valid = 0;
+        for (int i = 0; i < WHEEL_STEPS && a >= 2 * (uint64_t)i + 1; i++) {
+            uint64_t ai = a - 2 * (uint64_t)i;
+            __uint128_t c = (N - (__uint128_t)ai * ai) >> 1;
+            if (c > 127 && (c >> 64) == 0) valid |= 1ULL << i;
+        }
+        if ((got ^ expected) & valid) {
+            if (errors < 10) {
+                printf("  MISMATCH: n = %s, window %llu: %016llx vs %016llx\n", fmt_num(n),
+                       (unsigned long long)win, (unsigned long long)(got & valid),
+                       (unsigned long long)(expected & valid));
+            }
+            errors++;
+        }
+    }
+}
+
+static void run_range(uint64_t start, uint64_t count, const char *label) {
+    uint64_t before = errors;
+    TrialWheel w;
+    trial_wheel_reset(&w);
+    for (uint64_t n = start; n < start + count; n++) {
+        uint64_t a_max = solve_a_max128(8 * (__uint128_t)n + 3);
+        trial_wheel_seek(&w, n, a_max);
+        check_n(&w, n, a_max);
+    }
+    printf("  %-28s %s n, %s errors\n", label, fmt_num(count), fmt_num(errors - before));
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t count = 200000;
+    if (argc > 1) count = strtoull(argv[1], NULL, 10);
+    trial_wheel_init();
+
+    printf("a-Walk Wheel Test\n");
+    printf("=================\n\n");
+
+    run_range(1, count, "n from 1");
+    run_range(1000000, count, "n from 10^6");
+    run_range(1000000000000ULL, count, "n from 10^12");
+    run_range(1000000000000000000ULL, count, "n from 10^18");
+    run_range((1ULL << 61) - count / 2, count, "n across 2^61");
+
+    /* Random jumps: every seek recomputes the residues */
+    uint64_t before = errors;
+    TrialWheel w;
+    trial_wheel_reset(&w);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t n = xorshift64() >> (xorshift64() % 40 + 3);
+        uint64_t a_max = solve_a_max128(8 * (__uint128_t)n + 3);
+        trial_wheel_seek(&w, n, a_max);
+        check_n(&w, n, a_max);
+    }
+    printf("  %-28s %s n, %s errors\n", "random n", fmt_num(count), fmt_num(errors - before));
+
+    /* Time per n: survivors of the first 16 steps (about a walk at 10^12) */
+    const uint64_t bench_start = 1000000000000ULL, bench_count = 1 << 20;
+    uint64_t *a_max = (uint64_t*)malloc(bench_count * sizeof(uint64_t));
+    if (!a_max) return 1;
+    for (uint64_t i = 0; i < bench_count; i++) {
+        a_max[i] = solve_a_max128(8 * (__uint128_t)(bench_start + i) + 3);
+    }
+    volatile uint64_t sink = 0;     /* Keeps the masks from being optimized away */
+    double best_wheel = 1e30, best_td = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        double t0 = get_time();
+        trial_wheel_reset(&w);
+        for (uint64_t i = 0; i < bench_count; i++) {
+            trial_wheel_seek(&w, bench_start + i, a_max[i]);
+            sink += trial_wheel_survivors64(&w, 0) & 0xFFFF;
+        }
+        double t1 = get_time();
+        for (uint64_t i = 0; i < bench_count; i++) {
+            uint64_t N = 8 * (bench_start + i) + 3, a = a_max[i];
+            uint64_t c = (N - a * a) >> 1, delta = 2 * (a - 1);
+            if (c <= 127) continue;
+            sink += td_survivors8(c, delta, 8);
+            sink += td_survivors8(c + 8 * delta - 112, delta - 32, 8);
+        }
+        double t2 = get_time();
+        if (t1 - t0 < best_wheel) best_wheel = t1 - t0;
+        if (t2 - t1 < best_td) best_td = t2 - t1;
+    }
+    free(a_max);
+    printf("\nSurvivor mask of the first 16 steps per n at 10^12 (best of 5):\n");
+    printf("  wheel:           %6.1f ns/n\n", best_wheel / bench_count * 1e9);
+    printf("  trial division:  %6.1f ns/n (%s)\n", best_td / bench_count * 1e9,
+           trial_vector_available() ? "AVX-512" : "scalar");
+
+    printf("\n%s\n", errors == 0 ? "All tests passed." : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
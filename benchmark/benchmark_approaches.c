@@ -6,7 +6,12 @@
  * 2. Prime sieve with various thresholds (10^7, 10^8, 10^9)
  * 3. Batched sieve approach
  *
- * Usage: ./benchmark_approaches [--count N] [--quick]
+ * --repeat K, --json FILE and --compare BASELINE work as in benchmark_suite
+ * (bench_report.h): medians of K runs, a JSON report, and exit status 2 on
+ * a significant regression against a saved report.
+ *
+ * Usage: ./benchmark_approaches [--count N] [--quick] [--repeat K] [--json FILE]
+ *                               [--compare BASELINE]
  */
 
 #include <stdio.h>
@@ -26,6 +31,7 @@
 #include "prime.h"
 #include "prime_sieve.h"
 #include "batch_sieve.h"
+#include "bench_report.h"
 
 /* ========================================================================== */
 /* Configuration                                                              */
@@ -50,6 +56,15 @@ static const uint64_t SIEVE_THRESHOLDS[] = {
 };
 #define NUM_SIEVE_THRESHOLDS 2
 
+/* All measured rates of this run (--repeat, --json, --compare) */
+static BenchReport report;
+
+/* Record one rate; returns the median of this measurement's repeats so far */
+static double record_rate(const char *name, const char *scale, double rate) {
+    const BenchEntry *e = bench_report_add(&report, name, scale, rate);
+    return e ? e->median : rate;
+}
+
 /* ========================================================================== */
 /* Timing Helpers                                                             */
 /* ========================================================================== */
@@ -283,6 +298,9 @@ int main(int argc, char** argv) {
     printf("==================================================================\n\n");
 
     uint64_t count = DEFAULT_COUNT;
+    int repeat = 1;
+    const char *json_path = NULL;
+    const char *compare_path = NULL;
 
     /* Parse arguments */
     for (int i = 1; i < argc; i++) {
@@ -290,16 +308,40 @@ int main(int argc, char** argv) {
             count = QUICK_COUNT;
         } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
             count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1) repeat = 1;
+            if (repeat > BENCH_MAX_REPEAT) repeat = BENCH_MAX_REPEAT;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare_path = argv[++i];
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            printf("Usage: %s [--count N] [--quick]\n", argv[0]);
-            printf("  --count N   Number of n values per test (default: 1M)\n");
-            printf("  --quick     Use 100K values per test\n");
+            printf("Usage: %s [--count N] [--quick] [--repeat K] [--json FILE] "
+                   "[--compare BASELINE]\n", argv[0]);
+            printf("  --count N     Number of n values per test (default: 1M)\n");
+            printf("  --quick       Use 100K values per test\n");
+            printf("  --repeat K    Run every test K times, report medians\n");
+            printf("  --json FILE   Write all rates (median, MAD, samples) as JSON\n");
+            printf("  --compare F   Flag significant regressions against a --json baseline\n");
+            printf("                (exit status 2 if any)\n");
             return 0;
         }
     }
 
+    static BenchReport baseline;
+    if (compare_path) {
+        const char *err;
+        if (!bench_report_load_json(&baseline, compare_path, &err)) {
+            fprintf(stderr, "Error: --compare %s: %s\n", compare_path, err);
+            return 1;
+        }
+    }
+    bench_report_init(&report, "benchmark_approaches", count, repeat);
+
     printf("Configuration:\n");
     printf("  Values per test: %s\n", fmt_num(count));
+    if (repeat > 1) printf("  Repeats:         %d (throughputs are medians)\n", repeat);
     printf("\n");
 
     /* Pre-create sieves */
@@ -318,6 +360,7 @@ int main(int argc, char** argv) {
     /* Run benchmarks at each scale */
     for (int scale_idx = 0; scale_idx < NUM_SCALES; scale_idx++) {
         uint64_t n_start = TEST_SCALES[scale_idx];
+        const char *scale = scale_idx == 0 ? "10^9" : (scale_idx == 1 ? "10^12" : "10^15");
 
         printf("==================================================================\n");
         printf("Scale: n = %s (10^%d)\n", fmt_num(n_start),
@@ -326,28 +369,47 @@ int main(int argc, char** argv) {
 
         /* Baseline */
         printf("Testing baseline (no sieve)...\n");
-        BenchResult baseline = bench_baseline(n_start, count);
-        printf("  Throughput: %s n/sec\n", fmt_num(baseline.throughput));
-        printf("  Avg checks: %.2f\n\n", (double)baseline.total_checks / baseline.n_processed);
+        BenchResult base_result = {0};
+        double base_rate = 0.0;
+        for (int r = 0; r < repeat; r++) {
+            base_result = bench_baseline(n_start, count);
+            base_rate = record_rate("baseline", scale, (double)base_result.throughput);
+        }
+        printf("  Throughput: %s n/sec\n", fmt_num((uint64_t)base_rate));
+        printf("  Avg checks: %.2f\n\n",
+               (double)base_result.total_checks / base_result.n_processed);
 
         /* Sieve variants */
         for (int s = 0; s < NUM_SIEVE_THRESHOLDS; s++) {
             printf("Testing sieve (threshold = 10^%d)...\n",
                    SIEVE_THRESHOLDS[s] == 10000000 ? 7 : 8);
-            BenchSieveResult sieve_result = bench_with_sieve(n_start, count, sieves[s]);
-            double speedup = (baseline.elapsed > 0) ? baseline.elapsed / sieve_result.elapsed : 0;
+            char name[32];
+            snprintf(name, sizeof(name), "sieve-1e%d",
+                     SIEVE_THRESHOLDS[s] == 10000000 ? 7 : 8);
+            BenchSieveResult sieve_result = {0};
+            double rate = 0.0;
+            for (int r = 0; r < repeat; r++) {
+                sieve_result = bench_with_sieve(n_start, count, sieves[s]);
+                rate = record_rate(name, scale, (double)sieve_result.throughput);
+            }
+            double speedup = (base_rate > 0) ? rate / base_rate : 0;
             printf("  Throughput: %s n/sec (%.2fx speedup)\n",
-                   fmt_num(sieve_result.throughput), speedup);
+                   fmt_num((uint64_t)rate), speedup);
             printf("  Sieve hit rate: %.1f%%\n\n", sieve_result.hit_rate);
         }
 
         /* Batched (only at smaller scales due to different algorithm structure) */
         if (scale_idx <= 1) {
             printf("Testing batched sieve (batch_size = 64K)...\n");
-            BenchBatchResult batch_result = bench_batched(n_start, count, 65536);
-            double speedup = (baseline.elapsed > 0) ? baseline.elapsed / batch_result.elapsed : 0;
+            BenchBatchResult batch_result = {0};
+            double rate = 0.0;
+            for (int r = 0; r < repeat; r++) {
+                batch_result = bench_batched(n_start, count, 65536);
+                rate = record_rate("batched-64K", scale, (double)batch_result.throughput);
+            }
+            double speedup = (base_rate > 0) ? rate / base_rate : 0;
             printf("  Throughput: %s n/sec (%.2fx speedup)\n",
-                   fmt_num(batch_result.throughput), speedup);
+                   fmt_num((uint64_t)rate), speedup);
             printf("  MR test savings: %.1f%%\n\n", batch_result.save_rate);
         }
     }
@@ -369,5 +431,15 @@ int main(int argc, char** argv) {
         sieve_destroy(sieves[s]);
     }
 
+    if (json_path) {
+        if (!bench_report_write_json(&report, json_path)) {
+            fprintf(stderr, "Error: cannot write %s\n", json_path);
+            return 1;
+        }
+        printf("\nResults written to %s\n", json_path);
+    }
+    if (compare_path && bench_report_compare(&report, &baseline, compare_path) > 0) {
+        return 2;
+    }
     return 0;
 }
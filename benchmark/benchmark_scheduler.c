@@ -0,0 +1,215 @@
+/*
+ * Scheduler Benchmark: Static Partition vs Dynamic Work Queue
+ *
+ * Runs the same range twice with OpenMP:
+ *   1. Static: one contiguous slice per thread (the pre-2.1 scheduler)
+ *   2. Dynamic: guided chunks claimed from work_queue.h
+ *
+ * For every thread we record the time at which it ran out of work. The
+ * "tail idle" time of a thread is wall_time - finish_time: the time it sat
+ * idle waiting for the slowest thread. Heterogeneous cores, SMT siblings
+ * and noisy neighbours all show up as tail idle under static scheduling.
+ *
+ * Compile: make benchmark-scheduler
+ * Usage:   ./benchmark_scheduler [--threads N] [--start N] [--count N] [--quick]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "fmt.h"
+#include "arith.h"
+#include "solve.h"
+#include "work_queue.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define DEFAULT_START   1000000000000ULL  /* 10^12 */
+#define DEFAULT_COUNT   20000000          /* 20M n values per run */
+#define QUICK_COUNT     2000000           /* 2M for quick mode */
+#define MIN_THREADS     32                /* Tail effects matter at 32+ threads */
+#define MAX_BENCH_THREADS 1024
+
+/* ========================================================================== */
+/* Timing                                                                     */
+/* ========================================================================== */
+
+static double get_time(void) {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* ========================================================================== */
+/* Benchmark Core                                                             */
+/* ========================================================================== */
+
+typedef struct {
+    double wall;                /* Wall-clock time of the parallel region */
+    double avg_idle;            /* Mean tail idle time per thread */
+    double max_idle;            /* Largest tail idle time of any thread */
+    uint64_t solved;            /* n values with a solution (sanity check) */
+} SchedResult;
+
+static double finish_time[MAX_BENCH_THREADS];
+
+static inline uint64_t solve_range(uint64_t lo, uint64_t hi) {
+    uint64_t solved = 0;
+    for (uint64_t n = lo; n < hi; n++) {
+        uint64_t p;
+        if (find_solution(n, &p) > 0) solved++;
+    }
+    return solved;
+}
+
+static SchedResult run_scheduled(uint64_t n_start, uint64_t count, int num_threads,
+                                 bool dynamic) {
+    SchedResult result = {0};
+    uint64_t n_end = n_start + count;
+    uint64_t solved = 0;
+
+    WorkQueue queue;
+    work_queue_init(&queue, n_start, n_end, num_threads);
+
+    double start = get_time();
+
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+    #pragma omp parallel reduction(+:solved)
+#endif
+    {
+#ifdef _OPENMP
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+#else
+        int tid = 0;
+        int nthreads = 1;
+#endif
+        if (dynamic) {
+            uint64_t lo, hi;
+            while (work_queue_next(&queue, &lo, &hi)) {
+                solved += solve_range(lo, hi);
+            }
+        } else {
+            uint64_t chunk = (count + nthreads - 1) / nthreads;
+            uint64_t lo = n_start + (uint64_t)tid * chunk;
+            uint64_t hi = lo + chunk;
+            if (hi > n_end) hi = n_end;
+            if (lo < hi) solved += solve_range(lo, hi);
+        }
+        finish_time[tid] = get_time();
+    }
+
+    double end = get_time();
+
+    result.wall = end - start;
+    result.solved = solved;
+    for (int t = 0; t < num_threads; t++) {
+        double idle = end - finish_time[t];
+        result.avg_idle += idle;
+        if (idle > result.max_idle) result.max_idle = idle;
+    }
+    result.avg_idle /= num_threads;
+
+    return result;
+}
+
+/* ========================================================================== */
+/* Main                                                                       */
+/* ========================================================================== */
+
+static uint64_t parse_number(const char* str) {
+    char* endptr;
+    double val = strtod(str, &endptr);
+    if (*endptr != '\0') {
+        return strtoull(str, NULL, 10);
+    }
+    return (uint64_t)val;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [OPTIONS]\n\n", program);
+    printf("Options:\n");
+    printf("  --threads N   Thread count (default: max(32, available cores))\n");
+    printf("  --start N     First n of the range (default: 1e12)\n");
+    printf("  --count N     Number of n values per run (default: 20M)\n");
+    printf("  --quick       Run with 2M values\n");
+    printf("  -h, --help    Show this help message\n");
+}
+
+int main(int argc, char** argv) {
+    setbuf(stdout, NULL);
+
+    uint64_t n_start = DEFAULT_START;
+    uint64_t count = DEFAULT_COUNT;
+    int num_threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            n_start = parse_number(argv[++i]);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = parse_number(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            count = QUICK_COUNT;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (num_threads <= 0) {
+#ifdef _OPENMP
+        num_threads = omp_get_max_threads();
+#else
+        num_threads = 1;
+#endif
+        if (num_threads < MIN_THREADS) num_threads = MIN_THREADS;
+    }
+    if (num_threads > MAX_BENCH_THREADS) num_threads = MAX_BENCH_THREADS;
+
+    printf("Scheduler benchmark: 8n + 3 = a^2 + 2p\n");
+    printf("Range: n in [%s, %s), %d threads\n\n",
+           fmt_num(n_start), fmt_num(n_start + count), num_threads);
+
+    printf("%-10s  %10s  %15s  %14s  %14s\n",
+           "Scheduler", "Wall (s)", "Rate (n/sec)", "Avg idle (ms)", "Max idle (ms)");
+    printf("----------------------------------------------------------------------\n");
+
+    SchedResult st = run_scheduled(n_start, count, num_threads, false);
+    printf("%-10s  %10.3f  %15s  %14.1f  %14.1f\n", "static", st.wall,
+           fmt_num((uint64_t)(count / st.wall)), st.avg_idle * 1e3, st.max_idle * 1e3);
+
+    SchedResult dy = run_scheduled(n_start, count, num_threads, true);
+    printf("%-10s  %10.3f  %15s  %14.1f  %14.1f\n", "dynamic", dy.wall,
+           fmt_num((uint64_t)(count / dy.wall)), dy.avg_idle * 1e3, dy.max_idle * 1e3);
+
+    printf("----------------------------------------------------------------------\n");
+    printf("Tail idle removed: %.1f ms per thread (%.1f%% of static wall time)\n",
+           (st.avg_idle - dy.avg_idle) * 1e3,
+           100.0 * (st.avg_idle - dy.avg_idle) / st.wall);
+
+    if (st.solved != count || dy.solved != count) {
+        printf("WARNING: unsolved n values (static %s, dynamic %s)\n",
+               fmt_num(count - st.solved), fmt_num(count - dy.solved));
+        return 2;
+    }
+
+    return 0;
+}
@@ -1,13 +1,41 @@
 /*
  * Benchmark Suite for Counterexample Search: 8n + 3 = a^2 + 2p
  *
- * Tests throughput at various scales from 10^6 to ~2^61 for consistent
- * comparison across code changes.
+ * Tests throughput at various scales from 10^6 to 10^19 for consistent
+ * comparison across code changes. Scales past n = 2^61 (N = 8n + 3 no
+ * longer fits 64 bits) run find_solution_from_N128.
+ *
+ * With --pipeline K, every scale is also run through the multi-n pipeline
+ * (solve_pipeline.h, K n in flight) and compared against find_solution_from_N.
+ * With --fj32, every scale is also run through find_solution_from_N_32 (FJ32
+ * single-witness test wherever candidates are provably below 2^32).
+ *
+ * With --perf (Linux), each timed run is also measured with hardware
+ * counters (perf_events.h) and a second table reports IPC, cycles per n,
+ * cycles per primality test and branch / L1D / LLC / dTLB misses per n.
+ * The primality tests are counted in a separate, unmeasured pass, which
+ * roughly doubles the run time.
+ *
+ * With --scaling (OpenMP), every scale is instead run at 1, 2, 4, ... up to
+ * all available CPUs (or --threads N) with the search's parallel structure:
+ * chunks from work_queue.h, the FJ32 / 128-bit per-n kernels and padded
+ * per-thread statistics. Threads are pinned to physical cores first and SMT
+ * siblings second (topology.h); the table gives speedup, parallel
+ * efficiency and per-thread rate against the 1-thread run.
+ *
+ * --repeat K takes every measurement K times and reports medians; --json
+ * FILE saves all rates (median, MAD, samples) and --compare BASELINE flags
+ * significant regressions against a saved file (bench_report.h), exiting
+ * with status 2 if there are any.
  *
  * Compile: make benchmark
- * Usage:   ./benchmark_suite [--quick] [--count N]
+ * Usage:   ./benchmark_suite [--quick] [--count N] [--pipeline K | --fj32] [--perf]
+ *          ./benchmark_suite --scaling [--threads N] [--quick] [--count N]
+ *          (all modes: [--repeat K] [--json FILE] [--compare BASELINE])
  */
 
+#define _GNU_SOURCE     /* clock_gettime, syscall (perf_events.h), CPU_SET (topology.h) */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -15,9 +43,18 @@
 #include <string.h>
 #include <time.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "fmt.h"
 #include "arith.h"
 #include "solve.h"
+#include "solve_pipeline.h"
+#include "perf_events.h"
+#include "work_queue.h"
+#include "topology.h"
+#include "bench_report.h"
 
 /* ========================================================================== */
 /* Configuration                                                              */
@@ -27,7 +64,7 @@
 #define QUICK_COUNT     1000000   /* 1M for quick mode */
 #define WARMUP_COUNT    100000    /* 100k warmup iterations */
 
-/* Test scales from 10^6 to ~2^61 */
+/* Test scales from 10^6 to 10^19 */
 static const struct {
     uint64_t n_start;
     const char* label;
@@ -40,9 +77,14 @@ static const struct {
     {100000000000000000ULL,        "10^17",  60},
     {1000000000000000000ULL,       "10^18",  63},
     {2000000000000000000ULL,       "2e18",   64},  /* ~2^61 for n, ~2^64 for N */
+    {2500000000000000000ULL,       "2.5e18", 65},  /* Just past 2^61: 128-bit N */
+    {10000000000000000000ULL,      "10^19",  67},
 };
 #define NUM_SCALES (sizeof(SCALES) / sizeof(SCALES[0]))
 
+/* All measured rates of this run (--repeat, --json, --compare) */
+static BenchReport report;
+
 /* ========================================================================== */
 /* Timing                                                                     */
 /* ========================================================================== */
@@ -63,9 +105,10 @@ typedef struct {
     double elapsed_sec;
     double n_per_sec;
     double avg_checks;  /* Average number of a values checked per n */
+    PerfSample perf;    /* Hardware counters of the timed run (--perf) */
 } BenchResult;
 
-BenchResult run_benchmark(uint64_t n_start, uint64_t count) {
+BenchResult run_benchmark(uint64_t n_start, uint64_t count, PerfCounters *perf) {
     BenchResult result = {0};
     result.n_start = n_start;
     result.count = count;
@@ -86,6 +129,7 @@ BenchResult run_benchmark(uint64_t n_start, uint64_t count) {
      */
     uint64_t total_checks = 0;
     double start = get_time();
+    if (perf) perf_counters_start(perf);
 
     /* Initialize N and a_max */
     uint64_t N = 8 * n_start + 3;
@@ -114,6 +158,7 @@ BenchResult run_benchmark(uint64_t n_start, uint64_t count) {
         }
     }
 
+    if (perf) perf_counters_stop(perf, &result.perf);
     double end = get_time();
 
     result.elapsed_sec = end - start;
@@ -123,6 +168,492 @@ BenchResult run_benchmark(uint64_t n_start, uint64_t count) {
     return result;
 }
 
+/**
+ * run_benchmark() for ranges past n = 2^61: 128-bit N, same incremental
+ * tracking (a_max and the candidates still fit 64 bits)
+ */
+BenchResult run_benchmark_128(uint64_t n_start, uint64_t count, PerfCounters *perf) {
+    BenchResult result = {0};
+    result.n_start = n_start;
+    result.count = count;
+
+    uint64_t a_floor63 = solve_a_floor63(n_start + count);
+
+    /* Warmup */
+    for (uint64_t i = 0; i < WARMUP_COUNT && i < count; i++) {
+        __uint128_t p;
+        volatile uint64_t a = find_solution128(n_start + i, &p);
+        (void)a;
+    }
+
+    uint64_t total_checks = 0;
+    double start = get_time();
+    if (perf) perf_counters_start(perf);
+
+    __uint128_t N = 8 * (__uint128_t)n_start + 3;
+    uint64_t a_max = solve_a_max128(N);
+
+    for (uint64_t i = 0; i < count; i++) {
+        __uint128_t p;
+        uint64_t a_found = find_solution_from_N128(N, a_max, a_floor63, &p);
+        if (a_found > 0) {
+            total_checks += (a_max - a_found) / 2 + 1;
+        }
+
+        N += 8;
+        uint64_t next_a = a_max + 2;
+        if ((__uint128_t)next_a * next_a <= N) {
+            a_max = next_a;
+        }
+    }
+
+    if (perf) perf_counters_stop(perf, &result.perf);
+    double end = get_time();
+
+    result.elapsed_sec = end - start;
+    result.n_per_sec = count / result.elapsed_sec;
+    result.avg_checks = (double)total_checks / count;
+
+    return result;
+}
+
+/**
+ * Same range as run_benchmark(), with the 32-bit path for every a above
+ * the range's solve_a_floor32() bound
+ */
+BenchResult run_benchmark_fj32(uint64_t n_start, uint64_t count, PerfCounters *perf) {
+    BenchResult result = {0};
+    result.n_start = n_start;
+    result.count = count;
+
+    uint64_t a_floor32 = solve_a_floor32(n_start + count);
+
+    /* Warmup */
+    uint64_t N = 8 * n_start + 3;
+    uint64_t a_max = isqrt64(N);
+    if ((a_max & 1) == 0) a_max--;
+    for (uint64_t i = 0; i < WARMUP_COUNT && i < count; i++) {
+        uint64_t p;
+        volatile uint64_t a = find_solution_from_N_32(N + 8 * i, a_max, a_floor32, &p);
+        (void)a;
+    }
+
+    uint64_t total_checks = 0;
+    double start = get_time();
+    if (perf) perf_counters_start(perf);
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t p;
+        uint64_t a_found = find_solution_from_N_32(N, a_max, a_floor32, &p);
+        if (a_found > 0) {
+            total_checks += (a_max - a_found) / 2 + 1;
+        }
+
+        N += 8;
+        uint64_t next_a = a_max + 2;
+        if (next_a * next_a <= N) {
+            a_max = next_a;
+        }
+    }
+
+    if (perf) perf_counters_stop(perf, &result.perf);
+    double end = get_time();
+
+    result.elapsed_sec = end - start;
+    result.n_per_sec = count / result.elapsed_sec;
+    result.avg_checks = (double)total_checks / count;
+
+    return result;
+}
+
+/**
+ * Same range as run_benchmark(), solved by the multi-n pipeline
+ */
+BenchResult run_benchmark_pipeline(uint64_t n_start, uint64_t count, int width,
+                                   PerfCounters *perf) {
+    BenchResult result = {0};
+    result.n_start = n_start;
+    result.count = count;
+
+    /* Warmup */
+    PipelineStats warm = {0};
+    uint64_t counterexample = 0;
+    pipeline_run(n_start, n_start + (count < WARMUP_COUNT ? count : WARMUP_COUNT),
+                 width, NULL, &warm, NULL, &counterexample);
+
+    PipelineStats stats = {0};
+    double start = get_time();
+    if (perf) perf_counters_start(perf);
+    pipeline_run(n_start, n_start + count, width, NULL, &stats, NULL, &counterexample);
+    if (perf) perf_counters_stop(perf, &result.perf);
+    double end = get_time();
+
+    result.elapsed_sec = end - start;
+    result.n_per_sec = count / result.elapsed_sec;
+    result.avg_checks = (double)stats.total_checks / count;
+
+    return result;
+}
+
+/* ========================================================================== */
+/* Reporting                                                                  */
+/* ========================================================================== */
+
+/* Record one rate; returns the median of this measurement's repeats so far */
+static double record_rate(const char *name, const char *scale, double rate) {
+    const BenchEntry *e = bench_report_add(&report, name, scale, rate);
+    return e ? e->median : rate;
+}
+
+/* ========================================================================== */
+/* Hardware Counters (--perf)                                                 */
+/* ========================================================================== */
+
+/**
+ * Primality tests the walk runs over [n_start, n_start + count): every
+ * trial-division survivor above 127 up to the solving candidate (every
+ * candidate of the 128-bit tail). The same for all paths, since they visit
+ * the same candidates. Unmeasured; for cycles per test only.
+ */
+static uint64_t count_primality_tests(uint64_t n_start, uint64_t count) {
+    uint64_t a_floor63 = solve_a_floor63(n_start + count);
+    __uint128_t N = 8 * (__uint128_t)n_start + 3;
+    uint64_t a_max = solve_a_max128(N);
+    uint64_t tests = 0;
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t a = a_max;
+        uint64_t candidate = (uint64_t)((N - (__uint128_t)a * a) >> 1);
+        uint64_t delta = 2 * (a - 1);
+
+        while (1) {
+            if (a <= a_floor63) {
+                find_solution_tail128(N, a, NULL, &tests);
+                break;
+            }
+            if (candidate >= 2) {
+                int td = trial_division_check(candidate);
+                if (td == 1 || (td == 2 && candidate <= 127)) break;
+                if (td == 2) {
+                    tests++;
+                    if (is_prime_fj64_fast(candidate)) break;
+                }
+            }
+            if (a < 3) break;
+            candidate += delta;
+            delta -= 4;
+            a -= 2;
+        }
+
+        N += 8;
+        uint64_t next_a = a_max + 2;
+        if ((__uint128_t)next_a * next_a <= N) {
+            a_max = next_a;
+        }
+    }
+    return tests;
+}
+
+/* One counter as value / divisor, or "-" if not counted */
+static void print_perf_ratio(const PerfSample *s, PerfEvent e, double divisor,
+                             int width, int precision) {
+    if (s->valid[e] && divisor > 0) {
+        printf("  %*.*f", width, precision, s->value[e] / divisor);
+    } else {
+        printf("  %*s", width, "-");
+    }
+}
+
+static void print_perf_row(const char *label, const char *path, const BenchResult *res,
+                           uint64_t tests) {
+    const PerfSample *s = &res->perf;
+    printf("%-8s  %-8s", label, path);
+    if (s->valid[PERF_INSTRUCTIONS] && s->value[PERF_CYCLES] > 0) {
+        printf("  %5.2f", (double)s->value[PERF_INSTRUCTIONS] / s->value[PERF_CYCLES]);
+    } else {
+        printf("  %5s", "-");
+    }
+    print_perf_ratio(s, PERF_CYCLES, (double)res->count, 10, 0);
+    print_perf_ratio(s, PERF_CYCLES, (double)tests, 10, 0);
+    print_perf_ratio(s, PERF_BRANCH_MISSES, (double)res->count, 8, 2);
+    print_perf_ratio(s, PERF_L1D_MISSES, (double)res->count, 8, 2);
+    print_perf_ratio(s, PERF_LLC_MISSES, (double)res->count, 8, 3);
+    print_perf_ratio(s, PERF_DTLB_MISSES, (double)res->count, 8, 3);
+    printf("%s\n", s->scaled ? "  *" : "");
+}
+
+/* ========================================================================== */
+/* Thread Scaling (--scaling)                                                 */
+/* ========================================================================== */
+
+/* Per-thread statistics, padded like search.c's ThreadStats */
+typedef struct {
+    uint64_t n_processed;
+    uint64_t total_checks;
+    char padding[64 - 2 * sizeof(uint64_t)];
+} ScalingStats;
+
+static ScalingStats scaling_stats[TOPOLOGY_MAX_CPUS];
+
+/* One claimed chunk, with the per-chunk bounds search.c uses */
+static inline void scaling_solve_chunk(uint64_t lo, uint64_t hi, int tid) {
+    ScalingStats *st = &scaling_stats[tid];
+    if (hi <= SOLVE_N64_LIMIT) {
+        uint64_t a_floor32 = solve_a_floor32(hi);
+        uint64_t N = 8 * lo + 3;
+        uint64_t a_max = isqrt64(N);
+        if ((a_max & 1) == 0) a_max--;
+        for (uint64_t n = lo; n < hi; n++) {
+            uint64_t p;
+            uint64_t a = find_solution_from_N_32(N, a_max, a_floor32, &p);
+            st->total_checks += a > 0 ? (a_max - a) / 2 + 1 : 0;
+            st->n_processed++;
+            N += 8;
+            if ((a_max + 2) * (a_max + 2) <= N) a_max += 2;
+        }
+    } else {
+        uint64_t a_floor63 = solve_a_floor63(hi);
+        __uint128_t N = 8 * (__uint128_t)lo + 3;
+        uint64_t a_max = solve_a_max128(N);
+        for (uint64_t n = lo; n < hi; n++) {
+            __uint128_t p;
+            uint64_t a = find_solution_from_N128(N, a_max, a_floor63, &p);
+            st->total_checks += a > 0 ? (a_max - a) / 2 + 1 : 0;
+            st->n_processed++;
+            N += 8;
+            if ((__uint128_t)(a_max + 2) * (a_max + 2) <= N) a_max += 2;
+        }
+    }
+}
+
+/**
+ * Wall time to solve [n_start, n_start + count) with num_threads pinned
+ * threads. Returns a negative value if not all n were processed.
+ */
+static double run_scaling(uint64_t n_start, uint64_t count, int num_threads,
+                          const CpuTopology *topo) {
+#ifdef _OPENMP
+    WorkQueue queue;
+    work_queue_init(&queue, n_start, n_start + count, num_threads);
+    memset(scaling_stats, 0, sizeof(ScalingStats) * (size_t)num_threads);
+
+    double start = get_time();
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int tid = omp_get_thread_num();
+        topology_pin_thread(topo, tid);
+        uint64_t lo, hi;
+        while (work_queue_next(&queue, &lo, &hi)) {
+            scaling_solve_chunk(lo, hi, tid);
+        }
+    }
+    double elapsed = get_time() - start;
+
+    uint64_t processed = 0;
+    for (int t = 0; t < num_threads; t++) processed += scaling_stats[t].n_processed;
+    return processed == count ? elapsed : -1.0;
+#else
+    (void)n_start;
+    (void)count;
+    (void)num_threads;
+    (void)topo;
+    return -1.0;
+#endif
+}
+
+static int run_scaling_mode(uint64_t count, int max_threads, int repeat) {
+#ifndef _OPENMP
+    (void)count;
+    (void)max_threads;
+    (void)repeat;
+    fprintf(stderr, "Error: --scaling needs an OpenMP build\n");
+    return 1;
+#else
+    CpuTopology topo;
+    topology_detect(&topo);
+    if (max_threads <= 0) max_threads = topo.num_cpus;
+    if (max_threads > TOPOLOGY_MAX_CPUS) max_threads = TOPOLOGY_MAX_CPUS;
+
+    /* 1, 2, 4, ... and the maximum itself */
+    int counts[32], num_counts = 0;
+    for (int t = 1; t < max_threads; t *= 2) counts[num_counts++] = t;
+    counts[num_counts++] = max_threads;
+
+    printf("Thread scaling: 8n + 3 = a^2 + 2p\n");
+    printf("Iterations per run: %s\n", fmt_num(count));
+    printf("Topology: %d package%s, %d core%s, %d CPU%s available "
+           "(pinned: cores first, then SMT siblings)\n",
+           topo.num_packages, topo.num_packages == 1 ? "" : "s",
+           topo.num_cores, topo.num_cores == 1 ? "" : "s",
+           topo.num_cpus, topo.num_cpus == 1 ? "" : "s");
+    if (max_threads > topo.num_cpus) {
+        printf("Note: %d threads on %d CPUs: the top counts oversubscribe\n",
+               max_threads, topo.num_cpus);
+    }
+
+    for (size_t i = 0; i < NUM_SCALES; i++) {
+        uint64_t n_start = SCALES[i].n_start;
+        printf("\n%s (%d-bit N)\n", SCALES[i].label, SCALES[i].bits);
+        printf("%8s  %6s  %15s  %8s  %10s  %18s\n",
+               "Threads", "Cores", "Rate (n/sec)", "Speedup", "Efficiency",
+               "Per-thread (n/sec)");
+        printf("-----------------------------------------------------------------------\n");
+
+        /* Warmup (page faults, frequency ramp) */
+        run_scaling(n_start, count < WARMUP_COUNT ? count : WARMUP_COUNT, 1, &topo);
+
+        double base_rate = 0.0;
+        for (int k = 0; k < num_counts; k++) {
+            int threads = counts[k];
+            char name[32];
+            snprintf(name, sizeof(name), "scaling-%dt", threads);
+            double rate = 0.0;
+            for (int r = 0; r < repeat; r++) {
+                double elapsed = run_scaling(n_start, count, threads, &topo);
+                if (elapsed <= 0) {
+                    fprintf(stderr, "Error: scaling run at %d threads lost n values\n",
+                            threads);
+                    return 1;
+                }
+                rate = record_rate(name, SCALES[i].label, count / elapsed);
+            }
+            if (k == 0) base_rate = rate;
+            double speedup = rate / base_rate;
+            printf("%8d  %6d  %15s  %7.2fx  %9.1f%%  %18s\n",
+                   threads, topology_cores_used(&topo, threads),
+                   fmt_num((uint64_t)rate), speedup, 100.0 * speedup / threads,
+                   fmt_num((uint64_t)(rate / threads)));
+        }
+        printf("-----------------------------------------------------------------------\n");
+    }
+    return 0;
+#endif
+}
+
+/**
+ * The throughput table (with --fj32 / --pipeline comparison) and --perf
+ */
+static int run_tables(uint64_t count, int repeat, int pipeline_width, bool fj32,
+                      bool use_perf) {
+    PerfCounters counters;
+    PerfCounters *perf = NULL;
+    if (use_perf) {
+        const char *err;
+        if (!perf_counters_open(&counters, &err)) {
+            fprintf(stderr, "Error: --perf: %s\n", err);
+            return 1;
+        }
+        perf = &counters;
+    }
+
+    /* Print header */
+    printf("Benchmark: 8n + 3 = a^2 + 2p\n");
+    printf("Iterations per scale: %s\n", fmt_num(count));
+    if (repeat > 1) printf("Repeats: %d (rates are medians)\n", repeat);
+    printf("\n");
+
+    char alt_name[32];
+    snprintf(alt_name, sizeof(alt_name), fj32 ? "fj32" : "pipeline-%d", pipeline_width);
+    BenchResult results[NUM_SCALES], alt_results[NUM_SCALES];
+    bool has_alt[NUM_SCALES];
+
+    bool compare = pipeline_width > 0 || fj32;
+    if (compare) {
+        if (pipeline_width > 0) printf("Pipeline: %d n in flight\n\n", pipeline_width);
+        printf("%-8s  %6s  %15s  %15s  %8s  %12s\n",
+               "Scale", "Bits", "Per-n (n/sec)", fj32 ? "FJ32" : "Pipeline",
+               "Speedup", "Avg checks");
+        printf("-----------------------------------------------------------------------\n");
+    } else {
+        printf("%-8s  %6s  %15s  %12s  %8s\n",
+               "Scale", "Bits", "Rate (n/sec)", "Avg checks", "Time (s)");
+        printf("--------------------------------------------------------------\n");
+    }
+
+    /* Run benchmarks */
+    for (size_t i = 0; i < NUM_SCALES; i++) {
+        bool wide = SCALES[i].n_start > SOLVE_N64_LIMIT - count;
+        /* The pipeline and FJ32 comparisons are 64-bit N only */
+        has_alt[i] = compare && !wide;
+
+        BenchResult res = {0}, alt = {0};
+        double rate = 0.0, alt_rate = 0.0;
+        for (int r = 0; r < repeat; r++) {
+            res = wide ? run_benchmark_128(SCALES[i].n_start, count, perf)
+                       : run_benchmark(SCALES[i].n_start, count, perf);
+            rate = record_rate("per-n", SCALES[i].label, res.n_per_sec);
+            if (has_alt[i]) {
+                alt = fj32
+                    ? run_benchmark_fj32(SCALES[i].n_start, count, perf)
+                    : run_benchmark_pipeline(SCALES[i].n_start, count, pipeline_width, perf);
+                alt_rate = record_rate(alt_name, SCALES[i].label, alt.n_per_sec);
+            }
+        }
+        results[i] = res;
+        alt_results[i] = alt;
+
+        if (compare && wide) {
+            printf("%-8s  %6d  %15s  %15s  %8s  %12.2f\n",
+                   SCALES[i].label,
+                   SCALES[i].bits,
+                   fmt_num((uint64_t)rate),
+                   "-", "-",
+                   res.avg_checks);
+            continue;
+        }
+
+        if (compare) {
+            printf("%-8s  %6d  %15s  %15s  %7.2fx  %12.2f\n",
+                   SCALES[i].label,
+                   SCALES[i].bits,
+                   fmt_num((uint64_t)rate),
+                   fmt_num((uint64_t)alt_rate),
+                   alt_rate / rate,
+                   alt.avg_checks);
+            continue;
+        }
+
+        printf("%-8s  %6d  %15s  %12.2f  %8.2f\n",
+               SCALES[i].label,
+               SCALES[i].bits,
+               fmt_num((uint64_t)rate),
+               res.avg_checks,
+               res.elapsed_sec);
+    }
+
+    if (compare) {
+        printf("-----------------------------------------------------------------------\n");
+    } else {
+        printf("--------------------------------------------------------------\n");
+    }
+
+    if (perf) {
+        bool any_scaled = false;
+        printf("\nHardware counters (user mode, per n unless noted):\n\n");
+        printf("%-8s  %-8s  %5s  %10s  %10s  %8s  %8s  %8s  %8s\n",
+               "Scale", "Path", "IPC", "Cycles/n", "Cyc/test", "Br-miss",
+               "L1D-miss", "LLC-miss", "dTLB");
+        printf("----------------------------------------------------------------------------------------\n");
+        for (size_t i = 0; i < NUM_SCALES; i++) {
+            uint64_t tests = count_primality_tests(SCALES[i].n_start, count);
+            print_perf_row(SCALES[i].label, "per-n", &results[i], tests);
+            any_scaled |= results[i].perf.scaled;
+            if (has_alt[i]) {
+                print_perf_row("", fj32 ? "fj32" : "pipeline", &alt_results[i], tests);
+                any_scaled |= alt_results[i].perf.scaled;
+            }
+        }
+        printf("----------------------------------------------------------------------------------------\n");
+        printf("Cyc/test: cycles per primality test (Miller-Rabin, or BPSW past 2^64)\n");
+        if (any_scaled) {
+            printf("* counters multiplexed by the kernel: values are scaled estimates\n");
+        }
+        perf_counters_close(perf);
+    }
+
+    return 0;
+}
+
 /* ========================================================================== */
 /* Main                                                                       */
 /* ========================================================================== */
@@ -132,6 +663,19 @@ void print_usage(const char* program) {
     printf("Options:\n");
     printf("  --quick       Run with 1M iterations (faster)\n");
     printf("  --count N     Set iterations per scale (default: 10M)\n");
+    printf("  --pipeline K  Also run the multi-n pipeline with K n in flight (%d..%d)\n",
+           PIPELINE_MIN_WIDTH, PIPELINE_MAX_WIDTH);
+    printf("  --fj32        Also run the 32-bit FJ32 candidate path\n");
+    printf("  --perf        Hardware counters per scale: IPC, cycles per n and per\n");
+    printf("                primality test, branch/L1D/LLC/dTLB misses (Linux)\n");
+    printf("  --scaling     Thread scaling at 1, 2, 4, ... threads per scale (OpenMP,\n");
+    printf("                pinned: physical cores first, then SMT siblings)\n");
+    printf("  --threads N   Largest thread count for --scaling (default: all CPUs)\n");
+    printf("  --repeat K    Take every measurement K times, report medians (max %d)\n",
+           BENCH_MAX_REPEAT);
+    printf("  --json FILE   Write all rates (median, MAD, samples) as JSON\n");
+    printf("  --compare F   Flag significant regressions against a --json baseline\n");
+    printf("                (exit status 2 if any)\n");
     printf("  -h, --help    Show this help message\n");
 }
 
@@ -139,6 +683,14 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
 
     uint64_t count = DEFAULT_COUNT;
+    int pipeline_width = 0;
+    bool fj32 = false;
+    bool use_perf = false;
+    bool scaling = false;
+    int max_threads = 0;
+    int repeat = 1;
+    const char *json_path = NULL;
+    const char *compare_path = NULL;
 
     /* Parse arguments */
     for (int i = 1; i < argc; i++) {
@@ -146,6 +698,28 @@ int main(int argc, char** argv) {
             count = QUICK_COUNT;
         } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
             count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            pipeline_width = atoi(argv[++i]);
+            if (pipeline_width < PIPELINE_MIN_WIDTH) pipeline_width = PIPELINE_MIN_WIDTH;
+            if (pipeline_width > PIPELINE_MAX_WIDTH) pipeline_width = PIPELINE_MAX_WIDTH;
+            fj32 = false;
+        } else if (strcmp(argv[i], "--fj32") == 0) {
+            fj32 = true;
+            pipeline_width = 0;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = true;
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            scaling = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1) repeat = 1;
+            if (repeat > BENCH_MAX_REPEAT) repeat = BENCH_MAX_REPEAT;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare_path = argv[++i];
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -156,27 +730,30 @@ int main(int argc, char** argv) {
         }
     }
 
-    /* Print header */
-    printf("Benchmark: 8n + 3 = a^2 + 2p\n");
-    printf("Iterations per scale: %s\n\n", fmt_num(count));
-
-    printf("%-8s  %6s  %15s  %12s  %8s\n",
-           "Scale", "Bits", "Rate (n/sec)", "Avg checks", "Time (s)");
-    printf("--------------------------------------------------------------\n");
-
-    /* Run benchmarks */
-    for (size_t i = 0; i < NUM_SCALES; i++) {
-        BenchResult res = run_benchmark(SCALES[i].n_start, count);
-
-        printf("%-8s  %6d  %15s  %12.2f  %8.2f\n",
-               SCALES[i].label,
-               SCALES[i].bits,
-               fmt_num((uint64_t)res.n_per_sec),
-               res.avg_checks,
-               res.elapsed_sec);
+    /* Load the baseline first: a bad path should not cost a full run */
+    static BenchReport baseline;
+    if (compare_path) {
+        const char *err;
+        if (!bench_report_load_json(&baseline, compare_path, &err)) {
+            fprintf(stderr, "Error: --compare %s: %s\n", compare_path, err);
+            return 1;
+        }
     }
+    bench_report_init(&report, "benchmark_suite", count, repeat);
 
-    printf("--------------------------------------------------------------\n");
+    int status = scaling ? run_scaling_mode(count, max_threads, repeat)
+                         : run_tables(count, repeat, pipeline_width, fj32, use_perf);
+    if (status != 0) return status;
 
+    if (json_path) {
+        if (!bench_report_write_json(&report, json_path)) {
+            fprintf(stderr, "Error: cannot write %s\n", json_path);
+            return 1;
+        }
+        printf("\nResults written to %s\n", json_path);
+    }
+    if (compare_path && bench_report_compare(&report, &baseline, compare_path) > 0) {
+        return 2;
+    }
     return 0;
 }
@@ -1,7 +1,7 @@
 /*
  * Core Arithmetic Utilities
  *
- * Modular arithmetic and integer square root functions.
+ * Modular arithmetic and integer square root functions (64- and 128-bit).
  */
 
 #ifndef ARITH_H
@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <float.h>
 
 /**
  * 64-bit modular multiplication using 128-bit intermediate
@@ -38,9 +39,28 @@ static inline uint64_t powmod64(uint64_t base, uint64_t exp, uint64_t mod) {
 static inline uint64_t isqrt64(uint64_t n) {
     if (n == 0) return 0;
     uint64_t x = (uint64_t)sqrtl((long double)n);
-    /* Correct for floating-point errors */
+    /* Correct for floating-point errors (x <= 2^32 - 1 keeps x*x exact) */
+    if (x > 0xFFFFFFFFULL) x = 0xFFFFFFFFULL;
     while (x > 0 && x * x > n) x--;
-    while ((x + 1) * (x + 1) <= n) x++;
+    while (x < 0xFFFFFFFFULL && (x + 1) * (x + 1) <= n) x++;
+    return x;
+}
+
+/**
+ * Exact integer square root of a 128-bit value (result < 2^64)
+ */
+static inline uint64_t isqrt128(__uint128_t n) {
+    if ((n >> 64) == 0) return isqrt64((uint64_t)n);
+
+    long double s = sqrtl((long double)n);
+    uint64_t x = s >= 18446744073709551615.0L ? UINT64_MAX : (uint64_t)s;
+#if LDBL_MANT_DIG < 64
+    /* Seed only good to ~53 bits: one Newton step brings it within +-1 */
+    __uint128_t y = ((__uint128_t)x + n / x) >> 1;
+    x = y > UINT64_MAX ? UINT64_MAX : (uint64_t)y;
+#endif
+    while ((__uint128_t)x * x > n) x--;
+    while (x < UINT64_MAX && (__uint128_t)(x + 1) * (x + 1) <= n) x++;
     return x;
 }
 
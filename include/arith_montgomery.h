@@ -77,7 +77,8 @@ static inline uint64_t montgomery_mul(uint64_t a, uint64_t b, uint64_t n, uint64
 }
 
 /**
- * Compute r^2 mod n = 2^128 mod n
+ * Compute r^2 mod n = 2^128 mod n (two __uint128_t divisions; the hot
+ * paths use montgomery_r_squared_fast() below)
  */
 static inline uint64_t montgomery_r_squared(uint64_t n) {
     uint64_t r = (((__uint128_t)1 << 64) % n);
@@ -85,26 +86,209 @@ static inline uint64_t montgomery_r_squared(uint64_t n) {
 }
 
 /* ========================================================================== */
-/* Hybrid Miller-Rabin: Montgomery for small n, fallback for large n          */
+/* Cheap Setup (n < 2^63)                                                     */
 /* ========================================================================== */
 
+/*
+ * A candidate needs r mod n (the Montgomery form of 1) and the Montgomery
+ * forms of its witnesses. montgomery_r_squared() pays two __uint128_t
+ * divisions (__umodti3 library calls) for every candidate. Instead:
+ *
+ *   r mod n      (2^64 - n) mod n: one 64-bit division
+ *   2 r mod n    one modular doubling of r mod n (base 2 needs no r^2)
+ *   r^2 mod n    (r mod n) * 2^64 mod n: one divq on x86-64 (the high word
+ *                r mod n is below n, so the quotient fits 64 bits); other
+ *                targets have no 128/64 divide, so there 2 r mod n is
+ *                squared six times in Montgomery form (2 -> 2^2 -> ... ->
+ *                2^64 = r), division-free
+ *
+ * On an AVX-512 server core, the divq costs less than half as much as the
+ * chain of six squarings.
+ */
+
 /**
- * Miller-Rabin witness test using Montgomery (n < 2^63)
+ * r mod n = 2^64 mod n (one 64-bit division)
  */
-static inline bool mr_witness_montgomery_safe(uint64_t n, uint64_t a, uint64_t n_inv, uint64_t r_sq) {
-    if (a >= n) a %= n;
-    if (a == 0) return true;
+static inline uint64_t montgomery_one(uint64_t n) {
+    return (0 - n) % n;
+}
+
+/**
+ * 2x mod n for x < n < 2^63
+ */
+static inline uint64_t montgomery_double(uint64_t x, uint64_t n) {
+    x <<= 1;
+    return (x >= n) ? x - n : x;
+}
+
+/**
+ * r^2 mod n from one_m = r mod n, without __umodti3
+ */
+static inline uint64_t montgomery_r_squared_fast(uint64_t n, uint64_t n_inv, uint64_t one_m) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    uint64_t quotient, remainder;
+    __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(0ULL), "d"(one_m), "rm"(n));
+    (void)quotient;
+    (void)n_inv;
+    return remainder;
+#else
+    uint64_t x = montgomery_double(one_m, n);
+    for (int i = 0; i < 6; i++) x = montgomery_mul(x, x, n, n_inv);
+    return x;
+#endif
+}
+
+/* ========================================================================== */
+/* Kernel Variants (n < 2^63)                                                 */
+/* ========================================================================== */
+
+/*
+ * A Miller-Rabin witness is one long dependent chain of Montgomery
+ * products, so the latency of one product is its cost. Three kernels
+ * compute the product, selected at compile time with -DMONTGOMERY_KERNEL=:
+ *
+ *   0  MONTGOMERY_KERNEL_REDUCED  montgomery_reduce(): every result in
+ *                                 [0, n), one compare and cmov per product
+ *   1  MONTGOMERY_KERNEL_LAZY     no final subtraction: operands and results
+ *                                 stay in [0, 2n) and are normalized only
+ *                                 where they are compared. (t + m n) / r <
+ *                                 t / r + n, so t < 4 n^2 keeps results
+ *                                 below 2n for n < 2^62, and the doubled
+ *                                 squares of the base-2 witness (t < 8 n^2)
+ *                                 for n < 2^61. Larger n use REDUCED
+ *   2  MONTGOMERY_KERNEL_MULX     REDUCED as inline asm: MULX (BMI2) for the
+ *                                 two 64x64 products, ADCX (ADX) for the
+ *                                 carry. Without BMI2 and ADX in the build
+ *                                 flags (and so in the portable build) it
+ *                                 compiles to REDUCED
+ *
+ * The witness tests below (and so is_prime_fj64_fast()) use
+ * MONTGOMERY_KERNEL; the _k variants take the kernel as a constant
+ * argument, and analysis/benchmark_montgomery.c times all three. The
+ * default is the fastest measured: LAZY, which drops the compare and cmov
+ * from every link of the chain. On an AVX-512 server core with the release
+ * flags, LAZY is 16-27% faster per test than REDUCED and MULX 15-20%; with
+ * plain -O3 -march=native MULX only ties REDUCED (GCC emits MULX for the C
+ * kernels too once BMI2 is enabled) and LAZY keeps its lead, so LAZY is
+ * the default with and without BMI2.
+ */
+
+#define MONTGOMERY_KERNEL_REDUCED 0
+#define MONTGOMERY_KERNEL_LAZY 1
+#define MONTGOMERY_KERNEL_MULX 2
+
+#ifndef MONTGOMERY_KERNEL
+#define MONTGOMERY_KERNEL MONTGOMERY_KERNEL_LAZY
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    defined(__BMI2__) && defined(__ADX__)
+#define MONTGOMERY_HAVE_MULX 1
+#else
+#define MONTGOMERY_HAVE_MULX 0
+#endif
+
+/* Lazy kernel limits: 4 n^2 < n r for products, 8 n^2 < n r for doubled squares */
+#define MONTGOMERY_LAZY_THRESHOLD (1ULL << 62)
+#define MONTGOMERY_LAZY_BASE2_THRESHOLD (1ULL << 61)
+
+static const char *const MONTGOMERY_KERNEL_NAMES[] = {"reduced", "lazy", "mulx"};
+
+/**
+ * Montgomery reduction without the final subtraction: t r^(-1) mod n in
+ * [0, 2n) for t < 4 n^2 and n < 2^62 (see above)
+ */
+static inline uint64_t montgomery_reduce_lazy(__uint128_t t, uint64_t n, uint64_t n_inv) {
+    uint64_t m = (uint64_t)t * n_inv;
+    return (t + (__uint128_t)m * n) >> 64;
+}
 
+#if MONTGOMERY_HAVE_MULX
+/** hi:lo = a * b with MULX */
+static inline uint64_t montgomery_mulx_wide(uint64_t a, uint64_t b, uint64_t *hi) {
+    uint64_t lo;
+    __asm__("mulxq %[b], %[lo], %[hi]"
+            : [lo] "=r"(lo), [hi] "=r"(*hi)
+            : "d"(a), [b] "rm"(b));
+    return lo;
+}
+
+/** Montgomery reduction of hi:lo with MULX and ADCX */
+static inline uint64_t montgomery_reduce_mulx(uint64_t lo, uint64_t hi, uint64_t n,
+                                              uint64_t n_inv) {
+    uint64_t m = lo, mn_lo;
+    __asm__("imulq %[n_inv], %[m]\n\t"
+            "mulxq %[n], %[mn_lo], %[m]\n\t"
+            "addq %[mn_lo], %[lo]\n\t"
+            "adcxq %[m], %[hi]"
+            : [m] "+&d"(m), [mn_lo] "=&r"(mn_lo), [lo] "+&r"(lo), [hi] "+&r"(hi)
+            : [n] "rm"(n), [n_inv] "rm"(n_inv)
+            : "cc");
+    return (hi >= n) ? (hi - n) : hi;
+}
+#endif
+
+/**
+ * Montgomery product a b r^(-1) mod n with the given kernel (a constant);
+ * LAZY takes and returns values in [0, 2n)
+ */
+static inline uint64_t montgomery_mul_k(uint64_t a, uint64_t b, uint64_t n, uint64_t n_inv,
+                                        int kernel) {
+#if MONTGOMERY_HAVE_MULX
+    if (kernel == MONTGOMERY_KERNEL_MULX) {
+        uint64_t hi, lo = montgomery_mulx_wide(a, b, &hi);
+        return montgomery_reduce_mulx(lo, hi, n, n_inv);
+    }
+#endif
+    if (kernel == MONTGOMERY_KERNEL_LAZY)
+        return montgomery_reduce_lazy((__uint128_t)a * b, n, n_inv);
+    return montgomery_mul(a, b, n, n_inv);
+}
+
+/**
+ * 2^shift x^2 r^(-1) mod n (shift 0 or 1) with the given kernel
+ */
+static inline uint64_t montgomery_sqr_shift_k(uint64_t x, unsigned shift, uint64_t n,
+                                              uint64_t n_inv, int kernel) {
+#if MONTGOMERY_HAVE_MULX
+    if (kernel == MONTGOMERY_KERNEL_MULX) {
+        uint64_t hi, lo = montgomery_mulx_wide(x, x, &hi);
+        __uint128_t sq = (((__uint128_t)hi << 64) | lo) << shift;
+        return montgomery_reduce_mulx((uint64_t)sq, (uint64_t)(sq >> 64), n, n_inv);
+    }
+#endif
+    __uint128_t sq = ((__uint128_t)x * x) << shift;
+    if (kernel == MONTGOMERY_KERNEL_LAZY)
+        return montgomery_reduce_lazy(sq, n, n_inv);
+    return montgomery_reduce(sq, n, n_inv);
+}
+
+/** A kernel result in [0, n) */
+static inline uint64_t montgomery_normalize_k(uint64_t x, uint64_t n, int kernel) {
+    if (kernel == MONTGOMERY_KERNEL_LAZY)
+        return (x >= n) ? (x - n) : x;
+    return x;
+}
+
+/* ========================================================================== */
+/* Hybrid Miller-Rabin: Montgomery for small n, fallback for large n          */
+/* ========================================================================== */
+
+/**
+ * Miller-Rabin witness test on Montgomery forms (n < 2^63): a_m = a r mod n
+ * (a != 0 mod n), one_m = r mod n, with the given kernel (a constant; LAZY
+ * only for n < MONTGOMERY_LAZY_THRESHOLD)
+ */
+static inline bool mr_witness_montgomery_form_kernel(uint64_t n, uint64_t a_m, uint64_t n_inv,
+                                                     uint64_t one_m, int kernel) {
     uint64_t d = n - 1;
     int r = __builtin_ctzll(d);
     d >>= r;
 
-    /* Montgomery form: one_m = r mod n, neg_one_m = (n-1)*r mod n */
-    uint64_t one_m = montgomery_reduce(r_sq, n, n_inv);
+    /* neg_one_m = (n-1)*r mod n */
     uint64_t neg_one_m = n - one_m;
 
     /* Compute a^d mod n using branchless exponentiation */
-    uint64_t a_m = montgomery_reduce((__uint128_t)a * r_sq, n, n_inv);
     uint64_t x_m = one_m;
     uint64_t base_m = a_m;
     uint64_t exp = d;
@@ -115,25 +299,125 @@ static inline bool mr_witness_montgomery_safe(uint64_t n, uint64_t a, uint64_t n
      * exponent bits are unpredictable.
      */
     while (exp > 0) {
-        uint64_t temp = montgomery_mul(x_m, base_m, n, n_inv);
+        uint64_t temp = montgomery_mul_k(x_m, base_m, n, n_inv, kernel);
         x_m = (exp & 1) ? temp : x_m;
-        base_m = montgomery_mul(base_m, base_m, n, n_inv);
+        base_m = montgomery_sqr_shift_k(base_m, 0, n, n_inv, kernel);
         exp >>= 1;
     }
 
-    if (x_m == one_m || x_m == neg_one_m)
+    uint64_t x = montgomery_normalize_k(x_m, n, kernel);
+    if (x == one_m || x == neg_one_m)
         return true;
 
     for (int i = 1; i < r; i++) {
-        x_m = montgomery_mul(x_m, x_m, n, n_inv);
-        if (x_m == neg_one_m)
+        x_m = montgomery_sqr_shift_k(x_m, 0, n, n_inv, kernel);
+        x = montgomery_normalize_k(x_m, n, kernel);
+        if (x == neg_one_m)
             return true;
-        if (x_m == one_m)
+        if (x == one_m)
+            return false;
+    }
+    return false;
+}
+
+/* The lazy kernel's fallback for large n, out of line to keep one copy of
+   the loop in the callers */
+static __attribute__((noinline, unused)) bool
+mr_witness_montgomery_form_reduced(uint64_t n, uint64_t a_m, uint64_t n_inv, uint64_t one_m) {
+    return mr_witness_montgomery_form_kernel(n, a_m, n_inv, one_m, MONTGOMERY_KERNEL_REDUCED);
+}
+
+/** mr_witness_montgomery_form() with the given kernel (a constant) */
+static inline bool mr_witness_montgomery_form_k(uint64_t n, uint64_t a_m, uint64_t n_inv,
+                                                uint64_t one_m, int kernel) {
+    if (kernel == MONTGOMERY_KERNEL_LAZY && n >= MONTGOMERY_LAZY_THRESHOLD)
+        return mr_witness_montgomery_form_reduced(n, a_m, n_inv, one_m);
+    return mr_witness_montgomery_form_kernel(n, a_m, n_inv, one_m, kernel);
+}
+
+/**
+ * Miller-Rabin witness test on Montgomery forms (n < 2^63): a_m = a r mod n
+ * (a != 0 mod n), one_m = r mod n
+ */
+static inline bool mr_witness_montgomery_form(uint64_t n, uint64_t a_m, uint64_t n_inv,
+                                              uint64_t one_m) {
+    return mr_witness_montgomery_form_k(n, a_m, n_inv, one_m, MONTGOMERY_KERNEL);
+}
+
+/**
+ * Miller-Rabin witness test to base 2 (n < 2^63, odd, n > 2), from
+ * one_m = r mod n alone, with the given kernel (a constant; LAZY only for
+ * n < MONTGOMERY_LAZY_BASE2_THRESHOLD)
+ *
+ * Left-to-right exponentiation: every bit of d costs one Montgomery
+ * squaring, and a set bit multiplies by the base, which for base 2 is a
+ * doubling instead of a second Montgomery multiplication. The doubling is
+ * a shift of the 128-bit square before its reduction (2 x^2 < n r for
+ * n < 2^63, so the reduction stays exact), which keeps a separate
+ * conditional subtract off the dependency chain. The first set bit is the
+ * doubling of one_m itself (2 in Montgomery form), so no r^2 mod n is
+ * needed.
+ */
+static inline bool mr_witness_montgomery_base2_kernel(uint64_t n, uint64_t n_inv,
+                                                      uint64_t one_m, int kernel) {
+    uint64_t d = n - 1;
+    int r = __builtin_ctzll(d);
+    d >>= r;
+
+    uint64_t neg_one_m = n - one_m;
+
+    /* Top bit of d: x = 2; then per bit x = x^2, or 2 x^2 if the bit is set */
+    uint64_t x_m = montgomery_double(one_m, n);
+    for (int bit = 62 - __builtin_clzll(d); bit >= 0; bit--)
+        x_m = montgomery_sqr_shift_k(x_m, (d >> bit) & 1, n, n_inv, kernel);
+
+    uint64_t x = montgomery_normalize_k(x_m, n, kernel);
+    if (x == one_m || x == neg_one_m)
+        return true;
+
+    for (int i = 1; i < r; i++) {
+        x_m = montgomery_sqr_shift_k(x_m, 0, n, n_inv, kernel);
+        x = montgomery_normalize_k(x_m, n, kernel);
+        if (x == neg_one_m)
+            return true;
+        if (x == one_m)
             return false;
     }
     return false;
 }
 
+/* The lazy kernel's fallback for large n (out of line) */
+static __attribute__((noinline, unused)) bool
+mr_witness_montgomery_base2_reduced(uint64_t n, uint64_t n_inv, uint64_t one_m) {
+    return mr_witness_montgomery_base2_kernel(n, n_inv, one_m, MONTGOMERY_KERNEL_REDUCED);
+}
+
+/** mr_witness_montgomery_base2() with the given kernel (a constant) */
+static inline bool mr_witness_montgomery_base2_k(uint64_t n, uint64_t n_inv, uint64_t one_m,
+                                                 int kernel) {
+    if (kernel == MONTGOMERY_KERNEL_LAZY && n >= MONTGOMERY_LAZY_BASE2_THRESHOLD)
+        return mr_witness_montgomery_base2_reduced(n, n_inv, one_m);
+    return mr_witness_montgomery_base2_kernel(n, n_inv, one_m, kernel);
+}
+
+/** Miller-Rabin witness test to base 2 (n < 2^63, odd, n > 2) */
+static inline bool mr_witness_montgomery_base2(uint64_t n, uint64_t n_inv, uint64_t one_m) {
+    return mr_witness_montgomery_base2_k(n, n_inv, one_m, MONTGOMERY_KERNEL);
+}
+
+/**
+ * Miller-Rabin witness test using Montgomery (n < 2^63)
+ */
+static inline bool mr_witness_montgomery_safe(uint64_t n, uint64_t a, uint64_t n_inv, uint64_t r_sq) {
+    if (a >= n) a %= n;
+    if (a == 0) return true;
+
+    /* Montgomery form: one_m = r mod n */
+    uint64_t one_m = montgomery_reduce(r_sq, n, n_inv);
+    uint64_t a_m = montgomery_reduce((__uint128_t)a * r_sq, n, n_inv);
+    return mr_witness_montgomery_form(n, a_m, n_inv, one_m);
+}
+
 /**
  * Miller-Rabin witness test using standard arithmetic (fallback)
  */
@@ -167,7 +451,7 @@ static inline bool mr_witness_std(uint64_t n, uint64_t a) {
 static inline bool mr_witness_montgomery(uint64_t n, uint64_t a) {
     if (n < MONTGOMERY_SAFE_THRESHOLD) {
         uint64_t n_inv = montgomery_inverse(n);
-        uint64_t r_sq = montgomery_r_squared(n);
+        uint64_t r_sq = montgomery_r_squared_fast(n, n_inv, montgomery_one(n));
         return mr_witness_montgomery_safe(n, a, n_inv, r_sq);
     } else {
         return mr_witness_std(n, a);
@@ -187,4 +471,81 @@ static inline bool mr_witness_montgomery_cached(uint64_t n, uint64_t a,
     }
 }
 
+/* ========================================================================== */
+/* 32-bit Montgomery Arithmetic (n < 2^32, r = 2^32)                          */
+/* ========================================================================== */
+
+/*
+ * With r = 2^32 every product fits a 64-bit register, so no __uint128_t
+ * multiply is needed. The reduction subtracts m*n instead of adding it
+ * (n_inv = +n^(-1), not -n^(-1)): the low halves of t and m*n are equal, so
+ * t*r^(-1) mod n is hi(t) - hi(m*n), corrected by +n on borrow. Unlike the
+ * additive form this cannot overflow, so it is valid for all odd n < 2^32.
+ */
+
+/**
+ * Compute n^(-1) mod 2^32 using Newton's method (n odd)
+ */
+static inline uint32_t montgomery32_inverse(uint32_t n) {
+    uint32_t x = n;
+    x *= 2 - n * x;  /* 6 bits */
+    x *= 2 - n * x;  /* 12 bits */
+    x *= 2 - n * x;  /* 24 bits */
+    x *= 2 - n * x;  /* 48 bits */
+    return x;
+}
+
+/**
+ * Montgomery reduction: t * r^(-1) mod n, for t < n * 2^32
+ */
+static inline uint32_t montgomery32_reduce(uint64_t t, uint32_t n, uint32_t n_inv) {
+    uint32_t m = (uint32_t)t * n_inv;
+    uint32_t t_hi = (uint32_t)(t >> 32);
+    uint32_t mn_hi = (uint32_t)(((uint64_t)m * n) >> 32);
+    uint32_t u = t_hi - mn_hi;
+    return (t_hi < mn_hi) ? u + n : u;
+}
+
+static inline uint32_t montgomery32_mul(uint32_t a, uint32_t b, uint32_t n, uint32_t n_inv) {
+    return montgomery32_reduce((uint64_t)a * b, n, n_inv);
+}
+
+/**
+ * Miller-Rabin witness test for odd n < 2^32
+ * Two cheap divisions set up the Montgomery forms of 1 and a.
+ */
+static inline bool mr_witness_montgomery32(uint32_t n, uint32_t a) {
+    if (a >= n) a %= n;
+    if (a == 0) return true;
+
+    uint32_t d = n - 1;
+    int r = __builtin_ctz(d);
+    d >>= r;
+
+    uint32_t n_inv = montgomery32_inverse(n);
+    uint32_t one_m = (uint32_t)(-n) % n;                 /* 2^32 mod n */
+    uint32_t neg_one_m = n - one_m;
+    uint32_t base_m = (uint32_t)(((uint64_t)a << 32) % n);
+    uint32_t x_m = one_m;
+
+    while (d > 0) {
+        uint32_t temp = montgomery32_mul(x_m, base_m, n, n_inv);
+        x_m = (d & 1) ? temp : x_m;
+        base_m = montgomery32_mul(base_m, base_m, n, n_inv);
+        d >>= 1;
+    }
+
+    if (x_m == one_m || x_m == neg_one_m)
+        return true;
+
+    for (int i = 1; i < r; i++) {
+        x_m = montgomery32_mul(x_m, x_m, n, n_inv);
+        if (x_m == neg_one_m)
+            return true;
+        if (x_m == one_m)
+            return false;
+    }
+    return false;
+}
+
 #endif /* ARITH_MONTGOMERY_H */
@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include "arith.h"
 #include "prime.h"
+#include "dispatch.h"
 
 /* ========================================================================== */
 /* Configuration                                                              */
@@ -289,8 +290,10 @@ static inline void batch_check_remaining(BatchSieve *bs, uint64_t a) {
 
 /**
  * Process the entire batch, iterating through 'a' values largest-first.
- * This matches the strategy of the main search.
+ * This matches the strategy of the main search. Dispatched per batch in
+ * portable builds (dispatch.h).
  */
+DISPATCH_KERNEL
 static inline void batch_process(BatchSieve *bs) {
     /* Find a_max for the largest n in the batch */
     uint64_t n_max = bs->n_start + bs->batch_size - 1;
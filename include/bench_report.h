@@ -0,0 +1,307 @@
+/*
+ * Benchmark Reports: Repeats, Robust Statistics, JSON Baselines
+ *
+ * Shared by benchmark_suite and benchmark_approaches. A BenchReport holds
+ * throughput samples (n/sec, higher is better) keyed by (name, scale), e.g.
+ * ("per-n", "10^12"). With --repeat K every measurement is taken K times
+ * and summarised by its median and MAD (median absolute deviation), which
+ * a single slow run (a context switch, a frequency dip) cannot drag.
+ *
+ * --json FILE writes the report:
+ *
+ *   {
+ *     "program": "benchmark_suite",
+ *     "count": 10000000,
+ *     "repeat": 5,
+ *     "results": [
+ *       {"name": "per-n", "scale": "10^12", "median": 2913854.0,
+ *        "mad": 10211.5, "samples": [2913854.0, ...]},
+ *       ...
+ *     ]
+ *   }
+ *
+ * --compare BASELINE loads such a file and checks every entry present in
+ * both. The spread of a median is estimated as
+ *
+ *   sigma = max(1.4826 * sqrt(mad_base^2 + mad_new^2), BENCH_MIN_SIGMA * median_base)
+ *
+ * (1.4826 * MAD estimates a standard deviation; the floor keeps single
+ * runs and unusually quiet runs from flagging noise). An entry regresses
+ * when its median drops by more than BENCH_REGRESSION_Z * sigma, which
+ * with the defaults means at least 3%. Only baselines from the same
+ * machine and iteration count are meaningful.
+ */
+
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define BENCH_MAX_ENTRIES   128
+#define BENCH_MAX_REPEAT    64
+#define BENCH_REGRESSION_Z  3.0     /* Drop in sigmas that counts as a regression */
+#define BENCH_MIN_SIGMA     0.01    /* Sigma floor, relative to the baseline median */
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+typedef struct {
+    char name[32];
+    char scale[16];
+    double samples[BENCH_MAX_REPEAT];
+    int num_samples;
+    double median;
+    double mad;
+} BenchEntry;
+
+typedef struct {
+    const char *program;
+    uint64_t count;             /* n values per measurement */
+    int repeat;
+    BenchEntry entries[BENCH_MAX_ENTRIES];
+    int num_entries;
+} BenchReport;
+
+/* ========================================================================== */
+/* Statistics                                                                 */
+/* ========================================================================== */
+
+static inline int bench_cmp_double(const void *x, const void *y) {
+    double a = *(const double *)x, b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static inline double bench_median(const double *values, int k) {
+    double sorted[BENCH_MAX_REPEAT];
+    memcpy(sorted, values, sizeof(double) * (size_t)k);
+    qsort(sorted, (size_t)k, sizeof(double), bench_cmp_double);
+    return (k % 2) ? sorted[k / 2] : 0.5 * (sorted[k / 2 - 1] + sorted[k / 2]);
+}
+
+/* Median and median absolute deviation of k samples */
+static inline void bench_stats(const double *samples, int k, double *median, double *mad) {
+    if (k <= 0) {
+        *median = *mad = 0.0;
+        return;
+    }
+    *median = bench_median(samples, k);
+    double dev[BENCH_MAX_REPEAT];
+    for (int i = 0; i < k; i++) dev[i] = fabs(samples[i] - *median);
+    *mad = bench_median(dev, k);
+}
+
+/* ========================================================================== */
+/* Recording                                                                  */
+/* ========================================================================== */
+
+static inline void bench_report_init(BenchReport *r, const char *program,
+                                     uint64_t count, int repeat) {
+    memset(r, 0, sizeof(*r));
+    r->program = program;
+    r->count = count;
+    r->repeat = repeat;
+}
+
+static inline BenchEntry* bench_report_find(BenchReport *r, const char *name,
+                                            const char *scale) {
+    for (int i = 0; i < r->num_entries; i++) {
+        if (strcmp(r->entries[i].name, name) == 0 &&
+            strcmp(r->entries[i].scale, scale) == 0) {
+            return &r->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Add one throughput sample; returns the entry with its updated median
+ * and MAD (NULL if the report is full)
+ */
+static inline const BenchEntry* bench_report_add(BenchReport *r, const char *name,
+                                                 const char *scale, double rate) {
+    BenchEntry *e = bench_report_find(r, name, scale);
+    if (!e) {
+        if (r->num_entries >= BENCH_MAX_ENTRIES) return NULL;
+        e = &r->entries[r->num_entries++];
+        snprintf(e->name, sizeof(e->name), "%s", name);
+        snprintf(e->scale, sizeof(e->scale), "%s", scale);
+    }
+    if (e->num_samples < BENCH_MAX_REPEAT) e->samples[e->num_samples++] = rate;
+    bench_stats(e->samples, e->num_samples, &e->median, &e->mad);
+    return e;
+}
+
+/* ========================================================================== */
+/* JSON                                                                       */
+/* ========================================================================== */
+
+/**
+ * Write the report as JSON. Returns false on I/O error.
+ */
+static inline bool bench_report_write_json(const BenchReport *r, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"program\": \"%s\",\n  \"count\": %llu,\n  \"repeat\": %d,\n"
+               "  \"results\": [\n",
+            r->program, (unsigned long long)r->count, r->repeat);
+    for (int i = 0; i < r->num_entries; i++) {
+        const BenchEntry *e = &r->entries[i];
+        fprintf(f, "    {\"name\": \"%s\", \"scale\": \"%s\", \"median\": %.1f, "
+                   "\"mad\": %.1f, \"samples\": [",
+                e->name, e->scale, e->median, e->mad);
+        for (int k = 0; k < e->num_samples; k++) {
+            fprintf(f, "%s%.1f", k ? ", " : "", e->samples[k]);
+        }
+        fprintf(f, "]}%s\n", i + 1 < r->num_entries ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    bool ok = !ferror(f);
+    return (fclose(f) == 0) && ok;
+}
+
+/* Value of "key" inside [obj, end): string into out, or number into *num */
+static inline bool bench_json_field(const char *obj, const char *end, const char *key,
+                                    char *out, size_t out_size, double *num) {
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char *p = strstr(obj, pattern);
+    if (!p || p >= end) return false;
+    p += strlen(pattern);
+    while (p < end && (*p == ' ' || *p == ':' || *p == '\t' || *p == '\n')) p++;
+    if (p >= end) return false;
+    if (out) {
+        if (*p != '"') return false;
+        const char *q = strchr(p + 1, '"');
+        if (!q || q >= end || (size_t)(q - p - 1) >= out_size) return false;
+        memcpy(out, p + 1, (size_t)(q - p - 1));
+        out[q - p - 1] = '\0';
+        return true;
+    }
+    char *stop;
+    *num = strtod(p, &stop);
+    return stop != p;
+}
+
+/**
+ * Load the entries of a JSON report written by bench_report_write_json()
+ * (name, scale, median, mad; samples are not needed). Returns false and
+ * sets *err if the file cannot be read or holds no entries.
+ */
+static inline bool bench_report_load_json(BenchReport *r, const char *path,
+                                          const char **err) {
+    memset(r, 0, sizeof(*r));
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        *err = "cannot open";
+        return false;
+    }
+    char *text = NULL;
+    size_t len = 0, cap = 0;
+    char buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+        if (len + got + 1 > cap) {
+            cap = 2 * (len + got + 1);
+            char *grown = (char *)realloc(text, cap);
+            if (!grown) {
+                free(text);
+                fclose(f);
+                *err = "out of memory";
+                return false;
+            }
+            text = grown;
+        }
+        memcpy(text + len, buf, got);
+        len += got;
+    }
+    fclose(f);
+    if (!text) {
+        *err = "empty file";
+        return false;
+    }
+    text[len] = '\0';
+
+    const char *p = strstr(text, "\"results\"");
+    double count = 0;
+    if (p && bench_json_field(text, p, "count", NULL, 0, &count)) r->count = (uint64_t)count;
+    while (p && (p = strchr(p, '{')) != NULL && r->num_entries < BENCH_MAX_ENTRIES) {
+        const char *end = strchr(p, '}');
+        if (!end) break;
+        BenchEntry *e = &r->entries[r->num_entries];
+        if (bench_json_field(p, end, "name", e->name, sizeof(e->name), NULL) &&
+            bench_json_field(p, end, "scale", e->scale, sizeof(e->scale), NULL) &&
+            bench_json_field(p, end, "median", NULL, 0, &e->median) &&
+            bench_json_field(p, end, "mad", NULL, 0, &e->mad)) {
+            r->num_entries++;
+        }
+        p = end + 1;
+    }
+    free(text);
+    if (r->num_entries == 0) {
+        *err = "no benchmark results";
+        return false;
+    }
+    return true;
+}
+
+/* ========================================================================== */
+/* Baseline Comparison                                                        */
+/* ========================================================================== */
+
+/**
+ * Compare cur against base and print one row per common entry.
+ * Returns the number of significant regressions.
+ */
+static inline int bench_report_compare(const BenchReport *cur, BenchReport *base,
+                                       const char *base_path) {
+    int regressions = 0, compared = 0;
+    printf("\nComparison with %s (regression: drop > %.0f sigma, sigma >= %.0f%%):\n",
+           base_path, BENCH_REGRESSION_Z, 100.0 * BENCH_MIN_SIGMA);
+    if (base->count != cur->count) {
+        printf("Warning: baseline used %llu n per measurement, this run %llu\n",
+               (unsigned long long)base->count, (unsigned long long)cur->count);
+    }
+    printf("\n");
+    printf("%-14s  %-8s  %15s  %15s  %8s  %7s  %s\n",
+           "Name", "Scale", "Baseline", "Current", "Change", "Sigmas", "Verdict");
+    printf("------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < cur->num_entries; i++) {
+        const BenchEntry *c = &cur->entries[i];
+        const BenchEntry *b = bench_report_find(base, c->name, c->scale);
+        if (!b || b->median <= 0) continue;
+        compared++;
+
+        double sigma = 1.4826 * sqrt(b->mad * b->mad + c->mad * c->mad);
+        if (sigma < BENCH_MIN_SIGMA * b->median) sigma = BENCH_MIN_SIGMA * b->median;
+        double z = (c->median - b->median) / sigma;
+        const char *verdict = "ok";
+        if (z < -BENCH_REGRESSION_Z) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (z > BENCH_REGRESSION_Z) {
+            verdict = "faster";
+        }
+        printf("%-14s  %-8s  %15.0f  %15.0f  %+7.1f%%  %+7.1f  %s\n",
+               c->name, c->scale, b->median, c->median,
+               100.0 * (c->median - b->median) / b->median, z, verdict);
+    }
+    printf("------------------------------------------------------------------------------------\n");
+    if (compared == 0) {
+        printf("No entries in common with the baseline\n");
+    } else {
+        printf("%d of %d entries regressed\n", regressions, compared);
+    }
+    return regressions;
+}
+
+#endif /* BENCH_REPORT_H */
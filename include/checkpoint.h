@@ -0,0 +1,314 @@
+/*
+ * Crash-Safe Checkpoint / Resume for Long Searches
+ *
+ * A checkpoint records which sub-ranges of [n_start, n_end) are finished,
+ * together with the statistics totals accumulated over exactly those
+ * sub-ranges and the cumulative run time. A resumed run redoes only the
+ * unfinished gaps.
+ *
+ * The file is plain text so it can be inspected and edited by hand:
+ *
+ *   # 8n+3 search checkpoint
+ *   version 1
+ *   range <n_start> <n_end>
+ *   elapsed <seconds>
+ *   stats <n_processed> <total_checks> <counterexamples> <sieve_hits> <sieve_misses>
+ *   done <lo> <hi>
+ *   ...
+ *   end
+ *
+ * Saving is atomic: the file is written to "<path>.tmp", flushed to disk
+ * with fsync() and then renamed over <path>. A reader therefore sees either
+ * the previous or the new checkpoint, never a torn one. The trailing "end"
+ * line additionally guards against truncated files copied by hand.
+ *
+ * Requires POSIX (fsync, fileno): define _POSIX_C_SOURCE before including.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "work_queue.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define CHECKPOINT_VERSION 1
+
+/* Default interval between periodic saves, in seconds */
+#define CHECKPOINT_DEFAULT_INTERVAL 60.0
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+/* Statistics totals over the completed sub-ranges */
+typedef struct {
+    uint64_t n_processed;
+    uint64_t total_checks;
+    uint64_t counterexamples;
+    uint64_t sieve_hits;
+    uint64_t sieve_misses;
+} CheckpointStats;
+
+typedef struct {
+    uint64_t n_start;           /* Full search range */
+    uint64_t n_end;
+    double elapsed;             /* Run time of all previous runs, seconds */
+    CheckpointStats stats;      /* Totals over the completed sub-ranges */
+    WorkRange *done;            /* Completed sub-ranges (unsorted until normalized) */
+    int num_done;
+    int cap_done;
+} Checkpoint;
+
+/* ========================================================================== */
+/* Creation / Destruction                                                     */
+/* ========================================================================== */
+
+static inline void checkpoint_init(Checkpoint *cp, uint64_t n_start, uint64_t n_end) {
+    memset(cp, 0, sizeof(*cp));
+    cp->n_start = n_start;
+    cp->n_end = n_end;
+}
+
+static inline void checkpoint_free(Checkpoint *cp) {
+    free(cp->done);
+    cp->done = NULL;
+    cp->num_done = cp->cap_done = 0;
+}
+
+/* ========================================================================== */
+/* Range Bookkeeping                                                          */
+/* ========================================================================== */
+
+static int checkpoint_range_cmp(const void *a, const void *b) {
+    const WorkRange *x = (const WorkRange*)a;
+    const WorkRange *y = (const WorkRange*)b;
+    return (x->lo > y->lo) - (x->lo < y->lo);
+}
+
+/**
+ * Sort the completed ranges and merge adjacent/overlapping ones.
+ */
+static inline void checkpoint_normalize(Checkpoint *cp) {
+    if (cp->num_done < 2) return;
+    qsort(cp->done, cp->num_done, sizeof(WorkRange), checkpoint_range_cmp);
+
+    int out = 0;
+    for (int i = 1; i < cp->num_done; i++) {
+        if (cp->done[i].lo <= cp->done[out].hi) {
+            if (cp->done[i].hi > cp->done[out].hi) cp->done[out].hi = cp->done[i].hi;
+        } else {
+            cp->done[++out] = cp->done[i];
+        }
+    }
+    cp->num_done = out + 1;
+}
+
+/**
+ * Record [lo, hi) as finished, along with the statistics gathered over it.
+ * Returns false on allocation failure.
+ */
+static inline bool checkpoint_add(Checkpoint *cp, uint64_t lo, uint64_t hi,
+                                  const CheckpointStats *delta) {
+    if (lo >= hi) return true;
+
+    if (cp->num_done == cp->cap_done) {
+        /* Merge before growing: completed chunks are usually contiguous */
+        checkpoint_normalize(cp);
+        if (cp->num_done == cp->cap_done) {
+            int cap = cp->cap_done ? 2 * cp->cap_done : 64;
+            WorkRange *grown = (WorkRange*)realloc(cp->done, cap * sizeof(WorkRange));
+            if (!grown) return false;
+            cp->done = grown;
+            cp->cap_done = cap;
+        }
+    }
+    cp->done[cp->num_done].lo = lo;
+    cp->done[cp->num_done].hi = hi;
+    cp->num_done++;
+
+    if (delta) {
+        cp->stats.n_processed += delta->n_processed;
+        cp->stats.total_checks += delta->total_checks;
+        cp->stats.counterexamples += delta->counterexamples;
+        cp->stats.sieve_hits += delta->sieve_hits;
+        cp->stats.sieve_misses += delta->sieve_misses;
+    }
+    return true;
+}
+
+/**
+ * Copy src into dst, so that dst can be saved while other threads keep
+ * adding to src. dst (initialized) keeps and grows its own buffer.
+ * Returns false on allocation failure.
+ */
+static inline bool checkpoint_copy(Checkpoint *dst, Checkpoint *src) {
+    checkpoint_normalize(src);
+    if (dst->cap_done < src->num_done) {
+        WorkRange *grown = (WorkRange*)realloc(dst->done, src->num_done * sizeof(WorkRange));
+        if (!grown) return false;
+        dst->done = grown;
+        dst->cap_done = src->num_done;
+    }
+    WorkRange *done = dst->done;
+    int cap = dst->cap_done;
+    *dst = *src;
+    dst->done = done;
+    dst->cap_done = cap;
+    if (src->num_done > 0) memcpy(done, src->done, src->num_done * sizeof(WorkRange));
+    return true;
+}
+
+/**
+ * Number of n values already finished.
+ */
+static inline uint64_t checkpoint_done_count(Checkpoint *cp) {
+    checkpoint_normalize(cp);
+    uint64_t count = 0;
+    for (int i = 0; i < cp->num_done; i++) {
+        count += cp->done[i].hi - cp->done[i].lo;
+    }
+    return count;
+}
+
+/**
+ * Compute the unfinished gaps of [n_start, n_end).
+ * Returns a malloc'd array (caller frees) and stores its length in *count.
+ */
+static inline WorkRange* checkpoint_pending(Checkpoint *cp, int *count) {
+    checkpoint_normalize(cp);
+
+    WorkRange *pending = (WorkRange*)malloc((cp->num_done + 1) * sizeof(WorkRange));
+    if (!pending) return NULL;
+
+    int num = 0;
+    uint64_t pos = cp->n_start;
+    for (int i = 0; i < cp->num_done; i++) {
+        uint64_t lo = cp->done[i].lo < cp->n_start ? cp->n_start : cp->done[i].lo;
+        uint64_t hi = cp->done[i].hi > cp->n_end ? cp->n_end : cp->done[i].hi;
+        if (lo >= hi) continue;
+        if (lo > pos) {
+            pending[num].lo = pos;
+            pending[num].hi = lo;
+            num++;
+        }
+        if (hi > pos) pos = hi;
+    }
+    if (pos < cp->n_end) {
+        pending[num].lo = pos;
+        pending[num].hi = cp->n_end;
+        num++;
+    }
+
+    *count = num;
+    return pending;
+}
+
+/* ========================================================================== */
+/* File I/O                                                                   */
+/* ========================================================================== */
+
+/**
+ * Atomically write the checkpoint to path (write temp file, fsync, rename).
+ * extra_elapsed is added to the stored run time (time of the current run).
+ * Returns false on any I/O error; the previous checkpoint is left intact.
+ */
+static inline bool checkpoint_save(Checkpoint *cp, const char *path, double extra_elapsed) {
+    char tmp_path[4096];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return false;
+    }
+
+    checkpoint_normalize(cp);
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) return false;
+
+    fprintf(f, "# 8n+3 search checkpoint\n");
+    fprintf(f, "version %d\n", CHECKPOINT_VERSION);
+    fprintf(f, "range %llu %llu\n",
+            (unsigned long long)cp->n_start, (unsigned long long)cp->n_end);
+    fprintf(f, "elapsed %.3f\n", cp->elapsed + extra_elapsed);
+    fprintf(f, "stats %llu %llu %llu %llu %llu\n",
+            (unsigned long long)cp->stats.n_processed,
+            (unsigned long long)cp->stats.total_checks,
+            (unsigned long long)cp->stats.counterexamples,
+            (unsigned long long)cp->stats.sieve_hits,
+            (unsigned long long)cp->stats.sieve_misses);
+    for (int i = 0; i < cp->num_done; i++) {
+        fprintf(f, "done %llu %llu\n",
+                (unsigned long long)cp->done[i].lo, (unsigned long long)cp->done[i].hi);
+    }
+    fprintf(f, "end\n");
+
+    bool ok = (fflush(f) == 0) && (fsync(fileno(f)) == 0);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Load a checkpoint written by checkpoint_save().
+ * Returns false if the file is missing, truncated or malformed.
+ */
+static inline bool checkpoint_load(Checkpoint *cp, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    checkpoint_init(cp, 0, 0);
+
+    char line[256];
+    bool have_range = false, have_end = false;
+    int version = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long a, b, c, d, e;
+        double secs;
+
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (strncmp(line, "end", 3) == 0) {
+            have_end = true;
+            break;
+        } else if (sscanf(line, "version %d", &version) == 1) {
+            if (version != CHECKPOINT_VERSION) break;
+        } else if (sscanf(line, "range %llu %llu", &a, &b) == 2) {
+            cp->n_start = a;
+            cp->n_end = b;
+            have_range = true;
+        } else if (sscanf(line, "elapsed %lf", &secs) == 1) {
+            cp->elapsed = secs;
+        } else if (sscanf(line, "stats %llu %llu %llu %llu %llu", &a, &b, &c, &d, &e) == 5) {
+            cp->stats.n_processed = a;
+            cp->stats.total_checks = b;
+            cp->stats.counterexamples = c;
+            cp->stats.sieve_hits = d;
+            cp->stats.sieve_misses = e;
+        } else if (sscanf(line, "done %llu %llu", &a, &b) == 2) {
+            if (!checkpoint_add(cp, a, b, NULL)) break;
+        } else {
+            break;  /* Unknown line: treat the file as corrupt */
+        }
+    }
+    fclose(f);
+
+    if (!have_range || !have_end || version != CHECKPOINT_VERSION ||
+        cp->n_start >= cp->n_end) {
+        checkpoint_free(cp);
+        return false;
+    }
+    checkpoint_normalize(cp);
+    return true;
+}
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,113 @@
+/*
+ * Runtime ISA Dispatch for the Hot Kernels
+ *
+ * The default build uses -march=native, so a binary runs at full speed
+ * only on CPUs like the build host. `make portable` builds for an
+ * x86-64-v2 baseline instead and compiles each hot kernel three times:
+ *
+ *   default          x86-64-v2 (SSE4.2, POPCNT)
+ *   arch=x86-64-v3   AVX2, BMI2, FMA, LZCNT, MOVBE
+ *   arch=x86-64-v4   AVX-512 F/BW/CD/DQ/VL
+ *
+ * with GCC's target_clones attribute (DISPATCH_KERNEL). The dynamic
+ * loader runs one ifunc resolver per kernel at startup, which picks the
+ * highest level the CPU supports; later calls are ordinary indirect calls.
+ * The inline helpers a kernel calls (trial division, the Montgomery
+ * Miller-Rabin of arith_montgomery.h, the wheel bitmap access) are inlined
+ * into each clone and compiled for its level.
+ *
+ * Kernels are dispatched at the granularity of one n (the per-n walk), one
+ * pipeline slice, one sieve segment or one batch, never per candidate, so
+ * the indirect call is lost in the work it does. The AVX-512 paths that
+ * need more than x86-64-v4 (the IFMA Miller-Rabin of prime_ifma.h) or that
+ * are worth having in every build (the vector trial division of
+ * trial_vector.h) keep their own target attributes and run-time checks.
+ *
+ * Other builds define DISPATCH_KERNEL as nothing: one variant, compiled for
+ * the build flags. ./search --print-dispatch shows the variants chosen.
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#if defined(DISPATCH_CLONES) && defined(__x86_64__) && defined(__GNUC__) && \
+    !defined(__clang__) && defined(__ELF__)
+#define DISPATCH_ACTIVE 1
+#define DISPATCH_KERNEL \
+    __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define DISPATCH_ACTIVE 0
+#define DISPATCH_KERNEL
+#endif
+
+/* ========================================================================== */
+/* CPU Level                                                                  */
+/* ========================================================================== */
+
+typedef enum {
+    DISPATCH_BASELINE = 0,      /* x86-64-v2 or lower, or not x86-64 */
+    DISPATCH_V3 = 1,
+    DISPATCH_V4 = 2
+} DispatchLevel;
+
+static const char *const DISPATCH_LEVEL_NAMES[] = {
+    "x86-64-v2", "x86-64-v3", "x86-64-v4"
+};
+
+/**
+ * Highest x86-64 level the CPU supports: the clone the ifunc resolvers
+ * pick in a portable build.
+ */
+static inline DispatchLevel dispatch_cpu_level(void) {
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4")) return DISPATCH_V4;
+    if (__builtin_cpu_supports("x86-64-v3")) return DISPATCH_V3;
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    bool v3 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") &&
+              __builtin_cpu_supports("fma");
+    if (v3 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl")) {
+        return DISPATCH_V4;
+    }
+    if (v3) return DISPATCH_V3;
+#endif
+    return DISPATCH_BASELINE;
+}
+
+/* ========================================================================== */
+/* Report                                                                     */
+/* ========================================================================== */
+
+/** One row of the --print-dispatch table */
+static inline void dispatch_print_row(FILE *out, const char *kernel, const char *variant) {
+    fprintf(out, "  %-44s %s\n", kernel, variant);
+}
+
+/**
+ * Print the build mode, the CPU level and the variant of each cloned
+ * kernel (--print-dispatch); callers add rows for their own run-time
+ * checked kernels with dispatch_print_row().
+ */
+static inline void dispatch_print(FILE *out) {
+    DispatchLevel level = dispatch_cpu_level();
+    const char *variant = DISPATCH_ACTIVE ? DISPATCH_LEVEL_NAMES[level] : "build flags";
+
+    fprintf(out, "Build:     %s\n", DISPATCH_ACTIVE
+            ? "portable (x86-64-v2 baseline, kernels cloned for v3 and v4)"
+            : "single variant (no runtime dispatch; make portable for one)");
+    fprintf(out, "CPU level: %s\n\n", DISPATCH_LEVEL_NAMES[level]);
+
+    dispatch_print_row(out, "Kernel", "Variant");
+    dispatch_print_row(out, "per-n walk (trial division, Montgomery MR)", variant);
+    dispatch_print_row(out, "pipeline (batched Montgomery MR)", variant);
+    dispatch_print_row(out, "sieve segments (--sieve-threshold)", variant);
+    dispatch_print_row(out, "batch sieve (search_batched, library)", variant);
+}
+
+#endif /* DISPATCH_H */
@@ -0,0 +1,258 @@
+/* Generated by analysis/gen_fj32_table.c - do not edit */
+static const uint16_t fj32_bases[4096] = {
+    2,     3,     2,     7,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     3,     2,
+    2,     5,     2,     3,     6,     2,     2,     2,     3,     2,     2,     3,     2,     3,     2,     2,
+    3,     3,     3,     2,     2,     2,     2,     2,     2,     2,     3,     2,     2,     6,     5,     3,
+    5,     2,     2,     2,     5,     2,     3,     2,     3,     2,     2,     2,     3,     2,     2,     2,
+    2,     2,     5,     2,     3,     2,     5,     2,     5,     2,     2,     2,     2,     5,     2,     2,
+    7,     2,     2,     2,     2,     3,     3,     3,     3,     2,     5,     3,     5,     3,     2,     2,
+    2,     2,     2,     10,    3,     5,     2,     2,     2,     3,     2,     3,     2,     2,     2,     3,
+    2,     2,     2,     2,     2,     6,     2,     2,     2,     2,     2,     3,     3,     3,     2,     3,
+    2,     2,     2,     3,     2,     2,     3,     5,     2,     2,     7,     3,     6,     2,     2,     5,
+    5,     2,     2,     2,     3,     2,     2,     14,    3,     2,     3,     2,     5,     2,     5,     2,
+    2,     2,     2,     3,     2,     2,     2,     5,     3,     2,     2,     3,     3,     5,     2,     5,
+    2,     2,     2,     2,     5,     2,     5,     2,     6,     2,     2,     2,     3,     2,     6,     2,
+    3,     2,     3,     2,     2,     2,     3,     3,     5,     2,     3,     5,     3,     2,     2,     2,
+    3,     3,     2,     3,     2,     2,     3,     2,     2,     3,     3,     2,     5,     2,     6,     3,
+    2,     2,     2,     2,     3,     3,     2,     2,     2,     2,     2,     2,     2,     2,     3,     2,
+    6,     2,     3,     2,     2,     2,     2,     3,     2,     7,     3,     5,     2,     3,     2,     2,
+    7,     3,     2,     2,     6,     2,     2,     2,     2,     3,     2,     3,     2,     7,     2,     2,
+    3,     2,     2,     3,     2,     6,     2,     2,     2,     6,     5,     2,     2,     5,     3,     2,
+    2,     5,     2,     2,     2,     2,     2,     2,     2,     5,     7,     2,     2,     7,     2,     2,
+    2,     13,    2,     10,    2,     3,     2,     2,     2,     3,     2,     2,     3,     2,     3,     2,
+    2,     2,     2,     3,     2,     5,     10,    2,     5,     2,     2,     2,     2,     3,     2,     6,
+    2,     2,     2,     5,     2,     3,     2,     5,     5,     3,     2,     2,     2,     10,    6,     3,
+    2,     3,     3,     3,     3,     3,     2,     5,     2,     2,     2,     2,     2,     3,     3,     2,
+    5,     2,     2,     2,     3,     2,     3,     2,     3,     2,     2,     3,     3,     5,     2,     2,
+    3,     2,     2,     2,     3,     6,     2,     3,     2,     3,     3,     3,     5,     2,     2,     2,
+    5,     2,     2,     2,     2,     2,     2,     2,     2,     6,     2,     5,     2,     2,     2,     5,
+    2,     5,     2,     3,     2,     7,     3,     2,     3,     11,    2,     5,     5,     3,     2,     3,
+    3,     2,     5,     2,     5,     2,     2,     2,     2,     2,     2,     2,     2,     5,     11,    3,
+    2,     2,     6,     3,     2,     2,     6,     2,     3,     2,     3,     2,     2,     3,     2,     3,
+    2,     3,     3,     2,     3,     2,     2,     3,     2,     2,     2,     2,     2,     3,     2,     2,
+    2,     2,     3,     3,     2,     2,     2,     2,     2,     2,     2,     6,     12,    3,     2,     3,
+    5,     2,     14,    2,     6,     10,    5,     2,     2,     6,     3,     2,     3,     2,     5,     3,
+    2,     5,     3,     2,     2,     3,     6,     2,     2,     2,     2,     2,     3,     2,     3,     2,
+    2,     5,     6,     2,     2,     3,     2,     2,     2,     2,     3,     2,     3,     2,     2,     2,
+    2,     2,     2,     5,     2,     3,     2,     2,     2,     3,     3,     2,     3,     2,     3,     5,
+    5,     5,     2,     2,     2,     2,     2,     2,     3,     2,     2,     3,     2,     2,     3,     2,
+    6,     2,     2,     2,     2,     2,     2,     5,     2,     2,     3,     5,     2,     2,     2,     2,
+    2,     2,     3,     2,     3,     2,     5,     2,     3,     7,     2,     3,     3,     2,     2,     2,
+    2,     2,     2,     2,     2,     2,     2,     3,     2,     2,     2,     3,     2,     2,     6,     2,
+    5,     3,     3,     2,     5,     2,     2,     2,     3,     3,     2,     2,     6,     2,     5,     2,
+    2,     3,     2,     10,    2,     3,     2,     2,     2,     2,     2,     2,     2,     11,    2,     2,
+    2,     2,     7,     2,     2,     2,     2,     3,     2,     5,     2,     2,     5,     2,     3,     2,
+    2,     5,     3,     2,     2,     3,     2,     3,     2,     2,     2,     3,     2,     2,     2,     5,
+    2,     2,     3,     5,     3,     2,     5,     2,     2,     2,     2,     3,     3,     3,     2,     5,
+    6,     5,     2,     2,     3,     2,     2,     2,     2,     2,     2,     2,     3,     2,     5,     2,
+    6,     2,     2,     2,     2,     2,     2,     3,     5,     3,     3,     2,     2,     2,     2,     2,
+    2,     2,     7,     2,     3,     2,     2,     2,     3,     3,     2,     6,     3,     3,     2,     3,
+    5,     5,     2,     2,     5,     3,     5,     3,     6,     5,     3,     2,     2,     2,     3,     3,
+    6,     2,     2,     5,     2,     2,     2,     2,     12,    5,     2,     2,     2,     2,     2,     2,
+    2,     2,     2,     2,     2,     2,     2,     5,     5,     2,     2,     2,     3,     3,     2,     2,
+    2,     2,     2,     2,     3,     5,     5,     7,     3,     2,     2,     3,     2,     3,     2,     2,
+    2,     5,     2,     2,     2,     2,     2,     5,     2,     3,     2,     2,     5,     2,     2,     5,
+    5,     3,     2,     2,     2,     2,     2,     2,     2,     5,     3,     2,     2,     2,     2,     2,
+    3,     2,     2,     2,     3,     2,     6,     5,     2,     5,     2,     3,     2,     2,     2,     2,
+    2,     2,     5,     2,     3,     7,     3,     2,     2,     2,     2,     2,     3,     2,     2,     6,
+    3,     2,     2,     2,     2,     2,     2,     6,     5,     2,     5,     2,     3,     2,     2,     2,
+    6,     2,     2,     3,     2,     2,     3,     3,     5,     2,     2,     3,     2,     2,     2,     2,
+    2,     2,     2,     7,     2,     3,     5,     2,     2,     3,     2,     2,     3,     2,     2,     2,
+    3,     2,     2,     2,     3,     2,     2,     3,     3,     2,     2,     5,     2,     3,     2,     6,
+    3,     2,     10,    2,     5,     2,     2,     2,     6,     3,     5,     2,     2,     5,     5,     2,
+    2,     10,    3,     6,     2,     3,     2,     2,     5,     5,     3,     3,     2,     2,     2,     2,
+    3,     2,     2,     2,     2,     2,     2,     2,     2,     3,     6,     2,     2,     2,     3,     2,
+    2,     2,     2,     2,     2,     5,     5,     2,     2,     2,     2,     5,     2,     2,     3,     3,
+    2,     2,     5,     3,     3,     2,     2,     2,     3,     6,     2,     7,     5,     2,     6,     2,
+    5,     2,     2,     2,     2,     3,     3,     2,     2,     2,     2,     3,     6,     2,     5,     5,
+    2,     6,     10,    2,     6,     2,     2,     3,     3,     2,     3,     5,     2,     2,     3,     3,
+    3,     2,     2,     2,     2,     5,     2,     2,     2,     2,     2,     5,     2,     5,     2,     2,
+    2,     3,     3,     2,     5,     2,     2,     2,     3,     2,     6,     2,     3,     6,     5,     2,
+    3,     3,     2,     2,     2,     5,     6,     6,     3,     3,     7,     2,     3,     2,     2,     2,
+    3,     2,     2,     2,     2,     2,     2,     3,     3,     3,     2,     2,     2,     2,     5,     13,
+    2,     3,     2,     2,     3,     3,     2,     2,     2,     6,     2,     2,     2,     2,     2,     2,
+    2,     2,     3,     2,     2,     2,     2,     2,     3,     5,     2,     2,     2,     2,     3,     2,
+    2,     5,     5,     3,     2,     2,     2,     5,     2,     3,     3,     2,     3,     2,     2,     2,
+    2,     2,     2,     2,     2,     2,     3,     2,     2,     5,     2,     2,     2,     2,     2,     2,
+    2,     2,     3,     2,     2,     5,     2,     3,     3,     2,     2,     3,     3,     2,     2,     2,
+    2,     2,     5,     2,     2,     3,     2,     3,     2,     2,     3,     5,     3,     2,     3,     5,
+    3,     2,     2,     3,     2,     2,     2,     2,     2,     2,     3,     2,     2,     5,     2,     2,
+    3,     5,     2,     3,     5,     5,     2,     3,     3,     2,     2,     2,     2,     2,     2,     3,
+    2,     2,     2,     3,     5,     2,     2,     3,     2,     5,     2,     10,    10,    2,     2,     13,
+    3,     2,     2,     5,     2,     2,     6,     2,     2,     5,     3,     5,     3,     2,     6,     3,
+    2,     2,     3,     2,     2,     2,     3,     2,     2,     2,     2,     11,    5,     3,     2,     5,
+    2,     2,     5,     2,     3,     3,     3,     2,     3,     2,     3,     3,     2,     2,     5,     3,
+    2,     3,     3,     3,     2,     2,     3,     5,     2,     2,     2,     3,     2,     5,     2,     2,
+    3,     2,     2,     3,     2,     3,     6,     2,     2,     5,     2,     5,     3,     6,     2,     2,
+    3,     2,     2,     5,     2,     11,    2,     2,     2,     5,     2,     2,     3,     2,     2,     3,
+    2,     6,     2,     2,     5,     5,     2,     2,     3,     2,     2,     2,     2,     2,     2,     2,
+    7,     10,    2,     2,     2,     2,     5,     2,     2,     2,     3,     3,     2,     2,     3,     5,
+    2,     2,     3,     3,     2,     2,     2,     5,     2,     2,     2,     3,     2,     2,     5,     2,
+    3,     6,     6,     2,     2,     3,     2,     3,     2,     3,     6,     10,    2,     2,     3,     2,
+    3,     2,     2,     3,     2,     3,     5,     2,     3,     5,     3,     5,     2,     2,     2,     3,
+    3,     3,     2,     3,     2,     2,     3,     3,     2,     2,     2,     2,     3,     2,     2,     2,
+    2,     2,     6,     5,     2,     3,     2,     7,     2,     2,     2,     2,     2,     5,     2,     2,
+    2,     2,     2,     7,     3,     3,     3,     2,     2,     2,     2,     2,     3,     5,     2,     2,
+    5,     5,     3,     2,     2,     3,     2,     3,     3,     3,     2,     2,     3,     2,     2,     5,
+    2,     2,     3,     5,     2,     6,     2,     3,     2,     2,     3,     2,     2,     2,     2,     5,
+    2,     3,     2,     2,     2,     2,     2,     2,     7,     2,     3,     2,     3,     3,     3,     2,
+    2,     5,     5,     2,     2,     2,     2,     2,     2,     2,     10,    2,     2,     2,     2,     5,
+    3,     2,     2,     2,     3,     2,     5,     6,     2,     3,     3,     2,     2,     2,     2,     3,
+    2,     3,     3,     2,     2,     2,     2,     3,     2,     6,     5,     5,     2,     3,     2,     2,
+    2,     3,     3,     3,     3,     2,     2,     3,     2,     2,     2,     2,     7,     5,     3,     5,
+    3,     3,     6,     2,     2,     3,     5,     6,     2,     3,     5,     5,     3,     3,     6,     2,
+    3,     2,     2,     2,     7,     2,     2,     2,     2,     2,     3,     2,     2,     5,     2,     3,
+    2,     6,     2,     2,     2,     2,     6,     2,     2,     2,     3,     5,     2,     2,     2,     2,
+    2,     2,     5,     7,     2,     2,     13,    3,     2,     5,     3,     3,     2,     2,     2,     2,
+    3,     3,     2,     3,     2,     2,     2,     2,     2,     2,     2,     2,     3,     3,     2,     2,
+    2,     2,     3,     2,     3,     2,     3,     2,     2,     7,     3,     3,     2,     2,     2,     3,
+    3,     2,     2,     3,     3,     2,     3,     3,     2,     2,     3,     2,     3,     2,     2,     2,
+    2,     2,     2,     5,     2,     2,     2,     3,     2,     2,     2,     6,     2,     2,     2,     2,
+    2,     2,     6,     7,     3,     3,     3,     2,     2,     3,     3,     5,     2,     2,     2,     3,
+    3,     2,     2,     2,     2,     3,     7,     2,     2,     2,     2,     2,     2,     5,     3,     2,
+    2,     3,     2,     2,     7,     2,     3,     2,     2,     5,     2,     2,     2,     2,     2,     2,
+    2,     2,     2,     2,     2,     2,     2,     5,     2,     2,     2,     3,     2,     2,     2,     2,
+    2,     3,     2,     3,     3,     3,     2,     2,     5,     2,     2,     2,     2,     2,     2,     3,
+    6,     6,     2,     5,     6,     3,     2,     7,     3,     3,     2,     2,     2,     2,     2,     5,
+    6,     2,     5,     2,     5,     7,     2,     6,     2,     2,     2,     2,     2,     2,     3,     5,
+    3,     5,     2,     2,     2,     2,     3,     3,     12,    2,     2,     2,     3,     5,     2,     2,
+    3,     2,     2,     2,     5,     2,     3,     2,     2,     2,     2,     2,     5,     3,     2,     6,
+    2,     2,     3,     3,     2,     2,     2,     3,     2,     5,     2,     2,     2,     2,     3,     2,
+    2,     3,     2,     2,     5,     6,     3,     2,     2,     2,     5,     3,     3,     2,     2,     2,
+    2,     2,     3,     3,     2,     2,     2,     2,     3,     5,     3,     3,     2,     5,     2,     2,
+    3,     2,     2,     3,     2,     3,     2,     2,     6,     3,     2,     3,     3,     2,     2,     2,
+    2,     2,     2,     2,     3,     2,     2,     5,     2,     3,     2,     2,     2,     3,     2,     6,
+    2,     3,     2,     3,     3,     3,     3,     3,     5,     2,     7,     3,     2,     5,     3,     2,
+    3,     3,     3,     6,     2,     2,     5,     2,     5,     2,     6,     5,     2,     3,     2,     2,
+    2,     2,     2,     2,     2,     3,     5,     2,     3,     2,     5,     3,     5,     2,     2,     2,
+    3,     3,     2,     2,     3,     6,     2,     2,     2,     2,     2,     2,     3,     5,     2,     5,
+    7,     6,     3,     2,     2,     3,     2,     2,     2,     3,     2,     6,     2,     2,     3,     2,
+    2,     5,     2,     2,     2,     2,     3,     2,     2,     6,     3,     5,     3,     3,     5,     3,
+    10,    5,     2,     2,     2,     5,     5,     5,     2,     2,     5,     2,     2,     3,     6,     2,
+    2,     2,     2,     2,     2,     3,     3,     2,     2,     3,     3,     5,     2,     3,     5,     3,
+    5,     5,     6,     5,     10,    2,     5,     3,     7,     3,     2,     3,     2,     2,     6,     5,
+    2,     2,     6,     3,     2,     2,     7,     2,     2,     2,     5,     3,     5,     2,     2,     3,
+    3,     2,     3,     3,     2,     2,     2,     2,     2,     6,     2,     2,     2,     2,     3,     2,
+    2,     2,     2,     5,     2,     2,     2,     5,     2,     5,     3,     2,     6,     3,     2,     2,
+    2,     3,     3,     2,     2,     2,     2,     3,     2,     2,     6,     2,     3,     2,     2,     2,
+    5,     3,     2,     2,     7,     3,     2,     3,     2,     6,     2,     2,     10,    2,     2,     2,
+    2,     2,     7,     2,     5,     3,     2,     2,     2,     2,     3,     2,     3,     3,     3,     3,
+    2,     2,     2,     2,     3,     2,     2,     3,     2,     6,     5,     2,     3,     5,     5,     2,
+    3,     2,     7,     3,     2,     6,     2,     2,     18,    6,     2,     2,     2,     6,     2,     2,
+    5,     2,     3,     2,     2,     3,     2,     15,    3,     3,     2,     7,     10,    3,     2,     2,
+    3,     2,     5,     2,     2,     6,     2,     2,     2,     3,     2,     2,     6,     2,     2,     3,
+    5,     7,     3,     3,     2,     2,     2,     2,     2,     2,     2,     3,     3,     2,     2,     2,
+    3,     3,     7,     2,     6,     2,     2,     2,     2,     2,     2,     3,     2,     2,     5,     2,
+    5,     3,     2,     7,     2,     2,     2,     2,     5,     2,     3,     2,     2,     3,     2,     3,
+    2,     2,     6,     3,     2,     3,     2,     3,     2,     2,     2,     6,     5,     2,     2,     3,
+    3,     7,     12,    2,     6,     7,     3,     2,     2,     2,     6,     2,     11,    2,     2,     2,
+    3,     2,     2,     5,     6,     2,     2,     2,     2,     3,     3,     2,     2,     2,     2,     3,
+    5,     2,     2,     3,     2,     2,     2,     5,     5,     2,     2,     3,     2,     5,     2,     5,
+    3,     5,     7,     2,     3,     6,     3,     2,     2,     2,     5,     3,     2,     2,     3,     3,
+    2,     2,     2,     2,     5,     5,     3,     2,     3,     2,     2,     2,     2,     2,     3,     2,
+    3,     3,     2,     3,     5,     2,     2,     3,     2,     5,     2,     2,     5,     2,     2,     2,
+    6,     2,     3,     2,     2,     2,     2,     2,     2,     2,     2,     5,     5,     3,     5,     2,
+    5,     2,     2,     2,     2,     3,     5,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+    5,     3,     2,     5,     2,     2,     6,     2,     3,     2,     3,     3,     5,     5,     3,     2,
+    2,     2,     2,     3,     6,     3,     5,     2,     3,     2,     2,     2,     10,    2,     2,     2,
+    2,     3,     6,     2,     3,     2,     2,     2,     2,     2,     3,     3,     5,     2,     2,     5,
+    2,     5,     2,     2,     2,     2,     10,    2,     2,     2,     3,     2,     2,     6,     3,     5,
+    2,     2,     2,     2,     2,     3,     2,     2,     2,     5,     2,     2,     11,    2,     2,     2,
+    2,     7,     2,     3,     2,     3,     5,     3,     2,     5,     2,     3,     2,     3,     2,     5,
+    2,     2,     5,     5,     3,     2,     2,     3,     2,     2,     5,     2,     2,     2,     2,     2,
+    2,     3,     2,     2,     3,     2,     5,     6,     2,     2,     2,     3,     5,     2,     2,     5,
+    3,     2,     2,     3,     2,     5,     2,     2,     2,     5,     5,     5,     3,     5,     2,     2,
+    2,     2,     3,     2,     2,     2,     2,     2,     2,     2,     2,     2,     5,     2,     2,     5,
+    2,     3,     3,     2,     2,     3,     2,     2,     3,     2,     3,     3,     3,     6,     2,     3,
+    3,     2,     2,     2,     2,     6,     7,     2,     2,     2,     2,     6,     2,     3,     2,     6,
+    3,     5,     2,     2,     2,     2,     3,     2,     2,     2,     7,     2,     2,     2,     6,     2,
+    2,     5,     3,     5,     2,     2,     2,     2,     3,     2,     2,     5,     3,     2,     2,     2,
+    2,     3,     2,     2,     3,     2,     2,     7,     2,     2,     2,     2,     2,     2,     2,     2,
+    5,     2,     2,     5,     2,     2,     2,     2,     3,     3,     2,     5,     2,     5,     2,     2,
+    2,     2,     7,     5,     3,     3,     2,     2,     2,     2,     5,     7,     2,     7,     2,     2,
+    5,     2,     6,     3,     5,     2,     2,     6,     2,     2,     2,     5,     5,     2,     5,     2,
+    2,     2,     2,     6,     2,     2,     2,     3,     3,     2,     2,     2,     2,     3,     2,     5,
+    2,     2,     5,     3,     2,     2,     3,     2,     2,     3,     3,     2,     2,     6,     2,     5,
+    2,     3,     2,     2,     2,     6,     5,     2,     2,     3,     2,     2,     2,     2,     3,     3,
+    3,     3,     2,     2,     3,     2,     2,     2,     2,     2,     7,     2,     2,     2,     6,     6,
+    2,     2,     5,     2,     2,     2,     2,     2,     2,     7,     3,     3,     2,     2,     2,     2,
+    11,    2,     5,     5,     2,     2,     2,     2,     2,     3,     2,     2,     2,     6,     3,     13,
+    2,     2,     2,     5,     3,     2,     2,     2,     2,     2,     3,     2,     3,     2,     2,     2,
+    6,     2,     2,     2,     2,     2,     2,     3,     3,     2,     2,     2,     2,     6,     2,     2,
+    2,     2,     3,     2,     6,     5,     11,    2,     5,     2,     3,     3,     2,     3,     2,     2,
+    2,     2,     3,     5,     3,     3,     2,     6,     2,     2,     2,     3,     5,     3,     2,     2,
+    2,     2,     2,     2,     5,     2,     3,     5,     3,     2,     2,     5,     2,     2,     2,     3,
+    2,     2,     3,     6,     3,     2,     2,     2,     3,     6,     2,     2,     2,     2,     6,     5,
+    2,     2,     2,     2,     2,     5,     3,     2,     2,     2,     2,     3,     2,     2,     2,     2,
+    2,     10,    3,     2,     2,     2,     2,     3,     2,     3,     2,     3,     2,     2,     3,     2,
+    2,     2,     2,     5,     3,     5,     3,     2,     2,     5,     2,     3,     3,     5,     6,     2,
+    2,     2,     3,     5,     3,     2,     5,     3,     3,     5,     3,     6,     2,     3,     3,     3,
+    3,     2,     2,     5,     3,     2,     2,     2,     2,     2,     2,     2,     2,     5,     2,     2,
+    2,     7,     3,     3,     3,     3,     2,     3,     2,     3,     2,     5,     5,     2,     3,     2,
+    2,     2,     2,     2,     3,     2,     2,     3,     2,     3,     2,     2,     2,     3,     2,     2,
+    2,     5,     5,     3,     2,     2,     2,     3,     2,     2,     2,     2,     13,    2,     2,     5,
+    2,     2,     2,     2,     2,     3,     2,     6,     3,     2,     7,     3,     3,     3,     3,     7,
+    3,     2,     3,     2,     2,     2,     2,     3,     2,     11,    2,     2,     2,     5,     2,     2,
+    2,     2,     11,    2,     2,     3,     2,     3,     3,     2,     3,     2,     2,     5,     3,     3,
+    2,     2,     3,     2,     5,     3,     2,     5,     2,     2,     3,     2,     2,     2,     3,     3,
+    5,     2,     2,     2,     12,    2,     3,     2,     3,     2,     2,     6,     2,     7,     5,     2,
+    3,     2,     2,     2,     2,     3,     2,     6,     3,     2,     3,     2,     2,     10,    2,     6,
+    2,     2,     5,     3,     3,     2,     3,     2,     5,     2,     2,     3,     2,     2,     2,     2,
+    3,     2,     2,     2,     3,     2,     2,     2,     2,     5,     2,     3,     2,     2,     2,     2,
+    2,     2,     7,     5,     2,     3,     2,     2,     5,     6,     2,     2,     2,     2,     2,     2,
+    2,     2,     3,     2,     2,     3,     3,     2,     3,     3,     3,     2,     2,     2,     2,     2,
+    3,     2,     3,     10,    2,     2,     2,     2,     2,     3,     2,     10,    2,     7,     2,     3,
+    2,     6,     3,     2,     2,     2,     2,     3,     2,     2,     3,     2,     10,    3,     5,     2,
+    3,     2,     2,     3,     2,     2,     2,     6,     2,     6,     2,     2,     2,     6,     2,     2,
+    2,     5,     3,     2,     2,     2,     2,     3,     2,     2,     2,     2,     5,     2,     2,     3,
+    3,     2,     3,     2,     2,     12,    2,     6,     5,     2,     2,     2,     2,     2,     2,     2,
+    2,     3,     2,     2,     3,     2,     2,     3,     5,     3,     5,     3,     2,     3,     3,     3,
+    2,     2,     5,     7,     2,     3,     2,     2,     2,     3,     5,     5,     2,     10,    3,     2,
+    2,     2,     7,     3,     5,     3,     13,    2,     3,     3,     2,     7,     2,     3,     5,     2,
+    3,     3,     2,     5,     5,     2,     6,     3,     5,     2,     5,     3,     2,     10,    2,     3,
+    2,     2,     3,     2,     2,     3,     2,     6,     2,     2,     3,     2,     2,     3,     3,     2,
+    2,     2,     2,     2,     2,     3,     6,     5,     2,     2,     2,     2,     5,     2,     6,     3,
+    2,     2,     2,     2,     3,     6,     2,     2,     2,     2,     2,     2,     3,     2,     2,     2,
+    5,     2,     2,     2,     3,     7,     3,     2,     5,     2,     2,     5,     2,     2,     7,     5,
+    2,     2,     2,     2,     2,     5,     2,     2,     2,     2,     2,     2,     5,     3,     2,     5,
+    2,     2,     3,     3,     2,     2,     2,     2,     2,     5,     5,     2,     2,     2,     2,     6,
+    2,     2,     2,     2,     2,     2,     3,     2,     5,     2,     2,     5,     2,     2,     3,     6,
+    2,     3,     2,     2,     2,     3,     2,     3,     2,     5,     6,     2,     5,     3,     2,     3,
+    3,     2,     5,     2,     2,     2,     5,     2,     2,     5,     2,     2,     10,    2,     2,     2,
+    2,     5,     2,     2,     2,     2,     5,     2,     2,     2,     2,     3,     2,     6,     2,     3,
+    5,     3,     2,     2,     10,    2,     2,     3,     5,     2,     2,     2,     3,     2,     5,     5,
+    3,     6,     5,     2,     3,     2,     3,     2,     3,     2,     3,     2,     2,     3,     5,     3,
+    3,     2,     2,     2,     5,     2,     3,     2,     2,     2,     2,     6,     2,     2,     2,     5,
+    2,     5,     3,     7,     3,     2,     2,     2,     5,     2,     2,     3,     2,     2,     6,     2,
+    2,     2,     2,     2,     2,     2,     2,     3,     2,     2,     2,     2,     3,     2,     3,     2,
+    3,     2,     5,     3,     3,     2,     2,     2,     2,     3,     3,     2,     6,     2,     6,     5,
+    3,     2,     5,     6,     2,     2,     5,     2,     5,     2,     2,     2,     2,     2,     3,     2,
+    5,     6,     3,     5,     2,     2,     7,     2,     2,     2,     3,     3,     2,     2,     2,     2,
+    3,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     3,     2,     2,     2,     2,
+    2,     2,     3,     2,     2,     2,     2,     2,     2,     2,     3,     2,     2,     2,     2,     2,
+    2,     2,     2,     2,     2,     2,     3,     2,     2,     2,     3,     2,     5,     2,     2,     2,
+    2,     2,     2,     3,     2,     2,     2,     2,     2,     2,     5,     2,     2,     2,     2,     2,
+    2,     2,     2,     3,     2,     2,     2,     6,     2,     7,     5,     2,     5,     2,     2,     2,
+    5,     3,     5,     6,     3,     2,     2,     2,     2,     3,     2,     6,     2,     2,     3,     2,
+    5,     2,     3,     2,     2,     5,     3,     2,     5,     2,     2,     2,     2,     2,     2,     2,
+    2,     3,     2,     5,     2,     2,     2,     2,     3,     5,     2,     3,     2,     2,     2,     10,
+    2,     2,     2,     2,     2,     2,     3,     3,     2,     2,     2,     3,     3,     2,     3,     2,
+    3,     3,     2,     2,     2,     2,     2,     2,     5,     2,     2,     3,     3,     2,     2,     2,
+    3,     2,     6,     2,     2,     2,     6,     3,     7,     3,     5,     7,     2,     3,     2,     2,
+    2,     5,     3,     2,     2,     2,     2,     3,     2,     3,     2,     2,     2,     5,     2,     2,
+    7,     2,     2,     3,     2,     2,     3,     2,     2,     2,     3,     2,     2,     2,     3,     3,
+    6,     2,     3,     2,     2,     2,     2,     3,     5,     3,     2,     3,     3,     6,     3,     2,
+    5,     5,     2,     3,     2,     2,     6,     2,     2,     2,     2,     5,     2,     3,     3,     2,
+    2,     2,     2,     5,     2,     2,     2,     2,     2,     2,     2,     2,     5,     2,     2,     2,
+    3,     2,     2,     2,     3,     3,     2,     2,     3,     5,     6,     7,     2,     3,     5,     2,
+    3,     2,     2,     3,     5,     5,     2,     2,     6,     2,     2,     5,     6,     2,     6,     2,
+    2,     2,     2,     3,     2,     2,     2,     3,     6,     5,     3,     2,     3,     2,     3,     3,
+    2,     2,     5,     13,    2,     2,     3,     2,     2,     2,     3,     2,     3,     5,     2,     2,
+    2,     2,     2,     3,     2,     2,     3,     3,     2,     2,     2,     3,     2,     3,     5,     2,
+    2,     5,     2,     7,     2,     2,     2,     2,     2,     10,    3,     7,     5,     2,     2,     3,
+    5,     3,     7,     2,     5,     2,     2,     2,     2,     2,     7,     3,     2,     5,     2,     2,
+    2,     2,     3,     2,     2,     5,     3,     2,     2,     6,     2,     2,     3,     2,     5,     2,
+    3,     2,     10,    3,     2,     2,     5,     5,     2,     2,     2,     2,     2,     2,     3,     3,
+    5,     2,     2,     7,     2,     5,     2,     2,     2,     2,     3,     2,     2,     6,     2,     2,
+    2,     5,     2,     2,     2,     2,     5,     2,     2,     2,     3,     2,     3,     3,     6,     3,
+    2,     3,     2,     2,     2,     3,     3,     2,     2,     2,     3,     2,     2,     2,     3,     2};
@@ -10,14 +10,15 @@
 #include <stdint.h>
 
 #define NUM_FMT_BUFS 8
-#define NUM_FMT_SIZE 32
+#define NUM_FMT_SIZE 56  /* 2^128 - 1 with separators */
 
-static char fmt_bufs[NUM_FMT_BUFS][NUM_FMT_SIZE];
-static int fmt_buf_idx = 0;
+/* Per thread: the progress monitor formats while workers may report */
+static _Thread_local char fmt_bufs[NUM_FMT_BUFS][NUM_FMT_SIZE];
+static _Thread_local int fmt_buf_idx = 0;
 
 /**
  * Format a number with comma separators (e.g., 1000000 -> "1,000,000")
- * Uses rotating static buffers - safe for up to NUM_FMT_BUFS concurrent uses
+ * Uses rotating per-thread buffers - safe for up to NUM_FMT_BUFS concurrent uses
  */
 static inline const char* fmt_num(uint64_t n) {
     char* buf = fmt_bufs[fmt_buf_idx];
@@ -46,4 +47,32 @@ static inline const char* fmt_num(uint64_t n) {
     return buf;
 }
 
+/**
+ * fmt_num() for 128-bit values (e.g. N = 8n + 3 past n = 2^61)
+ */
+static inline const char* fmt_num128(__uint128_t n) {
+    if ((n >> 64) == 0) return fmt_num((uint64_t)n);
+
+    char* buf = fmt_bufs[fmt_buf_idx];
+    fmt_buf_idx = (fmt_buf_idx + 1) % NUM_FMT_BUFS;
+
+    char temp[NUM_FMT_SIZE];
+    int len = 0;
+    while (n > 0) {
+        temp[len++] = '0' + (int)(n % 10);
+        n /= 10;
+    }
+
+    int pos = 0;
+    for (int i = len - 1; i >= 0; i--) {
+        buf[pos++] = temp[i];
+        if (i > 0 && i % 3 == 0) {
+            buf[pos++] = ',';
+        }
+    }
+    buf[pos] = '\0';
+
+    return buf;
+}
+
 #endif /* FMT_H */
@@ -0,0 +1,235 @@
+/*
+ * Hardware Performance Counters via perf_event_open (Linux)
+ *
+ * Wall time alone does not say whether a change moved the bottleneck from
+ * the multiplier to memory or branches. A PerfCounters set counts the
+ * calling thread (user mode only) around a measured region:
+ *
+ *   core group     cycles, instructions, branch misses
+ *   memory group   L1D read misses, LLC read misses, dTLB read misses
+ *
+ * Events in one group are scheduled together, so ratios within a group
+ * (IPC, branch misses per cycle) are exact. The two groups are separate so
+ * that each fits the general-purpose counters of common PMUs; when the PMU
+ * cannot hold both at once the kernel time-slices them, and each group's
+ * counts are scaled by time_enabled / time_running (PerfSample.scaled).
+ *
+ * Member events the CPU or hypervisor does not expose are skipped and read
+ * as unavailable; only cycles is required. Opening needs
+ * /proc/sys/kernel/perf_event_paranoid <= 2 (the default on most
+ * distributions allows user-mode self-monitoring).
+ *
+ * Requires syscall(): define _DEFAULT_SOURCE before including. On other
+ * systems perf_counters_open() fails with "not supported".
+ */
+
+#ifndef PERF_EVENTS_H
+#define PERF_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/* ========================================================================== */
+/* Events                                                                     */
+/* ========================================================================== */
+
+typedef enum {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_NUM_EVENTS
+} PerfEvent;
+
+/* Events [0, PERF_MEMORY_FIRST) form the core group, the rest the memory group */
+#define PERF_MEMORY_FIRST PERF_L1D_MISSES
+
+typedef struct {
+    int fd[PERF_NUM_EVENTS];        /* -1 if the event could not be opened */
+    uint64_t id[PERF_NUM_EVENTS];   /* Kernel event ids (PERF_FORMAT_ID) */
+    int leader[2];                  /* Group leader fds: core, memory (-1 if none) */
+} PerfCounters;
+
+typedef struct {
+    uint64_t value[PERF_NUM_EVENTS];
+    bool valid[PERF_NUM_EVENTS];    /* Opened and scheduled at least once */
+    bool scaled;                    /* Some group was multiplexed (values estimated) */
+} PerfSample;
+
+/* ========================================================================== */
+/* Setup                                                                      */
+/* ========================================================================== */
+
+#ifdef __linux__
+
+static inline void perf_event_attr_for(struct perf_event_attr *attr, PerfEvent event) {
+    static const uint64_t cache_read_miss =
+        ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+    case PERF_CYCLES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_BRANCH_MISSES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case PERF_L1D_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_L1D | cache_read_miss;
+        break;
+    case PERF_LLC_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_LL | cache_read_miss;
+        break;
+    case PERF_DTLB_MISSES:
+    default:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB | cache_read_miss;
+        break;
+    }
+}
+
+static inline int perf_event_open_fd(struct perf_event_attr *attr, int group_fd) {
+    /* The leader starts disabled; members follow it */
+    attr->disabled = (group_fd == -1);
+    return (int)syscall(SYS_perf_event_open, attr, 0 /* this thread */, -1 /* any CPU */,
+                        group_fd, 0);
+}
+
+#endif /* __linux__ */
+
+static inline void perf_counters_close(PerfCounters *pc) {
+#ifdef __linux__
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (pc->fd[e] >= 0) close(pc->fd[e]);
+        pc->fd[e] = -1;
+    }
+#endif
+    pc->leader[0] = pc->leader[1] = -1;
+}
+
+/**
+ * Open the counters for the calling thread. Fails only if cycles cannot be
+ * counted; other events are optional. On failure *err (if given) describes
+ * the reason.
+ */
+static inline bool perf_counters_open(PerfCounters *pc, const char **err) {
+    const char *dummy;
+    if (!err) err = &dummy;
+    *err = NULL;
+
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) pc->fd[e] = -1;
+    memset(pc->id, 0, sizeof(pc->id));
+    pc->leader[0] = pc->leader[1] = -1;
+
+#ifdef __linux__
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        int group = e < PERF_MEMORY_FIRST ? 0 : 1;
+        struct perf_event_attr attr;
+        perf_event_attr_for(&attr, (PerfEvent)e);
+        int fd = perf_event_open_fd(&attr, pc->leader[group]);
+        if (fd < 0) {
+            if (e == PERF_CYCLES) {
+                *err = (errno == EACCES || errno == EPERM)
+                    ? "permission denied (see /proc/sys/kernel/perf_event_paranoid)"
+                    : "hardware cycle counter not available";
+                return false;
+            }
+            continue;   /* Optional event: reads as unavailable */
+        }
+        if (ioctl(fd, PERF_EVENT_IOC_ID, &pc->id[e]) != 0) {
+            close(fd);
+            continue;
+        }
+        pc->fd[e] = fd;
+        if (pc->leader[group] < 0) pc->leader[group] = fd;
+    }
+    return true;
+#else
+    *err = "not supported on this platform";
+    return false;
+#endif
+}
+
+/* ========================================================================== */
+/* Measurement                                                                */
+/* ========================================================================== */
+
+/**
+ * Zero and start all groups
+ */
+static inline void perf_counters_start(PerfCounters *pc) {
+#ifdef __linux__
+    for (int g = 0; g < 2; g++) {
+        if (pc->leader[g] < 0) continue;
+        ioctl(pc->leader[g], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(pc->leader[g], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void)pc;
+#endif
+}
+
+/**
+ * Stop all groups and read them into *out
+ */
+static inline void perf_counters_stop(PerfCounters *pc, PerfSample *out) {
+    memset(out, 0, sizeof(*out));
+#ifdef __linux__
+    for (int g = 0; g < 2; g++) {
+        if (pc->leader[g] >= 0) {
+            ioctl(pc->leader[g], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+    for (int g = 0; g < 2; g++) {
+        if (pc->leader[g] < 0) continue;
+
+        /* nr, time_enabled, time_running, then {value, id} per event */
+        uint64_t buf[3 + 2 * PERF_NUM_EVENTS];
+        ssize_t got = read(pc->leader[g], buf, sizeof(buf));
+        if (got < (ssize_t)(3 * sizeof(uint64_t))) continue;
+        uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+        if (running == 0) continue;     /* Never scheduled: all unavailable */
+        if (running < enabled) out->scaled = true;
+        double scale = (double)enabled / (double)running;
+
+        for (uint64_t i = 0; i < nr && 3 + 2 * i + 1 < sizeof(buf) / sizeof(buf[0]); i++) {
+            uint64_t value = buf[3 + 2 * i], id = buf[3 + 2 * i + 1];
+            for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+                if (pc->fd[e] < 0 || pc->id[e] != id) continue;
+                out->value[e] = (uint64_t)(value * scale + 0.5);
+                out->valid[e] = true;
+            }
+        }
+    }
+#else
+    (void)pc;
+#endif
+}
+
+#endif /* PERF_EVENTS_H */
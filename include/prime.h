@@ -86,19 +86,37 @@ static inline bool mr_witness(uint64_t n, uint64_t a) {
  * Optimizations:
  * - Pre-compute Montgomery constants once and reuse for both witnesses
  * - Prefetch hash table entry while computing Montgomery constants
+ * - Cheap setup (arith_montgomery.h): r mod n from one 64-bit division
+ *   and base 2 by doubling it; r^2 mod n only for the second witness,
+ *   which most composites never reach
+ * - Base 2 by left-to-right exponentiation with doublings
+ *   (mr_witness_montgomery_base2): one Montgomery multiply per bit of d
+ * - Montgomery products by the MONTGOMERY_KERNEL variant (arith_montgomery.h;
+ *   lazy reduction in [0, 2n) by default)
  */
 static inline bool is_prime_fj64_fast(uint64_t n) {
     /* Compute hash and prefetch table entry early (hides memory latency) */
     uint32_t hash_idx = fj64_hash(n);
     __builtin_prefetch(&fj64_bases[hash_idx], 0, 3);
 
-    /* Pre-compute Montgomery constants once for both witness tests */
+    if (n >= MONTGOMERY_SAFE_THRESHOLD) {
+        if (!mr_witness_std(n, 2))
+            return false;
+        return mr_witness_std(n, fj64_bases[hash_idx]);
+    }
+
+    /* Montgomery constants, computed once for both witness tests */
     uint64_t n_inv = montgomery_inverse(n);
-    uint64_t r_sq = montgomery_r_squared(n);
+    uint64_t one_m = montgomery_one(n);
 
-    if (!mr_witness_montgomery_cached(n, 2, n_inv, r_sq))
+    if (!mr_witness_montgomery_base2(n, n_inv, one_m))
         return false;
-    return mr_witness_montgomery_cached(n, fj64_bases[hash_idx], n_inv, r_sq);
+
+    uint64_t a = fj64_bases[hash_idx];
+    if (a >= n) a %= n;             /* Only for n < 2^16 */
+    if (a == 0) return true;
+    uint64_t r_sq = montgomery_r_squared_fast(n, n_inv, one_m);
+    return mr_witness_montgomery_form(n, montgomery_mul(a, r_sq, n, n_inv), n_inv, one_m);
 }
 
 /**
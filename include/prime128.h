@@ -0,0 +1,192 @@
+/*
+ * 128-bit Primality Testing (BPSW)
+ *
+ * Past n = 2^61, N = 8n + 3 needs 128 bits. Walk candidates p stay below
+ * 2^63 for all but the far end of the walk, where they can pass 2^64 and
+ * FJ64_262K no longer applies. For those rare candidates this header
+ * provides the Baillie-PSW test: a strong probable prime test to base 2
+ * followed by a strong Lucas probable prime test with Selfridge's
+ * parameters (method A). No BPSW pseudoprime is known; below 2^64 none
+ * exists, and is_prime_128() uses the exact FJ64 test there anyway.
+ *
+ * Modular multiplication of 128-bit residues uses double-and-add, which
+ * is slow (~128 additions) but only runs for candidates >= 2^64.
+ */
+
+#ifndef PRIME128_H
+#define PRIME128_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith.h"
+#include "prime.h"
+
+/* ========================================================================== */
+/* 128-bit Modular Arithmetic                                                 */
+/* ========================================================================== */
+
+/* (a + b) mod m for a, b < m; the sum may wrap past 2^128 */
+static inline __uint128_t addmod128(__uint128_t a, __uint128_t b, __uint128_t m) {
+    __uint128_t r = a + b;
+    if (r < a || r >= m) r -= m;
+    return r;
+}
+
+/* (a - b) mod m for a, b < m */
+static inline __uint128_t submod128(__uint128_t a, __uint128_t b, __uint128_t m) {
+    return a >= b ? a - b : a + (m - b);
+}
+
+/* a / 2 mod m for a < m, m odd */
+static inline __uint128_t halfmod128(__uint128_t a, __uint128_t m) {
+    return (a & 1) ? (a >> 1) + (m >> 1) + 1 : a >> 1;
+}
+
+static inline __uint128_t mulmod128(__uint128_t a, __uint128_t b, __uint128_t m) {
+    if ((a >> 64) == 0 && (b >> 64) == 0) {
+        return ((__uint128_t)(uint64_t)a * (uint64_t)b) % m;
+    }
+    __uint128_t r = 0;
+    while (b > 0) {
+        if (b & 1) r = addmod128(r, a, m);
+        a = addmod128(a, a, m);
+        b >>= 1;
+    }
+    return r;
+}
+
+/* ========================================================================== */
+/* BPSW Components                                                            */
+/* ========================================================================== */
+
+/**
+ * Strong probable prime test to base 2 (n odd, n > 2)
+ */
+static inline bool is_sprp2_128(__uint128_t n) {
+    __uint128_t d = n - 1;
+    int r = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        r++;
+    }
+
+    __uint128_t x = 1, base = 2;
+    while (d > 0) {
+        if (d & 1) x = mulmod128(x, base, n);
+        base = mulmod128(base, base, n);
+        d >>= 1;
+    }
+
+    if (x == 1 || x == n - 1) return true;
+    for (int i = 1; i < r; i++) {
+        x = mulmod128(x, x, n);
+        if (x == n - 1) return true;
+        if (x == 1) return false;
+    }
+    return false;
+}
+
+/**
+ * Jacobi symbol (a/n) for odd n
+ */
+static inline int jacobi128(__uint128_t a, __uint128_t n) {
+    int result = 1;
+    a %= n;
+    while (a != 0) {
+        while ((a & 1) == 0) {
+            a >>= 1;
+            unsigned r = (unsigned)(n & 7);
+            if (r == 3 || r == 5) result = -result;
+        }
+        __uint128_t t = a;
+        a = n;
+        n = t;
+        if ((a & 3) == 3 && (n & 3) == 3) result = -result;
+        a %= n;
+    }
+    return n == 1 ? result : 0;
+}
+
+/**
+ * Strong Lucas probable prime test, Selfridge method A
+ * (n odd, n > 2, not a perfect square; D = 5, -7, 9, -11, ... with
+ * (D/n) = -1, P = 1, Q = (1 - D)/4)
+ */
+static inline bool is_slprp_128(__uint128_t n) {
+    int64_t D = 5;
+    while (1) {
+        __uint128_t d_abs = (__uint128_t)(D < 0 ? -D : D);
+        int j = jacobi128(d_abs, n);
+        if (D < 0 && (n & 3) == 3) j = -j;     /* (-1/n) = -1 for n = 3 mod 4 */
+        if (j == -1) break;
+        if (j == 0 && d_abs % n != 0) return false;  /* Shares a factor with n */
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+
+    /* D and Q as residues mod n */
+    __uint128_t D_m = D > 0 ? (__uint128_t)D % n : n - (__uint128_t)(-D) % n;
+    int64_t Q = (1 - D) / 4;
+    __uint128_t Q_m = Q >= 0 ? (__uint128_t)Q % n : n - (__uint128_t)(-Q) % n;
+
+    /* n + 1 = d * 2^s */
+    __uint128_t d = n + 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    /* U_d, V_d and Q^d by binary expansion of d (P = 1), from U_1 = V_1 = 1 */
+    int top = 127;
+    while (((d >> top) & 1) == 0) top--;
+    __uint128_t U = 1, V = 1, Qk = Q_m;
+    for (int b = top - 1; b >= 0; b--) {
+        /* k -> 2k */
+        U = mulmod128(U, V, n);
+        V = submod128(mulmod128(V, V, n), addmod128(Qk, Qk, n), n);
+        Qk = mulmod128(Qk, Qk, n);
+        if ((d >> b) & 1) {
+            /* k -> k + 1 */
+            __uint128_t U_next = halfmod128(addmod128(U, V, n), n);
+            V = halfmod128(addmod128(mulmod128(D_m, U, n), V, n), n);
+            U = U_next;
+            Qk = mulmod128(Qk, Q_m, n);
+        }
+    }
+
+    if (U == 0 || V == 0) return true;
+    for (int r = 1; r < s; r++) {
+        V = submod128(mulmod128(V, V, n), addmod128(Qk, Qk, n), n);
+        if (V == 0) return true;
+        Qk = mulmod128(Qk, Qk, n);
+    }
+    return false;
+}
+
+/**
+ * BPSW without small-n shortcuts (n odd, n > 127, no factor <= 127)
+ */
+static inline bool is_prime_bpsw128(__uint128_t n) {
+    if (!is_sprp2_128(n)) return false;
+    uint64_t root = isqrt128(n);
+    if ((__uint128_t)root * root == n) return false;
+    return is_slprp_128(n);
+}
+
+/* ========================================================================== */
+/* Entry Point                                                                */
+/* ========================================================================== */
+
+/**
+ * Primality test for any 128-bit n: exact FJ64_262K below 2^64, BPSW above
+ */
+static inline bool is_prime_128(__uint128_t n) {
+    if ((n >> 64) == 0) return is_prime_64((uint64_t)n);
+    if ((n & 1) == 0) return false;
+    for (int i = 0; i < NUM_TRIAL_PRIMES; i++) {
+        if (n % TRIAL_PRIMES[i] == 0) return false;
+    }
+    return is_prime_bpsw128(n);
+}
+
+#endif /* PRIME128_H */
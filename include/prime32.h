@@ -0,0 +1,60 @@
+/*
+ * 32-bit Primality Testing: FJ32-Style Single Witness
+ *
+ * Below 2^32 the search does not need FJ64_262K's two 64-bit Miller-Rabin
+ * tests. A hash of n selects one base from a 4096-entry table (8KB, stays
+ * in L1) and a single 32-bit Montgomery Miller-Rabin test decides.
+ *
+ * The table is generated by analysis/gen_fj32_table.c, which checks every
+ * odd composite n < 2^32 with no prime factor <= 127 against the base of its
+ * bucket. The single-witness test is therefore deterministic for exactly
+ * the inputs the search gives it: odd n > 127 that passed trial division.
+ * is_prime_32() adds the trial division and small cases for standalone use.
+ */
+
+#ifndef PRIME32_H
+#define PRIME32_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith_montgomery.h"
+#include "prime.h"
+
+#define FJ32_BUCKETS 4096
+
+/**
+ * FJ32 hash function - maps n to a bucket in [0, 4095]
+ */
+static inline uint32_t fj32_hash(uint32_t x) {
+    x = ((x >> 16) ^ x) * 0x45d9f3bU;
+    x = ((x >> 16) ^ x) * 0x45d9f3bU;
+    x = ((x >> 16) ^ x);
+    return x & (FJ32_BUCKETS - 1);
+}
+
+#ifndef FJ32_GENERATOR
+#include "fj32_table.h"
+
+/**
+ * Single-witness primality test for 32-bit candidates
+ * Assumes: 127 < n < 2^32, n is odd, n passed trial division
+ */
+static inline bool is_prime_fj32_fast(uint32_t n) {
+    return mr_witness_montgomery32(n, fj32_bases[fj32_hash(n)]);
+}
+
+/**
+ * Full primality test for standalone use (any n < 2^32)
+ */
+static inline bool is_prime_32(uint32_t n) {
+    if (n < 2) return false;
+    if ((n & 1) == 0) return n == 2;
+    for (int i = 0; i < NUM_TRIAL_PRIMES; i++) {
+        if (n % TRIAL_PRIMES[i] == 0) return n == TRIAL_PRIMES[i];
+    }
+    if (n < 131) return true;
+    return is_prime_fj32_fast(n);
+}
+#endif /* FJ32_GENERATOR */
+
+#endif /* PRIME32_H */
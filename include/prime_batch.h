@@ -0,0 +1,209 @@
+/*
+ * Lane-Parallel Miller-Rabin for Several Candidates at Once
+ *
+ * A single FJ64 test is two long dependent chains of montgomery_mul(): each
+ * multiply waits for the previous one, so the core's multiplier sits idle
+ * for most of its latency. Testing several unrelated candidates together
+ * and interleaving their exponentiations (one step of every lane per loop
+ * iteration) gives the out-of-order core independent work to overlap.
+ *
+ * The exponentiation is branchless across lanes: every lane runs for the
+ * bit length of the longest exponent, lanes whose exponent is exhausted
+ * keep x_m unchanged through the conditional select.
+ *
+ * The base-2 pass (mr_witness_batch_base2) runs left to right with the
+ * doubling folded into each squaring, as mr_witness_montgomery_base2: one
+ * Montgomery multiply per bit and lane instead of two. Leading zero bits
+ * of a shorter exponent square one_m, which leaves it unchanged.
+ *
+ * Candidates >= 2^63 (outside the Montgomery-safe range) are tested with
+ * the scalar path. On CPUs with AVX-512 IFMA, candidates below 2^52 are
+ * tested eight at a time by the vector kernel in prime_ifma.h instead.
+ */
+
+#ifndef PRIME_BATCH_H
+#define PRIME_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith_montgomery.h"
+#include "prime.h"
+#include "prime_ifma.h"
+
+/* Maximum number of candidates tested together */
+#define MR_BATCH_MAX 16
+
+/**
+ * Miller-Rabin witness test for count candidates at once (count <= MR_BATCH_MAX).
+ * Requires n[i] odd and < 2^63. pass[i] = n[i] is a strong probable prime to a[i].
+ */
+static inline void mr_witness_batch(const uint64_t *n, const uint64_t *n_inv,
+                                    const uint64_t *r_sq, const uint64_t *a,
+                                    int count, bool *pass) {
+    uint64_t one_m[MR_BATCH_MAX], neg_one_m[MR_BATCH_MAX];
+    uint64_t x_m[MR_BATCH_MAX], base_m[MR_BATCH_MAX], d[MR_BATCH_MAX];
+    int r[MR_BATCH_MAX];
+    bool trivial[MR_BATCH_MAX];
+    int max_bits = 0;
+
+    /* Per-lane setup: d, r and Montgomery forms of 1, -1 and the base */
+    for (int i = 0; i < count; i++) {
+        uint64_t base = (a[i] >= n[i]) ? a[i] % n[i] : a[i];
+        trivial[i] = (base == 0);
+
+        d[i] = n[i] - 1;
+        r[i] = __builtin_ctzll(d[i]);
+        d[i] >>= r[i];
+
+        one_m[i] = montgomery_reduce(r_sq[i], n[i], n_inv[i]);
+        neg_one_m[i] = n[i] - one_m[i];
+        base_m[i] = montgomery_reduce((__uint128_t)base * r_sq[i], n[i], n_inv[i]);
+        x_m[i] = one_m[i];
+
+        int bits = 64 - __builtin_clzll(d[i]);
+        if (bits > max_bits) max_bits = bits;
+    }
+
+    /* Interleaved right-to-left exponentiation: one step of every lane per bit */
+    for (int b = 0; b < max_bits; b++) {
+        for (int i = 0; i < count; i++) {
+            uint64_t temp = montgomery_mul(x_m[i], base_m[i], n[i], n_inv[i]);
+            x_m[i] = ((d[i] >> b) & 1) ? temp : x_m[i];
+            base_m[i] = montgomery_mul(base_m[i], base_m[i], n[i], n_inv[i]);
+        }
+    }
+
+    /* Squaring phase is short and data-dependent: finish each lane alone */
+    for (int i = 0; i < count; i++) {
+        if (trivial[i] || x_m[i] == one_m[i] || x_m[i] == neg_one_m[i]) {
+            pass[i] = true;
+            continue;
+        }
+        bool ok = false;
+        uint64_t x = x_m[i];
+        for (int k = 1; k < r[i]; k++) {
+            x = montgomery_mul(x, x, n[i], n_inv[i]);
+            if (x == neg_one_m[i]) { ok = true; break; }
+            if (x == one_m[i]) break;
+        }
+        pass[i] = ok;
+    }
+}
+
+/**
+ * Miller-Rabin witness test to base 2 for count candidates at once
+ * (count <= MR_BATCH_MAX), from one_m[i] = r mod n[i] alone.
+ * Requires n[i] odd and < 2^63. pass[i] = n[i] is a strong probable prime to 2.
+ */
+static inline void mr_witness_batch_base2(const uint64_t *n, const uint64_t *n_inv,
+                                          const uint64_t *one_m, int count, bool *pass) {
+    uint64_t x_m[MR_BATCH_MAX], d[MR_BATCH_MAX];
+    int r[MR_BATCH_MAX];
+    int max_bits = 0;
+
+    for (int i = 0; i < count; i++) {
+        d[i] = n[i] - 1;
+        r[i] = __builtin_ctzll(d[i]);
+        d[i] >>= r[i];
+        x_m[i] = one_m[i];
+
+        int bits = 64 - __builtin_clzll(d[i]);
+        if (bits > max_bits) max_bits = bits;
+    }
+
+    /* Interleaved left-to-right exponentiation: x = x^2, or 2 x^2 for a set bit */
+    for (int b = max_bits - 1; b >= 0; b--) {
+        for (int i = 0; i < count; i++) {
+            __uint128_t sq = (__uint128_t)x_m[i] * x_m[i];
+            x_m[i] = montgomery_reduce(sq << ((d[i] >> b) & 1), n[i], n_inv[i]);
+        }
+    }
+
+    /* Squaring phase, each lane alone */
+    for (int i = 0; i < count; i++) {
+        uint64_t neg_one_m = n[i] - one_m[i];
+        uint64_t x = x_m[i];
+        bool ok = (x == one_m[i] || x == neg_one_m);
+        for (int k = 1; !ok && k < r[i]; k++) {
+            x = montgomery_mul(x, x, n[i], n_inv[i]);
+            if (x == neg_one_m) ok = true;
+            else if (x == one_m[i]) break;
+        }
+        pass[i] = ok;
+    }
+}
+
+/**
+ * FJ64_262K primality test for count candidates at once (count <= MR_BATCH_MAX).
+ * Assumes each n[i] > 127, odd, and passed trial division (as is_prime_fj64_fast).
+ * is_prime[i] receives the result for n[i].
+ */
+static inline void is_prime_fj64_batch(const uint64_t *n, int count, bool *is_prime) {
+    uint64_t ln[MR_BATCH_MAX], n_inv[MR_BATCH_MAX], one_m[MR_BATCH_MAX], r_sq[MR_BATCH_MAX];
+    uint64_t base[MR_BATCH_MAX];
+    int lane_of[MR_BATCH_MAX];
+    bool pass[MR_BATCH_MAX];
+    int m = 0;
+
+    /* IFMA: candidates below 2^52 in groups of 8 (short groups padded) */
+    bool use_ifma = prime_ifma_available();
+    if (use_ifma) {
+        uint64_t group[IFMA_LANES];
+        int group_lane[IFMA_LANES];
+        int g = 0;
+        for (int i = 0; i <= count; i++) {
+            if (i < count && n[i] < IFMA_LIMIT) {
+                group[g] = n[i];
+                group_lane[g] = i;
+                g++;
+            }
+            if (g == IFMA_LANES || (i == count && g > 0)) {
+                for (int k = g; k < IFMA_LANES; k++) group[k] = group[0];
+                uint8_t mask = is_prime_fj64_x8(group);
+                for (int k = 0; k < g; k++) is_prime[group_lane[k]] = (mask >> k) & 1;
+                g = 0;
+            }
+        }
+    }
+
+    /* Montgomery-safe candidates go to the batch, the rest to the scalar path */
+    for (int i = 0; i < count; i++) {
+        if (use_ifma && n[i] < IFMA_LIMIT) continue;
+        if (n[i] < MONTGOMERY_SAFE_THRESHOLD) {
+            ln[m] = n[i];
+            lane_of[m] = i;
+            n_inv[m] = montgomery_inverse(n[i]);
+            one_m[m] = montgomery_one(n[i]);
+            m++;
+        } else {
+            is_prime[i] = is_prime_fj64_fast(n[i]);
+        }
+    }
+    if (m == 0) return;
+
+    /* First witness: base 2 for every lane */
+    mr_witness_batch_base2(ln, n_inv, one_m, m, pass);
+
+    /* Compact the survivors and run the hash-selected second witness */
+    int s = 0;
+    for (int j = 0; j < m; j++) {
+        if (!pass[j]) {
+            is_prime[lane_of[j]] = false;
+            continue;
+        }
+        ln[s] = ln[j];
+        n_inv[s] = n_inv[j];
+        r_sq[s] = montgomery_r_squared_fast(ln[j], n_inv[j], one_m[j]);
+        lane_of[s] = lane_of[j];
+        base[s] = fj64_bases[fj64_hash(ln[j])];
+        s++;
+    }
+    if (s == 0) return;
+
+    mr_witness_batch(ln, n_inv, r_sq, base, s, pass);
+    for (int j = 0; j < s; j++) {
+        is_prime[lane_of[j]] = pass[j];
+    }
+}
+
+#endif /* PRIME_BATCH_H */
@@ -0,0 +1,240 @@
+/*
+ * AVX-512 IFMA Miller-Rabin: 8 Candidates Below 2^52 at Once
+ *
+ * vpmadd52luq / vpmadd52huq multiply the low 52 bits of each 64-bit lane
+ * and add the low / high 52 bits of the 104-bit product to an accumulator.
+ * With radix R = 2^52, a Montgomery multiplication of eight independent
+ * moduli n < 2^52 costs five IFMA instructions plus a conditional subtract:
+ *
+ *   lo = lo52(a*b)          hi = hi52(a*b)
+ *   m  = lo52(lo * n')      (n' = -n^-1 mod 2^52)
+ *   c  = (lo + lo52(m*n)) >> 52        (carry: the sum is 0 or 2^52)
+ *   u  = hi + hi52(m*n) + c            (u < 2n)
+ *   u  = min(u, u - n)                 (unsigned: u - n wraps when u < n)
+ *
+ * For n <= ~10^15 every candidate p is below 2^52, so the whole FJ64_262K
+ * test (base 2, then the hash-selected base gathered from fj64_bases) runs
+ * eight lanes wide. R mod n and R^2 mod n come from vector doubling
+ * instead of eight scalar 128-bit divisions.
+ *
+ * The kernel is compiled with target attributes, so the rest of the
+ * program does not need -mavx512ifma. Callers check prime_ifma_available()
+ * at run time; is_prime_fj64_x8() does so itself and falls back to the
+ * scalar is_prime_fj64_fast() path when IFMA is missing.
+ */
+
+#ifndef PRIME_IFMA_H
+#define PRIME_IFMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith_montgomery.h"
+#include "prime.h"
+
+/* Candidates must be below this bound for the IFMA kernel */
+#define IFMA_LIMIT (1ULL << 52)
+
+#define IFMA_LANES 8
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PRIME_IFMA_SUPPORTED 1
+#include <immintrin.h>
+#else
+#define PRIME_IFMA_SUPPORTED 0
+#endif
+
+/* ========================================================================== */
+/* Runtime Detection                                                          */
+/* ========================================================================== */
+
+/**
+ * True if the CPU can run the IFMA kernel (AVX-512F + DQ + IFMA).
+ */
+static inline bool prime_ifma_available(void) {
+#if PRIME_IFMA_SUPPORTED
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx512f") &&
+                 __builtin_cpu_supports("avx512dq") &&
+                 __builtin_cpu_supports("avx512ifma");
+    }
+    return cached != 0;
+#else
+    return false;
+#endif
+}
+
+#if PRIME_IFMA_SUPPORTED
+
+#define IFMA_TARGET __attribute__((target("avx512f,avx512dq,avx512ifma")))
+
+/* ========================================================================== */
+/* Vector Montgomery Arithmetic (R = 2^52)                                    */
+/* ========================================================================== */
+
+IFMA_TARGET
+static inline __m512i ifma_montmul(__m512i a, __m512i b, __m512i n, __m512i n_inv) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i lo = _mm512_madd52lo_epu64(zero, a, b);
+    __m512i hi = _mm512_madd52hi_epu64(zero, a, b);
+    __m512i m = _mm512_madd52lo_epu64(zero, lo, n_inv);
+    __m512i carry = _mm512_srli_epi64(_mm512_madd52lo_epu64(lo, m, n), 52);
+    __m512i u = _mm512_add_epi64(_mm512_madd52hi_epu64(hi, m, n), carry);
+    return _mm512_min_epu64(u, _mm512_sub_epi64(u, n));
+}
+
+/* x = 2x mod n (x < n) */
+IFMA_TARGET
+static inline __m512i ifma_double(__m512i x, __m512i n) {
+    x = _mm512_add_epi64(x, x);
+    return _mm512_min_epu64(x, _mm512_sub_epi64(x, n));
+}
+
+/**
+ * Miller-Rabin to base_m (already in Montgomery form) for all 8 lanes.
+ * Returns the mask of lanes that are strong probable primes.
+ */
+IFMA_TARGET
+static inline __mmask8 ifma_mr_witness(__m512i n, __m512i n_inv, __m512i one_m,
+                                       __m512i base_m, __m512i d, __m512i r,
+                                       int max_bits, int max_r) {
+    const __m512i one = _mm512_set1_epi64(1);
+    __m512i neg_one_m = _mm512_sub_epi64(n, one_m);
+    __m512i x_m = one_m;
+
+    /* Right-to-left exponentiation, lanes masked by their exponent bits */
+    for (int b = 0; b < max_bits; b++) {
+        __mmask8 bit = _mm512_test_epi64_mask(d, one);
+        x_m = _mm512_mask_mov_epi64(x_m, bit, ifma_montmul(x_m, base_m, n, n_inv));
+        base_m = ifma_montmul(base_m, base_m, n, n_inv);
+        d = _mm512_srli_epi64(d, 1);
+    }
+
+    __mmask8 pass = _mm512_cmpeq_epi64_mask(x_m, one_m) |
+                    _mm512_cmpeq_epi64_mask(x_m, neg_one_m);
+    __mmask8 done = pass;
+
+    /* Squaring phase: lane i squares up to r[i] - 1 times */
+    for (int k = 1; k < max_r; k++) {
+        __mmask8 live = (__mmask8)~done &
+                        _mm512_cmpgt_epu64_mask(r, _mm512_set1_epi64(k));
+        if (live == 0) break;
+        x_m = ifma_montmul(x_m, x_m, n, n_inv);
+        __mmask8 hit = _mm512_mask_cmpeq_epi64_mask(live, x_m, neg_one_m);
+        pass |= hit;
+        done |= hit | _mm512_mask_cmpeq_epi64_mask(live, x_m, one_m);
+    }
+    return pass;
+}
+
+/**
+ * fj64_hash() for 8 lanes plus the gather of the 16-bit witness bases.
+ * The table is read with 32-bit gathers at 4-byte aligned offsets (never
+ * past its end) and the wanted half selected by shifting.
+ */
+IFMA_TARGET
+static inline __m512i ifma_fj64_bases(__m512i x) {
+    const __m512i c1 = _mm512_set1_epi64(0x45d9f3b3335b369ULL);
+    const __m512i c2 = _mm512_set1_epi64(0x3335b36945d9f3bULL);
+    x = _mm512_mullo_epi64(_mm512_xor_si512(_mm512_srli_epi64(x, 32), x), c1);
+    x = _mm512_mullo_epi64(_mm512_xor_si512(_mm512_srli_epi64(x, 32), x), c2);
+    x = _mm512_xor_si512(_mm512_srli_epi64(x, 32), x);
+    __m512i idx = _mm512_and_si512(x, _mm512_set1_epi64(262143));
+
+    __m512i byte_off = _mm512_slli_epi64(idx, 1);
+    __m512i word_off = _mm512_andnot_si512(_mm512_set1_epi64(3), byte_off);
+    __m256i words = _mm512_i64gather_epi32(word_off, (const void*)fj64_bases, 1);
+
+    __m512i w = _mm512_cvtepu32_epi64(words);
+    __m512i shift = _mm512_slli_epi64(_mm512_and_si512(idx, _mm512_set1_epi64(1)), 4);
+    return _mm512_and_si512(_mm512_srlv_epi64(w, shift), _mm512_set1_epi64(0xFFFF));
+}
+
+/**
+ * FJ64_262K for 8 odd candidates 127 < n[i] < 2^52.
+ * Returns a bitmask: bit i set = n[i] is prime.
+ */
+IFMA_TARGET
+static inline uint8_t is_prime_fj64_ifma8_kernel(const uint64_t *cand) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i mask52 = _mm512_set1_epi64((long long)(IFMA_LIMIT - 1));
+    __m512i n = _mm512_loadu_si512((const void*)cand);
+
+    /* n' = -n^-1 mod 2^52 (Newton iteration, 5 steps to 64 bits) */
+    __m512i inv = n;
+    for (int i = 0; i < 5; i++) {
+        __m512i t = _mm512_sub_epi64(_mm512_set1_epi64(2), _mm512_mullo_epi64(n, inv));
+        inv = _mm512_mullo_epi64(inv, t);
+    }
+    __m512i n_inv = _mm512_and_si512(_mm512_sub_epi64(_mm512_setzero_si512(), inv), mask52);
+
+    /* R mod n and R^2 mod n by doubling 1 (52 and 104 times) */
+    __m512i one_m = one;
+    for (int i = 0; i < 52; i++) one_m = ifma_double(one_m, n);
+    __m512i r_sq = one_m;
+    for (int i = 0; i < 52; i++) r_sq = ifma_double(r_sq, n);
+
+    /* n - 1 = d * 2^r */
+    __m512i nm1 = _mm512_sub_epi64(n, one);
+    uint64_t d_s[IFMA_LANES], r_s[IFMA_LANES];
+    _mm512_storeu_si512((void*)d_s, nm1);
+    int max_bits = 0, max_r = 0;
+    for (int i = 0; i < IFMA_LANES; i++) {
+        int tz = __builtin_ctzll(d_s[i]);
+        r_s[i] = (uint64_t)tz;
+        d_s[i] >>= tz;
+        int bits = 64 - __builtin_clzll(d_s[i]);
+        if (bits > max_bits) max_bits = bits;
+        if (tz > max_r) max_r = tz;
+    }
+    __m512i d = _mm512_loadu_si512((const void*)d_s);
+    __m512i r = _mm512_loadu_si512((const void*)r_s);
+
+    /* Witness 1: base 2, whose Montgomery form is 2R mod n */
+    __mmask8 pass = ifma_mr_witness(n, n_inv, one_m, ifma_double(one_m, n),
+                                    d, r, max_bits, max_r);
+    if (pass == 0) return 0;
+
+    /* Witness 2: hash-selected base, reduced mod n where base >= n */
+    __m512i base = ifma_fj64_bases(n);
+    __mmask8 big = _mm512_cmpge_epu64_mask(base, n);
+    __mmask8 trivial = 0;
+    if (big) {
+        uint64_t b_s[IFMA_LANES];
+        _mm512_storeu_si512((void*)b_s, base);
+        for (int i = 0; i < IFMA_LANES; i++) {
+            if (big & (1u << i)) b_s[i] %= cand[i];
+            if (b_s[i] == 0) trivial |= (__mmask8)(1u << i);
+        }
+        base = _mm512_loadu_si512((const void*)b_s);
+    }
+    __m512i base_m = ifma_montmul(base, r_sq, n, n_inv);
+
+    __mmask8 pass2 = ifma_mr_witness(n, n_inv, one_m, base_m, d, r, max_bits, max_r);
+    return (uint8_t)(pass & (pass2 | trivial));
+}
+
+#endif /* PRIME_IFMA_SUPPORTED */
+
+/* ========================================================================== */
+/* Dispatching Entry Point                                                    */
+/* ========================================================================== */
+
+/**
+ * FJ64_262K for 8 odd candidates 127 < n[i] < 2^52 (as is_prime_fj64_fast).
+ * Uses the IFMA kernel when the CPU supports it, the scalar path otherwise.
+ * Returns a bitmask: bit i set = n[i] is prime.
+ */
+static inline uint8_t is_prime_fj64_x8(const uint64_t *n) {
+#if PRIME_IFMA_SUPPORTED
+    if (prime_ifma_available()) return is_prime_fj64_ifma8_kernel(n);
+#endif
+    uint8_t mask = 0;
+    for (int i = 0; i < IFMA_LANES; i++) {
+        if (is_prime_fj64_fast(n[i])) mask |= (uint8_t)(1u << i);
+    }
+    return mask;
+}
+
+#endif /* PRIME_IFMA_H */
@@ -1,18 +1,31 @@
 /*
  * Miller-Rabin with Interleaved FP Trial Division
  *
- * Performs trial division using floating-point reciprocals during the
- * MR exponentiation loop. FP operations run in parallel with integer
- * operations on modern CPUs (separate execution units).
+ * Trial division by the primes 131-467 on the floating-point units, run
+ * during the base-2 Montgomery exponentiation: one vector of four primes
+ * per exponent bit, so all 60 primes are done within the first 16 bits.
+ * The exponentiation is one dependent chain of integer multiplies, which
+ * leaves the FP ports idle; the divisibility tests fill them, and a
+ * candidate with a factor in range (about 21% of the survivors of trial
+ * division by 3-127) leaves the loop early instead of finishing base 2.
  *
- * Benefits:
- * - ~4% speedup for TD-resistant candidates
- * - ~30% of composites caught by extended TD (primes 131-467)
- * - FP operations have near-zero overhead due to parallelism
+ * The test is exact: for n < 2^52, q = round(n / p) comes from one multiply
+ * by the rounded reciprocal and the 1.5 * 2^52 rounding trick (the product
+ * is within 1/128 of n / p, so a multiple of p rounds to its quotient), and
+ * q p and n - q p are integers below 2^53, so p | n exactly when
+ * n - q p == 0. No fudge factor, and no fma or rint, so GCC's vector
+ * extensions lower it to SSE2 or AVX alike (not under -ffast-math, which
+ * would fold the rounding trick away).
+ *
+ * Used by ./search --interleaved-td for candidates 2^32 <= p < 2^52 (below
+ * 2^32 the FJ32 test is used): 1-7% less time per test on trial-division
+ * survivors from 34 to 52 bits on an AVX-512 server core, but neutral end
+ * to end (Miller-Rabin is only part of the walk), so it is off by default.
+ * solve.h uses it when compiled with SOLVE_INTERLEAVED_TD.
  *
  * Requirements:
- * - Candidates must have already passed basic TD (primes 3-127)
- * - Candidates must be < 2^49 for FP precision (we use up to ~10^13)
+ * - Candidates must have passed trial division by 3-127 and be odd, > 127
+ * - Candidates must be < INTERLEAVED_LIMIT (2^52) for exact FP arithmetic
  */
 
 #ifndef PRIME_INTERLEAVED_H
@@ -20,214 +33,135 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <math.h>
 #include "prime.h"  /* For fj64_hash, fj64_bases, and Montgomery functions */
 
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+/* Candidates below this are tested exactly (and below the lazy kernel limits) */
+#define INTERLEAVED_LIMIT (1ULL << 52)
+
+#define INTERLEAVED_LANES 4
+#define INTERLEAVED_BLOCKS 16          /* 60 primes, padded to 64 with 467 */
+
+typedef double interleaved_vd __attribute__((vector_size(INTERLEAVED_LANES * sizeof(double))));
+typedef int64_t interleaved_vi __attribute__((vector_size(INTERLEAVED_LANES * sizeof(int64_t))));
+
 /* Extended primes for interleaved TD (after basic TD with 3-127) */
-static const uint64_t INTERLEAVED_PRIMES[] = {
-    131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199,
-    211, 223, 227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283,
-    293, 307, 311, 313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383,
-    389, 397, 401, 409, 419, 421, 431, 433, 439, 443, 449, 457, 461, 463, 467
+static const interleaved_vd INTERLEAVED_PRIMES[INTERLEAVED_BLOCKS] = {
+    {131, 137, 139, 149}, {151, 157, 163, 167}, {173, 179, 181, 191}, {193, 197, 199, 211},
+    {223, 227, 229, 233}, {239, 241, 251, 257}, {263, 269, 271, 277}, {281, 283, 293, 307},
+    {311, 313, 317, 331}, {337, 347, 349, 353}, {359, 367, 373, 379}, {383, 389, 397, 401},
+    {409, 419, 421, 431}, {433, 439, 443, 449}, {457, 461, 463, 467}, {467, 467, 467, 467}
 };
-#define NUM_INTERLEAVED_PRIMES 60
-
-/* Pre-computed reciprocals with fudge factor for rounding */
-static const double INTERLEAVED_RECIPROCALS[] = {
-    0x1.f44659e4a44b1p-8,  /* 1/131 */
-    0x1.de5d6e3f888cap-8,  /* 1/137 */
-    0x1.d77b654b82e74p-8,  /* 1/139 */
-    0x1.b7d6c3dda35cbp-8,  /* 1/149 */
-    0x1.b2036406c8319p-8,  /* 1/151 */
-    0x1.a16d3f97a4d42p-8,  /* 1/157 */
-    0x1.920fb49d0e469p-8,  /* 1/163 */
-    0x1.886e5f0abb28ap-8,  /* 1/167 */
-    0x1.7ad2208e0ef03p-8,  /* 1/173 */
-    0x1.6e1f76b433a07p-8,  /* 1/179 */
-    0x1.6a13cd15374dp-8,   /* 1/181 */
-    0x1.571ed3c506d7ap-8,  /* 1/191 */
-    0x1.5390948f4122bp-8,  /* 1/193 */
-    0x1.4cab88725b1aep-8,  /* 1/197 */
-    0x1.49539e3b2d2a7p-8,  /* 1/199 */
-    0x1.3698df3de0988p-8,  /* 1/211 */
-    0x1.25e2270809531p-8,  /* 1/223 */
-    0x1.20b470c67c319p-8,  /* 1/227 */
-    0x1.1e2ef3b3fbab4p-8,  /* 1/229 */
-    0x1.19453808ca4dcp-8,  /* 1/233 */
-    0x1.12358e75d3273p-8,  /* 1/239 */
-    0x1.0fef010fef251p-8,  /* 1/241 */
-    0x1.05197f7d73644p-8,  /* 1/251 */
-    0x1.fe01fe01fe4a1p-9,  /* 1/257 */
-    0x1.f25f644230f36p-9,  /* 1/263 */
-    0x1.e741aa5975565p-9,  /* 1/269 */
-    0x1.e3a9179dc1ef4p-9,  /* 1/271 */
-    0x1.d92f2231e840bp-9,  /* 1/277 */
-    0x1.d272ca3fc5f9bp-9,  /* 1/281 */
-    0x1.cf26e5c44c447p-9,  /* 1/283 */
-    0x1.bf583ee86920cp-9,  /* 1/293 */
-    0x1.aaf1d2f87f07ep-9,  /* 1/307 */
-    0x1.a574107688ecbp-9,  /* 1/311 */
-    0x1.a2c2a87c52121p-9,  /* 1/313 */
-    0x1.9d79f176b6caep-9,  /* 1/317 */
-    0x1.8bfce806303bbp-9,  /* 1/331 */
-    0x1.84f00c2780a95p-9,  /* 1/337 */
-    0x1.79baa6bb63e0cp-9,  /* 1/347 */
-    0x1.77908119aca8ep-9,  /* 1/349 */
-    0x1.734f0c542030ep-9,  /* 1/353 */
-    0x1.6d1a62681cce2p-9,  /* 1/359 */
-    0x1.6524f853b4f24p-9,  /* 1/367 */
-    0x1.5f6643429327dp-9,  /* 1/373 */
-    0x1.59d61f123d12bp-9,  /* 1/379 */
-    0x1.56397ba7c5763p-9,  /* 1/383 */
-    0x1.50f22e111c946p-9,  /* 1/389 */
-    0x1.4a27fad7605cbp-9,  /* 1/397 */
-    0x1.46dce345964e7p-9,  /* 1/401 */
-    0x1.40782d10e69e7p-9,  /* 1/409 */
-    0x1.38d22d3660d0fp-9,  /* 1/419 */
-    0x1.3755bd1c94a6fp-9,  /* 1/421 */
-    0x1.301c82ac406e1p-9,  /* 1/431 */
-    0x1.2eb4ea1fed5ccp-9,  /* 1/433 */
-    0x1.2a91c92f3c586p-9,  /* 1/439 */
-    0x1.27dfa38a1d2cep-9,  /* 1/443 */
-    0x1.23eb7971764dcp-9,  /* 1/449 */
-    0x1.1ecf43c7fbccdp-9,  /* 1/457 */
-    0x1.1c522fc1ce4dap-9,  /* 1/461 */
-    0x1.1b17c67f2bf64p-9,  /* 1/463 */
-    0x1.18ab08390305cp-9,  /* 1/467 */
+
+#define INV4(a, b, c, d) {1.0 / (a), 1.0 / (b), 1.0 / (c), 1.0 / (d)}
+
+/* Reciprocals, correctly rounded */
+static const interleaved_vd INTERLEAVED_RECIPROCALS[INTERLEAVED_BLOCKS] = {
+    INV4(131, 137, 139, 149), INV4(151, 157, 163, 167), INV4(173, 179, 181, 191),
+    INV4(193, 197, 199, 211), INV4(223, 227, 229, 233), INV4(239, 241, 251, 257),
+    INV4(263, 269, 271, 277), INV4(281, 283, 293, 307), INV4(311, 313, 317, 331),
+    INV4(337, 347, 349, 353), INV4(359, 367, 373, 379), INV4(383, 389, 397, 401),
+    INV4(409, 419, 421, 431), INV4(433, 439, 443, 449), INV4(457, 461, 463, 467),
+    INV4(467, 467, 467, 467)
 };
 
+#undef INV4
+
 /**
- * Check divisibility using FP reciprocal multiplication
- * Returns true if n is divisible by the prime at idx
+ * Whether n (as a vector of INTERLEAVED_LANES copies, n < 2^52) is
+ * divisible by one of the four primes of block
  */
-static inline bool check_fp_divisible(double n_dbl, int idx) {
-    double product = n_dbl * INTERLEAVED_RECIPROCALS[idx];
-    double frac = product - floor(product);
-    return frac <= INTERLEAVED_RECIPROCALS[idx];
+static inline bool interleaved_divisible(interleaved_vd n_v, int block) {
+    const double round_magic = 0x1.8p52;
+    interleaved_vd q = (n_v * INTERLEAVED_RECIPROCALS[block] + round_magic) - round_magic;
+    interleaved_vi zero = (n_v - q * INTERLEAVED_PRIMES[block]) == 0.0;
+#ifdef __AVX__
+    /* One vmovmskpd, instead of four lane extracts on the integer ports */
+    return _mm256_movemask_pd((__m256d)zero) != 0;
+#else
+    int64_t any = 0;
+    for (int i = 0; i < INTERLEAVED_LANES; i++) any |= zero[i];
+    return any != 0;
+#endif
 }
 
 /**
- * Miller-Rabin witness test with interleaved FP trial division
- *
- * Performs TD checks using FP reciprocals during the exponentiation loop.
- * FP operations run in parallel with integer Montgomery operations.
+ * Miller-Rabin witness test to base 2 with interleaved FP trial division
+ * (467 < n < INTERLEAVED_LIMIT, odd, passed basic TD; one_m = r mod n)
  *
- * @param n         The candidate (must be odd, > 127, passed basic TD)
- * @param a         The witness base
- * @param n_inv     Pre-computed Montgomery inverse
- * @param r_sq      Pre-computed r^2 mod n
- * @param n_dbl     n as a double (for FP operations)
- * @param prime_idx Pointer to current prime index (updated on return)
- * @return          true if n passes this witness test, false if composite
+ * mr_witness_montgomery_base2() with one block of four primes tested per
+ * exponent bit, until all blocks are done. A block's result is only
+ * branched on after that bit's squaring is issued, so the FP work overlaps
+ * the multiply chain. Returns false for a factor found.
  */
-static inline bool mr_witness_interleaved(uint64_t n, uint64_t a,
-                                          uint64_t n_inv, uint64_t r_sq,
-                                          double n_dbl, int* prime_idx) {
-    if (a >= n) a %= n;
-    if (a == 0) return true;
-
+static inline bool mr_witness_base2_interleaved(uint64_t n, uint64_t n_inv, uint64_t one_m) {
+    const int kernel = MONTGOMERY_KERNEL;   /* n < 2^52: LAZY is exact */
     uint64_t d = n - 1;
     int r = __builtin_ctzll(d);
     d >>= r;
 
-    /* Montgomery form constants */
-    uint64_t one_m = montgomery_reduce(r_sq, n, n_inv);
     uint64_t neg_one_m = n - one_m;
-    uint64_t a_m = montgomery_reduce((__uint128_t)a * r_sq, n, n_inv);
-    uint64_t x_m = one_m;
-    uint64_t base_m = a_m;
-    uint64_t exp = d;
-
-    int idx = *prime_idx;
-
-    /* Exponentiation loop with interleaved FP TD */
-    while (exp > 0) {
-        /* Check FP result from previous iteration */
-        if (idx > 0 && idx <= NUM_INTERLEAVED_PRIMES) {
-            if (check_fp_divisible(n_dbl, idx - 1)) {
-                *prime_idx = idx;
-                return false;  /* Composite: factor found */
-            }
-        }
-
-        /* Montgomery exponentiation step */
-        uint64_t temp = montgomery_mul(x_m, base_m, n, n_inv);
-        x_m = (exp & 1) ? temp : x_m;
-        base_m = montgomery_mul(base_m, base_m, n, n_inv);
-        exp >>= 1;
-
-        /* Advance to next prime for parallel FP check */
-        if (idx < NUM_INTERLEAVED_PRIMES) {
-            idx++;
-        }
-    }
-
-    /* Final FP check */
-    if (idx > 0 && idx <= NUM_INTERLEAVED_PRIMES) {
-        if (check_fp_divisible(n_dbl, idx - 1)) {
-            *prime_idx = idx;
+    interleaved_vd n_v;
+    for (int i = 0; i < INTERLEAVED_LANES; i++) n_v[i] = (double)n;
+
+    /* Top bit of d: x = 2; then per bit x = x^2, or 2 x^2 if the bit is set */
+    uint64_t x_m = montgomery_double(one_m, n);
+    int bit = 62 - __builtin_clzll(d);
+    for (int block = 0; block < INTERLEAVED_BLOCKS && bit >= 0; block++, bit--) {
+        bool factor = interleaved_divisible(n_v, block);
+        x_m = montgomery_sqr_shift_k(x_m, (d >> bit) & 1, n, n_inv, kernel);
+        if (factor)
             return false;
-        }
     }
+    for (; bit >= 0; bit--)
+        x_m = montgomery_sqr_shift_k(x_m, (d >> bit) & 1, n, n_inv, kernel);
 
-    /* Standard MR check */
-    if (x_m == one_m || x_m == neg_one_m) {
-        *prime_idx = idx;
+    uint64_t x = montgomery_normalize_k(x_m, n, kernel);
+    if (x == one_m || x == neg_one_m)
         return true;
-    }
 
-    /* Squaring loop with continued FP TD */
     for (int i = 1; i < r; i++) {
-        if (idx < NUM_INTERLEAVED_PRIMES) {
-            if (check_fp_divisible(n_dbl, idx - 1)) {
-                *prime_idx = idx;
-                return false;
-            }
-            idx++;
-        }
-
-        x_m = montgomery_mul(x_m, x_m, n, n_inv);
-        if (x_m == neg_one_m) {
-            *prime_idx = idx;
+        x_m = montgomery_sqr_shift_k(x_m, 0, n, n_inv, kernel);
+        x = montgomery_normalize_k(x_m, n, kernel);
+        if (x == neg_one_m)
             return true;
-        }
-        if (x_m == one_m) {
-            *prime_idx = idx;
+        if (x == one_m)
             return false;
-        }
     }
-
-    *prime_idx = idx;
     return false;
 }
 
 /**
  * Deterministic primality test using FJ64 with interleaved TD
  *
- * Uses 2 MR witnesses (base 2 + hash-selected) with FP trial division
- * running in parallel during the exponentiation loops.
+ * is_prime_fj64_fast() with the base-2 witness replaced by
+ * mr_witness_base2_interleaved(). The hash-selected witness runs without
+ * trial division: nearly every candidate that reaches it is prime. n up
+ * to 467 (possibly one of the primes tested) goes to is_prime_fj64_fast().
  *
- * @param n  The candidate (must be odd, > 127, already passed basic TD)
+ * @param n  The candidate (odd, 127 < n < INTERLEAVED_LIMIT, passed basic TD)
  * @return   true if prime, false if composite
  */
 static inline bool is_prime_fj64_interleaved(uint64_t n) {
-    uint64_t n_inv = montgomery_inverse(n);
-    uint64_t r_sq = montgomery_r_squared(n);
-    double n_dbl = (double)n;
-    int prime_idx = 0;
+    if (n <= 467) return is_prime_fj64_fast(n);
 
-    /* First witness: base 2 */
-    if (!mr_witness_interleaved(n, 2, n_inv, r_sq, n_dbl, &prime_idx)) {
-        return false;
-    }
+    uint32_t hash_idx = fj64_hash(n);
+    __builtin_prefetch(&fj64_bases[hash_idx], 0, 3);
+
+    uint64_t n_inv = montgomery_inverse(n);
+    uint64_t one_m = montgomery_one(n);
 
-    /* Second witness: hash-selected from FJ64 table */
-    uint64_t witness2 = fj64_bases[fj64_hash(n)];
-    if (!mr_witness_interleaved(n, witness2, n_inv, r_sq, n_dbl, &prime_idx)) {
+    if (!mr_witness_base2_interleaved(n, n_inv, one_m))
         return false;
-    }
 
-    return true;
+    uint64_t a = fj64_bases[hash_idx];
+    if (a >= n) a %= n;             /* Only for n < 2^16 */
+    if (a == 0) return true;
+    uint64_t r_sq = montgomery_r_squared_fast(n, n_inv, one_m);
+    return mr_witness_montgomery_form(n, montgomery_mul(a, r_sq, n, n_inv), n_inv, one_m);
 }
 
 #endif /* PRIME_INTERLEAVED_H */
@@ -13,6 +13,8 @@
  *   bool sieve_is_prime(sieve, n)
  *   bool sieve_in_range(sieve, n)
  *   void sieve_destroy(sieve)
+ *
+ * sieve_file.h saves the bitmap to disk and maps it back read-only.
  */
 
 #ifndef PRIME_SIEVE_FAST_H
@@ -24,6 +26,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include "dispatch.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -60,6 +63,9 @@ typedef struct PrimeSieve {
     uint64_t threshold;     /* Maximum value in sieve */
     uint64_t num_bytes;     /* Number of bytes in bitmap */
     uint64_t prime_count;   /* Count of primes <= threshold (lazy computed) */
+    void *mapping;          /* File mapping owning bitmap (sieve_file.h), else NULL */
+    uint64_t mapping_bytes;
+    void (*release)(struct PrimeSieve *sieve);  /* Frees bitmap; NULL = free() */
 } PrimeSieve;
 
 /* ========================================================================== */
@@ -89,6 +95,43 @@ static inline void wheel30_clear_bit(uint8_t *bitmap, uint64_t bit_idx) {
 /* Sieve Creation (Parallelized)                                              */
 /* ========================================================================== */
 
+/**
+ * Clear the multiples of the sieving primes in bitmap bytes
+ * [byte_start, byte_end): one segment of sieve_create(). Dispatched per
+ * segment in portable builds (dispatch.h).
+ */
+DISPATCH_KERNEL
+static inline void sieve_segment(uint8_t *bitmap, uint64_t threshold,
+                                 const uint64_t *sieving_primes, uint64_t num_sieving_primes,
+                                 uint64_t byte_start, uint64_t byte_end) {
+    /* This segment covers numbers in range [n_start, n_end] */
+    uint64_t n_start = (byte_start / 1) * 30;  /* First block's base */
+    uint64_t n_end = ((byte_end * 8) / 8 + 1) * 30;
+    if (n_end > threshold) n_end = threshold;
+
+    /* Apply each sieving prime to this segment */
+    for (uint64_t i = 0; i < num_sieving_primes; i++) {
+        uint64_t p = sieving_primes[i];
+        if (p * p > n_end) break;
+
+        /* Find first multiple of p >= max(p*p, n_start) */
+        uint64_t start = p * p;
+        if (start < n_start) {
+            start = ((n_start + p - 1) / p) * p;
+        }
+
+        /* Sieve multiples of p in this segment */
+        for (uint64_t m = start; m <= n_end && m <= threshold; m += p) {
+            if (!wheel30_is_coprime(m)) continue;
+            uint64_t bit_idx = wheel30_bit_index(m);
+            uint64_t byte_idx = bit_idx >> 3;
+            if (byte_idx >= byte_start && byte_idx < byte_end) {
+                bitmap[byte_idx] &= ~(1 << (bit_idx & 7));
+            }
+        }
+    }
+}
+
 /**
  * Create a prime sieve for all numbers up to threshold.
  * Returns NULL on allocation failure.
@@ -108,6 +151,9 @@ static inline PrimeSieve* sieve_create(uint64_t threshold) {
     sieve->threshold = threshold;
     sieve->num_bytes = threshold / 30 + 1;
     sieve->prime_count = 0;  /* Computed lazily */
+    sieve->mapping = NULL;
+    sieve->mapping_bytes = 0;
+    sieve->release = NULL;
 
     sieve->bitmap = (uint8_t*)malloc(sieve->num_bytes);
     if (!sieve->bitmap) {
@@ -184,32 +230,8 @@ static inline PrimeSieve* sieve_create(uint64_t threshold) {
         uint64_t byte_end = byte_start + SIEVE_SEGMENT_BYTES;
         if (byte_end > sieve->num_bytes) byte_end = sieve->num_bytes;
 
-        /* This segment covers numbers in range [n_start, n_end] */
-        uint64_t n_start = (byte_start / 1) * 30;  /* First block's base */
-        uint64_t n_end = ((byte_end * 8) / 8 + 1) * 30;
-        if (n_end > threshold) n_end = threshold;
-
-        /* Apply each sieving prime to this segment */
-        for (uint64_t i = 0; i < num_sieving_primes; i++) {
-            uint64_t p = sieving_primes[i];
-            if (p * p > n_end) break;
-
-            /* Find first multiple of p >= max(p*p, n_start) */
-            uint64_t start = p * p;
-            if (start < n_start) {
-                start = ((n_start + p - 1) / p) * p;
-            }
-
-            /* Sieve multiples of p in this segment */
-            for (uint64_t m = start; m <= n_end && m <= threshold; m += p) {
-                if (!wheel30_is_coprime(m)) continue;
-                uint64_t bit_idx = wheel30_bit_index(m);
-                uint64_t byte_idx = bit_idx >> 3;
-                if (byte_idx >= byte_start && byte_idx < byte_end) {
-                    sieve->bitmap[byte_idx] &= ~(1 << (bit_idx & 7));
-                }
-            }
-        }
+        sieve_segment(sieve->bitmap, threshold, sieving_primes, num_sieving_primes,
+                      byte_start, byte_end);
     }
 
     free(sieving_primes);
@@ -219,13 +241,43 @@ static inline PrimeSieve* sieve_create(uint64_t threshold) {
     return sieve;
 }
 
+/**
+ * Copy a sieve into a fresh heap bitmap. Returns NULL on allocation failure.
+ *
+ * The copy's pages are first touched by the calling thread, so under the
+ * default Linux memory policy they live on that thread's NUMA node: a
+ * thread pinned to each node can build a node-local replica (search.c
+ * --affinity).
+ */
+static inline PrimeSieve* sieve_clone(const PrimeSieve *src) {
+    PrimeSieve *sieve = (PrimeSieve*)malloc(sizeof(PrimeSieve));
+    if (!sieve) return NULL;
+
+    *sieve = *src;
+    sieve->mapping = NULL;
+    sieve->mapping_bytes = 0;
+    sieve->release = NULL;
+
+    sieve->bitmap = (uint8_t*)malloc(src->num_bytes);
+    if (!sieve->bitmap) {
+        free(sieve);
+        return NULL;
+    }
+    memcpy(sieve->bitmap, src->bitmap, src->num_bytes);
+    return sieve;
+}
+
 /* ========================================================================== */
 /* Sieve Destruction                                                          */
 /* ========================================================================== */
 
 static inline void sieve_destroy(PrimeSieve *sieve) {
     if (sieve) {
-        free(sieve->bitmap);
+        if (sieve->release) {
+            sieve->release(sieve);
+        } else {
+            free(sieve->bitmap);
+        }
         free(sieve);
     }
 }
@@ -0,0 +1,233 @@
+/*
+ * Progress Monitor Thread
+ *
+ * Progress lines used to be printed by the workers themselves: every 2^18 n
+ * each one read the clock, and whichever found the interval elapsed entered
+ * a critical section to sum all threads' statistics. That put clock reads
+ * and a lock on the hot path, and the lifetime-average rate it printed hid
+ * any slowdown behind hours of history.
+ *
+ * Now a worker only publishes how many n it has finished, with a relaxed
+ * store to its own cache line (single writer, no read-modify-write). One
+ * monitor pthread, at the lowest nice level, samples the sum every
+ * PROGRESS_SAMPLE_MS and keeps the last PROGRESS_WINDOW samples; every
+ * PROGRESS_PRINT_SECONDS it prints
+ *
+ *   [T threads] n ~ N (P%), rate = R n/sec (last Ws), ETA: E
+ *
+ * where R is the rate over the sliding window (at most PROGRESS_WINDOW
+ * samples back) and the ETA extrapolates it over the remaining n.
+ *
+ * The monitor sleeps on a condition variable, so stopping it at the end of
+ * a run is immediate rather than waiting out a sampling period.
+ *
+ * Requires POSIX threads and clock_gettime: define _POSIX_C_SOURCE before
+ * including and link with -pthread. Lowering the monitor's priority uses
+ * the Linux per-thread nice value.
+ */
+
+#ifndef PROGRESS_MONITOR_H
+#define PROGRESS_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "fmt.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Sampling period of the monitor, in milliseconds */
+#define PROGRESS_SAMPLE_MS 500
+
+/* Samples in the rate window (60 x 0.5s = 30s) */
+#define PROGRESS_WINDOW 60
+
+/* Seconds between progress lines */
+#define PROGRESS_PRINT_SECONDS 5.0
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+/* One per worker: n finished by that thread, written only by it */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t done;
+} ProgressSlot;
+
+typedef struct {
+    double t;                   /* Seconds since the monitor started */
+    uint64_t done;              /* Sum over all slots */
+} ProgressSample;
+
+typedef struct {
+    ProgressSlot *slots;
+    int num_threads;
+    uint64_t n_start;           /* Range start (for the n ~ estimate) */
+    uint64_t prior_done;        /* Finished by earlier runs (resume) */
+    uint64_t pending_total;     /* n this run has to search */
+    uint64_t total;             /* Size of the whole range */
+    pthread_t thread;
+    bool running;               /* Monitor thread was started */
+    pthread_mutex_t lock;       /* Guards stop; wake lets stop interrupt a sleep */
+    pthread_cond_t wake;
+    bool stop;
+} ProgressMonitor;
+
+/* ========================================================================== */
+/* Monitor Thread                                                             */
+/* ========================================================================== */
+
+static inline double progress_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* "2h 15m" style duration into buf (the monitor's own: fmt_time is not shared) */
+static inline const char* progress_fmt_eta(double seconds, char buf[32]) {
+    long s = (long)seconds;
+    if (s < 60) {
+        snprintf(buf, 32, "%lds", s);
+    } else if (s < 3600) {
+        snprintf(buf, 32, "%ldm %lds", s / 60, s % 60);
+    } else if (s < 86400) {
+        snprintf(buf, 32, "%ldh %ldm", s / 3600, (s % 3600) / 60);
+    } else {
+        snprintf(buf, 32, "%ldd %ldh", s / 86400, (s % 86400) / 3600);
+    }
+    return buf;
+}
+
+static inline uint64_t progress_sum(const ProgressMonitor *m) {
+    uint64_t sum = 0;
+    for (int i = 0; i < m->num_threads; i++) {
+        sum += atomic_load_explicit(&m->slots[i].done, memory_order_relaxed);
+    }
+    return sum;
+}
+
+static void *progress_monitor_run(void *arg) {
+    ProgressMonitor *m = (ProgressMonitor *)arg;
+
+#ifdef __linux__
+    /* Sampling must never take a CPU from a worker */
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+
+    ProgressSample window[PROGRESS_WINDOW];
+    int count = 0, head = 0;        /* Ring of the last count samples */
+    double start = progress_now();
+    double last_print = 0.0;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    pthread_mutex_lock(&m->lock);
+    while (1) {
+        deadline.tv_nsec += PROGRESS_SAMPLE_MS * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        int rc = 0;     /* Wakes early only for stop (or spuriously) */
+        while (!m->stop && rc == 0) {
+            rc = pthread_cond_timedwait(&m->wake, &m->lock, &deadline);
+        }
+        if (m->stop) break;
+
+        ProgressSample s = {progress_now() - start, progress_sum(m)};
+        window[head] = s;
+        head = (head + 1) % PROGRESS_WINDOW;
+        if (count < PROGRESS_WINDOW) count++;
+
+        /* Half a period of slack keeps the lines on the sampling grid */
+        if (s.t - last_print < PROGRESS_PRINT_SECONDS - PROGRESS_SAMPLE_MS / 2000.0) continue;
+        last_print = s.t;
+
+        /* Oldest sample in the window; before the first wrap it is the start */
+        const ProgressSample origin = {0.0, 0};
+        const ProgressSample *old = count < PROGRESS_WINDOW
+            ? &origin : &window[head];
+        double span = s.t - old->t;
+        double rate = span > 0 ? (s.done - old->done) / span : 0.0;
+
+        uint64_t remaining = m->pending_total > s.done ? m->pending_total - s.done : 0;
+        double eta_seconds = rate > 0 ? remaining / rate : 0;
+        double pct = 100.0 * (m->prior_done + s.done) / m->total;
+
+        char eta[32];
+        printf("[%d threads] n ~ %s (%.1f%%), rate = %s n/sec (last %.0fs), ETA: %s\n",
+               m->num_threads, fmt_num(m->n_start + m->prior_done + s.done),
+               pct, fmt_num((uint64_t)rate), span, progress_fmt_eta(eta_seconds, eta));
+        fflush(stdout);
+    }
+    pthread_mutex_unlock(&m->lock);
+    return NULL;
+}
+
+/* ========================================================================== */
+/* API                                                                        */
+/* ========================================================================== */
+
+/**
+ * Allocate one slot per worker and start the monitor thread. Returns false
+ * only if the slots cannot be allocated; if the thread cannot be started
+ * the search runs without progress lines.
+ */
+static inline bool progress_monitor_start(ProgressMonitor *m, int num_threads,
+                                          uint64_t n_start, uint64_t prior_done,
+                                          uint64_t pending_total, uint64_t total) {
+    memset(m, 0, sizeof(*m));
+    m->slots = (ProgressSlot *)aligned_alloc(64, (size_t)num_threads * sizeof(ProgressSlot));
+    if (!m->slots) return false;
+    for (int i = 0; i < num_threads; i++) atomic_init(&m->slots[i].done, 0);
+    m->num_threads = num_threads;
+    m->n_start = n_start;
+    m->prior_done = prior_done;
+    m->pending_total = pending_total;
+    m->total = total;
+    m->stop = false;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&m->lock, NULL);
+    m->running = pthread_create(&m->thread, NULL, progress_monitor_run, m) == 0;
+    return true;
+}
+
+/**
+ * Publish that thread tid has finished done n in total (this run)
+ */
+static inline void progress_monitor_publish(ProgressMonitor *m, int tid, uint64_t done) {
+    atomic_store_explicit(&m->slots[tid].done, done, memory_order_relaxed);
+}
+
+/**
+ * Stop the monitor thread and free the slots
+ */
+static inline void progress_monitor_stop(ProgressMonitor *m) {
+    pthread_mutex_lock(&m->lock);
+    m->stop = true;
+    pthread_cond_signal(&m->wake);
+    pthread_mutex_unlock(&m->lock);
+    if (m->running) pthread_join(m->thread, NULL);
+    pthread_cond_destroy(&m->wake);
+    pthread_mutex_destroy(&m->lock);
+    free(m->slots);
+    m->slots = NULL;
+}
+
+#endif /* PROGRESS_MONITOR_H */
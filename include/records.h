@@ -0,0 +1,207 @@
+/*
+ * Top-K Record Tracker: The Hardest n
+ *
+ * The conjecture's margin shows in the n whose walk goes furthest before a
+ * prime turns up. For every solved n the tracker sees the solving a, the
+ * walk's a_max and the (minimal) prime p = (N - a²) / 2, and keeps two
+ * top-K tables in the style of prime-gap record lists:
+ *
+ *   steps  most a-steps walked, (a_max - a) / 2 + 1 (the smallest
+ *          solving a relative to a_max)
+ *   p      largest minimal p
+ *
+ * Each table is a K-entry min-heap whose root is the weakest entry. The
+ * per-n cost is one multiply and two compares against cached entry
+ * thresholds; the heap is only touched by the rare n that beats one.
+ *
+ * Ties rank the smaller n first. Since (key, n) is a total order the final
+ * tables do not depend on how n were split across threads: each thread
+ * keeps its own tracker and records_merge() combines them at the end.
+ */
+
+#ifndef RECORDS_H
+#define RECORDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include "fmt.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Entries per table */
+#define RECORDS_TOP_K 10
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+typedef enum {
+    RECORD_STEPS = 0,       /* Most a-steps */
+    RECORD_P = 1            /* Largest minimal p */
+} RecordKind;
+
+typedef struct {
+    uint64_t n;
+    uint64_t a;             /* Solving (largest valid) a */
+    uint64_t steps;         /* (a_max - a) / 2 + 1 */
+    __uint128_t p;          /* (8n + 3 - a²) / 2 */
+} NRecord;
+
+typedef struct {
+    NRecord entry[RECORDS_TOP_K];   /* Min-heap: entry[0] is the weakest */
+    int count;
+} RecordHeap;
+
+typedef struct {
+    RecordHeap heap[2];     /* Indexed by RecordKind */
+    uint64_t min_steps;     /* Smallest steps that can enter (0 until full) */
+    __uint128_t min_p;      /* Smallest p that can enter (0 until full) */
+} RecordTracker;
+
+/* ========================================================================== */
+/* Heap                                                                       */
+/* ========================================================================== */
+
+static inline __uint128_t record_key(const NRecord *r, RecordKind kind) {
+    return kind == RECORD_P ? r->p : (__uint128_t)r->steps;
+}
+
+/* x ranks above y: larger key, then smaller n */
+static inline bool record_better(const NRecord *x, const NRecord *y, RecordKind kind) {
+    __uint128_t kx = record_key(x, kind), ky = record_key(y, kind);
+    return kx != ky ? kx > ky : x->n < y->n;
+}
+
+static inline void record_heap_sift_down(RecordHeap *h, RecordKind kind, int i) {
+    while (1) {
+        int worst = i;
+        int l = 2 * i + 1, r = 2 * i + 2;
+        if (l < h->count && record_better(&h->entry[worst], &h->entry[l], kind)) worst = l;
+        if (r < h->count && record_better(&h->entry[worst], &h->entry[r], kind)) worst = r;
+        if (worst == i) return;
+        NRecord t = h->entry[i];
+        h->entry[i] = h->entry[worst];
+        h->entry[worst] = t;
+        i = worst;
+    }
+}
+
+/* Insert r if it ranks in the top RECORDS_TOP_K */
+static inline void record_heap_offer(RecordHeap *h, RecordKind kind, const NRecord *r) {
+    if (h->count < RECORDS_TOP_K) {
+        int i = h->count++;
+        h->entry[i] = *r;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!record_better(&h->entry[parent], &h->entry[i], kind)) break;
+            NRecord t = h->entry[i];
+            h->entry[i] = h->entry[parent];
+            h->entry[parent] = t;
+            i = parent;
+        }
+        return;
+    }
+    if (!record_better(r, &h->entry[0], kind)) return;
+    h->entry[0] = *r;
+    record_heap_sift_down(h, kind, 0);
+}
+
+/* ========================================================================== */
+/* Tracker API                                                                */
+/* ========================================================================== */
+
+static inline void records_init(RecordTracker *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+/* Slow path: offer r to the tables whose threshold it reaches */
+static inline void records_offer(RecordTracker *t, const NRecord *r) {
+    if (r->steps >= t->min_steps) {
+        RecordHeap *h = &t->heap[RECORD_STEPS];
+        record_heap_offer(h, RECORD_STEPS, r);
+        if (h->count == RECORDS_TOP_K) t->min_steps = h->entry[0].steps;
+    }
+    if (r->p >= t->min_p) {
+        RecordHeap *h = &t->heap[RECORD_P];
+        record_heap_offer(h, RECORD_P, r);
+        if (h->count == RECORDS_TOP_K) t->min_p = h->entry[0].p;
+    }
+}
+
+/**
+ * Observe a solved n: solving a, odd a_max of the walk, N = 8n + 3
+ */
+static inline void records_observe(RecordTracker *t, uint64_t n, uint64_t a,
+                                   uint64_t a_max, __uint128_t N) {
+    uint64_t steps = (a_max - a) / 2 + 1;
+    __uint128_t p = (N - (__uint128_t)a * a) >> 1;
+    if (__builtin_expect(steps >= t->min_steps || p >= t->min_p, 0)) {
+        NRecord r = {n, a, steps, p};
+        records_offer(t, &r);
+    }
+}
+
+/**
+ * Add every entry of src to dst
+ */
+static inline void records_merge(RecordTracker *dst, const RecordTracker *src) {
+    for (int kind = 0; kind < 2; kind++) {
+        RecordHeap *h = &dst->heap[kind];
+        for (int i = 0; i < src->heap[kind].count; i++) {
+            record_heap_offer(h, (RecordKind)kind, &src->heap[kind].entry[i]);
+        }
+    }
+    if (dst->heap[RECORD_STEPS].count == RECORDS_TOP_K) {
+        dst->min_steps = dst->heap[RECORD_STEPS].entry[0].steps;
+    }
+    if (dst->heap[RECORD_P].count == RECORDS_TOP_K) {
+        dst->min_p = dst->heap[RECORD_P].entry[0].p;
+    }
+}
+
+/**
+ * Copy one table to out[], best first. Returns the number of entries.
+ */
+static inline int records_sorted(const RecordTracker *t, RecordKind kind,
+                                 NRecord out[RECORDS_TOP_K]) {
+    const RecordHeap *h = &t->heap[kind];
+    for (int i = 0; i < h->count; i++) {
+        NRecord r = h->entry[i];
+        int j = i;
+        while (j > 0 && record_better(&r, &out[j - 1], kind)) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = r;
+    }
+    return h->count;
+}
+
+/* ========================================================================== */
+/* Report                                                                     */
+/* ========================================================================== */
+
+static inline void records_print(const RecordTracker *t) {
+    static const char *const titles[2] = {
+        "Hardest n (most a-steps before a prime):",
+        "Largest minimal p:"
+    };
+    for (int kind = 0; kind < 2; kind++) {
+        NRecord sorted[RECORDS_TOP_K];
+        int count = records_sorted(t, (RecordKind)kind, sorted);
+        if (count == 0) continue;
+        printf("\n%s\n", titles[kind]);
+        printf("  %-4s %-26s %-14s %-10s %s\n", "#", "n", "a", "steps", "p");
+        for (int i = 0; i < count; i++) {
+            printf("  %-4d %-26s %-14s %-10s %s\n", i + 1, fmt_num(sorted[i].n),
+                   fmt_num(sorted[i].a), fmt_num(sorted[i].steps),
+                   fmt_num128(sorted[i].p));
+        }
+    }
+}
+
+#endif /* RECORDS_H */
@@ -0,0 +1,278 @@
+/*
+ * Structured Result Log with a Background Writer
+ *
+ * --results FILE records the search as CSV so downstream tools can ingest
+ * it without scraping stdout. Worker threads never touch the file: each
+ * owns a single-producer / single-consumer ring of fixed-size records and
+ * pushes with one release store. One writer pthread drains all rings,
+ * formats the rows and does the I/O, sleeping briefly when there is
+ * nothing to write.
+ *
+ * A push never blocks. If a ring is full the record is dropped and counted
+ * (the writer warns at close); at RESULT_RING_SLOTS records per thread and
+ * a drain every few milliseconds this needs the writer to stall for
+ * thousands of chunks.
+ *
+ * Rows (one header line, then one row per record):
+ *
+ *   type,thread,n_lo,n_hi,n_processed,checks,sieve_hits,sieve_misses,
+ *   counterexamples,start_s,seconds,a,p,steps
+ *
+ *   chunk           finished part [n_lo, n_hi) of a claimed chunk, its
+ *                   statistics, start time (since run start) and duration
+ *   counterexample  n = n_lo (n_hi = n_lo + 1), time found in start_s
+ *   summary         written at close: whole-run totals over [n_lo, n_hi),
+ *                   thread = number of threads, seconds = wall time
+ *                   (throughput = n_processed / seconds, sieve hit rate =
+ *                   sieve_hits / (sieve_hits + sieve_misses))
+ *   record_steps    written at close, best first: the top-K n by a-steps
+ *   record_p        and by minimal p (records.h); n = n_lo, with a, p and
+ *                   steps filled in (these three are empty in other rows)
+ *
+ * The file is opened for appending, so a resumed run adds its rows after
+ * those of the previous runs; the header is written only to an empty file.
+ * Chunks finished after the last checkpoint save of a killed run are
+ * logged here but redone by the resumed run; merge drops the earlier rows.
+ *
+ * Requires POSIX threads and nanosleep: define _POSIX_C_SOURCE before
+ * including and link with -pthread.
+ */
+
+#ifndef RESULT_LOG_H
+#define RESULT_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "checkpoint.h"
+#include "records.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Records per thread ring (power of two) */
+#define RESULT_RING_SLOTS 1024
+
+/* Writer sleep when all rings are empty, in milliseconds */
+#define RESULT_WRITER_IDLE_MS 5
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+typedef enum {
+    RESULT_CHUNK = 0,
+    RESULT_COUNTEREXAMPLE = 1,
+    RESULT_SUMMARY = 2,
+    RESULT_RECORD_STEPS = 3,
+    RESULT_RECORD_P = 4
+} ResultType;
+
+typedef struct {
+    ResultType type;
+    int thread;
+    uint64_t n_lo;
+    uint64_t n_hi;
+    CheckpointStats stats;
+    double start;               /* Seconds since run start */
+    double seconds;             /* Duration */
+    const NRecord *record;      /* RESULT_RECORD_* only (written at close) */
+} ResultRecord;
+
+/* Single-producer (worker thread) / single-consumer (writer) ring */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t head;     /* Next slot to fill (producer) */
+    _Alignas(64) _Atomic uint64_t tail;     /* Next slot to drain (writer) */
+    _Atomic uint64_t dropped;               /* Pushes that found the ring full */
+    ResultRecord slots[RESULT_RING_SLOTS];
+} ResultRing;
+
+typedef struct {
+    FILE *file;
+    ResultRing *rings;
+    int num_rings;
+    pthread_t writer;
+    _Atomic int stop;
+} ResultLog;
+
+/* ========================================================================== */
+/* Writer Thread                                                              */
+/* ========================================================================== */
+
+/* Decimal digits of a 128-bit value (CSV: no separators) */
+static inline const char* result_log_u128(__uint128_t x, char buf[40]) {
+    char *p = buf + 39;
+    *p = '\0';
+    do {
+        *--p = (char)('0' + (int)(x % 10));
+        x /= 10;
+    } while (x > 0);
+    return p;
+}
+
+static inline void result_log_write_row(FILE *f, const ResultRecord *r) {
+    static const char *const names[] = {
+        "chunk", "counterexample", "summary", "record_steps", "record_p"
+    };
+    fprintf(f, "%s,%d,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.6f,%.6f",
+            names[r->type], r->thread,
+            (unsigned long long)r->n_lo, (unsigned long long)r->n_hi,
+            (unsigned long long)r->stats.n_processed,
+            (unsigned long long)r->stats.total_checks,
+            (unsigned long long)r->stats.sieve_hits,
+            (unsigned long long)r->stats.sieve_misses,
+            (unsigned long long)r->stats.counterexamples,
+            r->start, r->seconds);
+    if (r->record) {
+        char digits[40];
+        fprintf(f, ",%llu,%s,%llu\n", (unsigned long long)r->record->a,
+                result_log_u128(r->record->p, digits),
+                (unsigned long long)r->record->steps);
+    } else {
+        fprintf(f, ",,,\n");
+    }
+}
+
+/* Write every record currently in ring; returns the number written */
+static inline uint64_t result_ring_drain(ResultRing *ring, FILE *f) {
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    for (uint64_t i = tail; i != head; i++) {
+        result_log_write_row(f, &ring->slots[i & (RESULT_RING_SLOTS - 1)]);
+    }
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+    return head - tail;
+}
+
+static void *result_log_writer(void *arg) {
+    ResultLog *log = (ResultLog *)arg;
+    const struct timespec idle = {0, RESULT_WRITER_IDLE_MS * 1000000L};
+
+    while (1) {
+        /* Producers are finished once stop is seen: one last drain */
+        bool stopping = atomic_load_explicit(&log->stop, memory_order_acquire);
+        uint64_t written = 0;
+        for (int i = 0; i < log->num_rings; i++) {
+            written += result_ring_drain(&log->rings[i], log->file);
+        }
+        if (stopping) break;
+        if (written == 0) {
+            fflush(log->file);
+            nanosleep(&idle, NULL);
+        }
+    }
+    fflush(log->file);
+    return NULL;
+}
+
+/* ========================================================================== */
+/* API                                                                        */
+/* ========================================================================== */
+
+/**
+ * Open path for appending and start the writer thread with one ring per
+ * worker thread. Returns false if the file or the thread cannot be created.
+ */
+static inline bool result_log_open(ResultLog *log, const char *path, int num_threads) {
+    memset(log, 0, sizeof(*log));
+    log->file = fopen(path, "a");
+    if (!log->file) return false;
+    if (fseek(log->file, 0, SEEK_END) == 0 && ftell(log->file) == 0) {
+        fprintf(log->file, "type,thread,n_lo,n_hi,n_processed,checks,sieve_hits,"
+                           "sieve_misses,counterexamples,start_s,seconds,a,p,steps\n");
+    }
+
+    size_t bytes = (size_t)num_threads * sizeof(ResultRing);
+    log->rings = (ResultRing *)aligned_alloc(64, bytes);
+    if (!log->rings) {
+        fclose(log->file);
+        return false;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        atomic_init(&log->rings[i].head, 0);
+        atomic_init(&log->rings[i].tail, 0);
+        atomic_init(&log->rings[i].dropped, 0);
+    }
+    log->num_rings = num_threads;
+    atomic_init(&log->stop, 0);
+
+    if (pthread_create(&log->writer, NULL, result_log_writer, log) != 0) {
+        free(log->rings);
+        fclose(log->file);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Queue a record from worker thread tid (never blocks; drops if full)
+ */
+static inline void result_log_push(ResultLog *log, int tid, const ResultRecord *rec) {
+    ResultRing *ring = &log->rings[tid];
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= RESULT_RING_SLOTS) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    ring->slots[head & (RESULT_RING_SLOTS - 1)] = *rec;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+static inline void result_log_chunk(ResultLog *log, int tid, uint64_t lo, uint64_t hi,
+                                    const CheckpointStats *stats,
+                                    double start, double seconds) {
+    ResultRecord rec = {RESULT_CHUNK, tid, lo, hi, *stats, start, seconds, NULL};
+    result_log_push(log, tid, &rec);
+}
+
+static inline void result_log_counterexample(ResultLog *log, int tid, uint64_t n,
+                                             double time) {
+    ResultRecord rec = {RESULT_COUNTEREXAMPLE, tid, n, n + 1, {0}, time, 0.0, NULL};
+    result_log_push(log, tid, &rec);
+}
+
+/**
+ * Stop the writer after it has drained every ring, append the summary row
+ * and the record tables (each if given) and close the file. Call after all
+ * workers have finished.
+ * Returns false on a write error or if records were dropped.
+ */
+static inline bool result_log_close(ResultLog *log, const ResultRecord *summary,
+                                    const RecordTracker *records) {
+    atomic_store_explicit(&log->stop, 1, memory_order_release);
+    pthread_join(log->writer, NULL);
+
+    uint64_t dropped = 0;
+    for (int i = 0; i < log->num_rings; i++) {
+        dropped += atomic_load_explicit(&log->rings[i].dropped, memory_order_relaxed);
+    }
+    if (dropped > 0) {
+        fprintf(stderr, "Warning: result log dropped %llu records (rings full)\n",
+                (unsigned long long)dropped);
+    }
+
+    if (summary) result_log_write_row(log->file, summary);
+    for (int kind = 0; records && kind < 2; kind++) {
+        NRecord sorted[RECORDS_TOP_K];
+        int count = records_sorted(records, (RecordKind)kind, sorted);
+        for (int i = 0; i < count; i++) {
+            ResultRecord row = {kind == RECORD_P ? RESULT_RECORD_P : RESULT_RECORD_STEPS,
+                                -1, sorted[i].n, sorted[i].n + 1, {0}, 0.0, 0.0,
+                                &sorted[i]};
+            result_log_write_row(log->file, &row);
+        }
+    }
+    bool ok = !ferror(log->file);
+    ok = (fclose(log->file) == 0) && ok;
+    free(log->rings);
+    return ok && dropped == 0;
+}
+
+#endif /* RESULT_LOG_H */
@@ -0,0 +1,158 @@
+/*
+ * libsearch8n3: Embeddable Search API
+ *
+ * The search engines of ./search as a library (make lib builds
+ * libsearch8n3.a and libsearch8n3.so from src/s8n3.c), so a harness can
+ * dispatch sub-ranges by function call instead of spawning the CLI and
+ * scraping stdout:
+ *
+ *   s8n3_opts opts;
+ *   s8n3_opts_init(&opts);
+ *   opts.sieve_threshold = 100000000;           // built once per context
+ *   s8n3_context *ctx = s8n3_create(&opts, NULL);
+ *
+ *   s8n3_callbacks cb = {0};
+ *   cb.counterexample = on_counterexample;      // any subset may be set
+ *   for (...) {
+ *       s8n3_result res;
+ *       int rc = s8n3_search(ctx, lo, hi, &opts, &cb, &res);
+ *       ...
+ *   }
+ *   s8n3_destroy(ctx);
+ *
+ * A context owns what is expensive to set up: the prime sieve (built, or a
+ * --generate-sieve file mapped read-only), the per-thread state and the
+ * thread count. The OpenMP thread pool persists between searches, so a
+ * search costs only its own work. s8n3_search_range() is the one-shot form
+ * (context created and destroyed around one search).
+ *
+ * Engines (s8n3_opts.engine):
+ *
+ *   S8N3_ENGINE_PER_N     one n at a time (./search); any n < 2^64
+ *   S8N3_ENGINE_PIPELINE  pipeline_width n in flight per thread with batched
+ *                         Miller-Rabin (./search --pipeline); chunks past
+ *                         n = 2^61 fall back to per-n
+ *   S8N3_ENGINE_BATCHED   segmented batch sieve over batch_size n at a time
+ *                         (./search_batched); n_end <= 2^61. Only the
+ *                         n_processed and counterexamples counts are kept
+ *
+ * Callbacks are invoked one at a time (serialized across the worker
+ * threads), so they need not be thread-safe, but they run on worker
+ * threads and delay the search while they execute. A callback may call
+ * s8n3_cancel() on its context. The same context must not run two
+ * searches at once.
+ */
+
+#ifndef S8N3_H
+#define S8N3_H
+
+#include <stdint.h>
+#include "version.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ========================================================================== */
+/* Types                                                                      */
+/* ========================================================================== */
+
+#define S8N3_VERSION SEARCH8N3_VERSION    /* version.h */
+
+/* Return codes of s8n3_search() and s8n3_search_range() */
+enum {
+    S8N3_OK = 0,                /* Range searched, no counterexample */
+    S8N3_COUNTEREXAMPLE = 2,    /* Counterexample found (search stopped) */
+    S8N3_CANCELLED = 3,         /* Stopped by s8n3_cancel() */
+    S8N3_ERR_ARGS = -1,         /* Invalid range or options */
+    S8N3_ERR_MEMORY = -2,       /* Allocation failed */
+    S8N3_ERR_SIEVE = -3         /* Sieve could not be built or mapped */
+};
+
+typedef enum {
+    S8N3_ENGINE_PER_N = 0,
+    S8N3_ENGINE_PIPELINE = 1,
+    S8N3_ENGINE_BATCHED = 2
+} s8n3_engine;
+
+typedef struct {
+    /* Context (s8n3_create) */
+    int threads;                /* 0 = all CPUs allowed by affinity and quota */
+    uint64_t sieve_threshold;   /* Build a sieve up to this (0 = none) */
+    const char *sieve_file;     /* Or map this --generate-sieve file */
+
+    /* Search (s8n3_search) */
+    s8n3_engine engine;
+    int pipeline_width;         /* S8N3_ENGINE_PIPELINE: n in flight per thread */
+    uint64_t batch_size;        /* S8N3_ENGINE_BATCHED: n per batch */
+    double progress_seconds;    /* Minimum interval between progress callbacks */
+} s8n3_opts;
+
+/* Statistics over a range (a chunk, or a whole search) */
+typedef struct {
+    uint64_t n_lo;              /* Range [n_lo, n_hi) */
+    uint64_t n_hi;
+    uint64_t n_processed;
+    uint64_t checks;            /* a values tested */
+    uint64_t sieve_hits;        /* Primes decided by the sieve */
+    uint64_t sieve_misses;      /* Primes decided by Miller-Rabin */
+    uint64_t counterexamples;
+    double seconds;             /* Wall time */
+    int thread;                 /* Worker thread (chunks), thread count (results) */
+} s8n3_stats;
+
+typedef s8n3_stats s8n3_result;
+
+typedef struct {
+    void *user;                 /* Passed to every callback */
+
+    /* done of total n finished, seconds since the search started */
+    void (*progress)(void *user, uint64_t done, uint64_t total, double seconds);
+
+    /* n has no solution (the search stops after this) */
+    void (*counterexample)(void *user, uint64_t n);
+
+    /* A finished chunk; the chunks of a completed search tile its range */
+    void (*chunk)(void *user, const s8n3_stats *chunk);
+} s8n3_callbacks;
+
+/* Opaque: sieve, per-thread state, thread count */
+typedef struct s8n3_context s8n3_context;
+
+/* ========================================================================== */
+/* API                                                                        */
+/* ========================================================================== */
+
+/* Defaults: per-n engine, all threads, no sieve, width 8, batches of 65536 */
+void s8n3_opts_init(s8n3_opts *opts);
+
+/* Create a context (builds or maps the sieve). NULL on failure; *err (if
+   given) is then one of the S8N3_ERR_* codes */
+s8n3_context *s8n3_create(const s8n3_opts *opts, int *err);
+
+void s8n3_destroy(s8n3_context *ctx);
+
+/* Worker threads the context's searches use */
+int s8n3_threads(const s8n3_context *ctx);
+
+/* Search [n_start, n_end) with ctx. opts (NULL = defaults) selects the
+   engine; callbacks and result may be NULL. Returns an S8N3_* code */
+int s8n3_search(s8n3_context *ctx, uint64_t n_start, uint64_t n_end,
+                const s8n3_opts *opts, const s8n3_callbacks *callbacks,
+                s8n3_result *result);
+
+/* One-shot: create a context from opts, search, destroy */
+int s8n3_search_range(uint64_t n_start, uint64_t n_end, const s8n3_opts *opts,
+                      const s8n3_callbacks *callbacks, s8n3_result *result);
+
+/* Stop the running search of ctx (safe from callbacks, other threads and
+   signal handlers); it returns S8N3_CANCELLED */
+void s8n3_cancel(s8n3_context *ctx);
+
+const char *s8n3_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S8N3_H */
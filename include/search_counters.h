@@ -0,0 +1,207 @@
+/*
+ * Hot-Path Stage Counters for the Production Search (optional)
+ *
+ * analysis/profile_breakdown.c times a single-threaded copy of the search,
+ * and its per-stage clock reads distort what it measures. These counters
+ * instead sit in the real per-n walk of ./search and only count events, so
+ * tuning decisions (trial prime count, witness choice, sieve size) can be
+ * based on the production code path, with all its threads.
+ *
+ * Define SEARCH_COUNTERS before including this header (make counters) to
+ * enable them. Otherwise every SC_* macro is ((void)0) and its arguments
+ * are not evaluated: the layer compiles away completely.
+ *
+ * Each thread owns one cache-line-aligned SearchCounters entry (SC_ALLOC
+ * sizes the array for the run's thread count), so counting never shares a
+ * line between threads. Where the walk classifies in bulk
+ * (vector trial division, Miller-Rabin), the extra detail is recovered only
+ * for the rejected candidates and only in counter builds: the rejecting
+ * trial prime is found by a scalar scan, and a Miller-Rabin reject is
+ * re-tested with base 2 to tell the base-2 witness from the hash witness.
+ *
+ * Scope: the per-n walk (solve_walk.h). The --pipeline batch
+ * path is not instrumented.
+ */
+
+#ifndef SEARCH_COUNTERS_H
+#define SEARCH_COUNTERS_H
+
+#ifdef SEARCH_COUNTERS
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmt.h"
+#include "prime.h"
+#include "arith_montgomery.h"
+
+/* ========================================================================== */
+/* Data Structure                                                             */
+/* ========================================================================== */
+
+typedef struct {
+    _Alignas(64) uint64_t a_steps;  /* Walk steps (64-bit walk) */
+    uint64_t candidates;            /* Candidates >= 2 (trial division input) */
+    uint64_t small_primes;          /* Candidates that are trial primes themselves */
+    uint64_t td_reject[30];         /* Rejected by trial prime i (smallest divisor) */
+    uint64_t sieve_hits;            /* Survivors decided by sieve lookup */
+    uint64_t mr_fj32;               /* FJ32 single-witness tests */
+    uint64_t mr_fj32_reject;
+    uint64_t mr_fj64;               /* FJ64_262K tests */
+    uint64_t mr_base2_reject;       /* Rejected by the base-2 witness */
+    uint64_t mr_hash_reject;        /* Passed base 2, rejected by the hash witness */
+    uint64_t wide;                  /* 128-bit tail candidates (n >= 2^61) */
+} SearchCounters;
+
+static SearchCounters *search_counters;
+static int search_counters_threads;
+
+/* One zeroed entry per thread; false on allocation failure */
+static inline bool search_counters_alloc(int nthreads) {
+    free(search_counters);
+    search_counters = (SearchCounters *)aligned_alloc(
+        64, (size_t)nthreads * sizeof(SearchCounters));
+    search_counters_threads = search_counters ? nthreads : 0;
+    if (search_counters) {
+        memset(search_counters, 0, (size_t)nthreads * sizeof(SearchCounters));
+    }
+    return search_counters != NULL;
+}
+
+/* ========================================================================== */
+/* Classification Helpers (counter builds only)                               */
+/* ========================================================================== */
+
+/* Attribute a trial-division reject to its smallest trial prime */
+static inline void search_counters_td_reject(int tid, uint64_t c) {
+    for (int i = 0; i < NUM_TRIAL_PRIMES; i++) {
+        if (c % TRIAL_PRIMES[i] == 0) {
+            search_counters[tid].td_reject[i]++;
+            return;
+        }
+    }
+}
+
+/*
+ * One vector trial-division window: steps [0, consumed) of the window
+ * starting at (c0, delta) were visited; mask holds its survivors.
+ */
+static inline void search_counters_td_window(int tid, uint64_t c0, uint64_t delta,
+                                             uint64_t mask, uint64_t consumed) {
+    SearchCounters *sc = &search_counters[tid];
+    sc->a_steps += consumed;
+    sc->candidates += consumed;
+    for (uint64_t i = 0; i < consumed; i++) {
+        if ((mask >> i) & 1) continue;
+        search_counters_td_reject(tid, c0 + i * delta - 2 * i * (i - 1));
+    }
+}
+
+/* A Miller-Rabin decision on a trial-division survivor */
+static inline void search_counters_mr(int tid, uint64_t c, bool below32, bool prime) {
+    SearchCounters *sc = &search_counters[tid];
+    if (below32) {
+        sc->mr_fj32++;
+        if (!prime) sc->mr_fj32_reject++;
+        return;
+    }
+    sc->mr_fj64++;
+    if (prime) return;
+    if (!mr_witness_montgomery(c, 2)) {
+        sc->mr_base2_reject++;
+    } else {
+        sc->mr_hash_reject++;
+    }
+}
+
+/* ========================================================================== */
+/* Macros                                                                     */
+/* ========================================================================== */
+
+#define SC_ADD(tid, field, v)   (search_counters[tid].field += (v))
+#define SC_INC(tid, field)      (search_counters[tid].field++)
+#define SC_TD_REJECT(tid, c)    search_counters_td_reject((tid), (c))
+#define SC_TD_WINDOW(tid, c0, delta, mask, consumed) \
+    search_counters_td_window((tid), (c0), (delta), (mask), (consumed))
+#define SC_MR(tid, c, below32, prime) search_counters_mr((tid), (c), (below32), (prime))
+#define SC_ALLOC(nthreads)      search_counters_alloc(nthreads)
+#define SC_RESET()              memset(search_counters, 0, \
+                                       (size_t)search_counters_threads * sizeof(SearchCounters))
+
+/* ========================================================================== */
+/* Report                                                                     */
+/* ========================================================================== */
+
+static inline double sc_pct(uint64_t part, uint64_t whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+/**
+ * Sum the counters of nthreads threads and print the stage breakdown
+ */
+static inline void search_counters_print(int nthreads, uint64_t n_processed) {
+    SearchCounters t = {0};
+    for (int i = 0; i < nthreads; i++) {
+        const SearchCounters *s = &search_counters[i];
+        t.a_steps += s->a_steps;
+        t.candidates += s->candidates;
+        t.small_primes += s->small_primes;
+        for (int q = 0; q < 30; q++) t.td_reject[q] += s->td_reject[q];
+        t.sieve_hits += s->sieve_hits;
+        t.mr_fj32 += s->mr_fj32;
+        t.mr_fj32_reject += s->mr_fj32_reject;
+        t.mr_fj64 += s->mr_fj64;
+        t.mr_base2_reject += s->mr_base2_reject;
+        t.mr_hash_reject += s->mr_hash_reject;
+        t.wide += s->wide;
+    }
+
+    uint64_t td_total = 0;
+    for (int q = 0; q < 30; q++) td_total += t.td_reject[q];
+    uint64_t survivors = t.candidates - td_total - t.small_primes;
+    uint64_t mr = t.mr_fj32 + t.mr_fj64;
+    uint64_t mr_reject = t.mr_fj32_reject + t.mr_base2_reject + t.mr_hash_reject;
+
+    printf("\nStage Breakdown (SEARCH_COUNTERS, per-n walk):\n");
+    uint64_t steps = t.a_steps + t.wide;
+    printf("  a-steps:              %s (%.2f per n)\n", fmt_num(steps),
+           n_processed > 0 ? (double)steps / n_processed : 0.0);
+    printf("  Candidates (p >= 2):  %s\n", fmt_num(t.candidates));
+    printf("  Small primes (<=127): %s\n", fmt_num(t.small_primes));
+    printf("  Trial div. rejects:   %s (%.1f%% of candidates)\n",
+           fmt_num(td_total), sc_pct(td_total, t.candidates));
+    for (int q = 0; q < 30; q++) {
+        if (t.td_reject[q] == 0) continue;
+        printf("    by %-4u %16s  %5.1f%% of candidates\n", TRIAL_PRIMES[q],
+               fmt_num(t.td_reject[q]), sc_pct(t.td_reject[q], t.candidates));
+    }
+    printf("  Survivors:            %s (%.1f%% of candidates)\n",
+           fmt_num(survivors), sc_pct(survivors, t.candidates));
+    printf("    Sieve lookups:      %s\n", fmt_num(t.sieve_hits));
+    printf("    Miller-Rabin:       %s\n", fmt_num(mr));
+    printf("      FJ32 (1 witness): %s, %s rejected\n",
+           fmt_num(t.mr_fj32), fmt_num(t.mr_fj32_reject));
+    printf("      FJ64 (2 witness): %s, %s rejected by base 2, %s by hash witness\n",
+           fmt_num(t.mr_fj64), fmt_num(t.mr_base2_reject), fmt_num(t.mr_hash_reject));
+    printf("      Prime:            %s (%.1f%% of tests)\n",
+           fmt_num(mr - mr_reject), sc_pct(mr - mr_reject, mr));
+    if (t.wide > 0) {
+        printf("  128-bit tail:         %s candidates (BPSW past 2^64)\n", fmt_num(t.wide));
+    }
+}
+
+#else /* !SEARCH_COUNTERS */
+
+#define SC_ADD(tid, field, v)                           ((void)0)
+#define SC_INC(tid, field)                              ((void)0)
+#define SC_TD_REJECT(tid, c)                            ((void)0)
+#define SC_TD_WINDOW(tid, c0, delta, mask, consumed)    ((void)0)
+#define SC_MR(tid, c, below32, prime)                   ((void)0)
+#define SC_ALLOC(nthreads)                              (true)
+#define SC_RESET()                                      ((void)0)
+
+#endif /* SEARCH_COUNTERS */
+
+#endif /* SEARCH_COUNTERS_H */
@@ -0,0 +1,118 @@
+/*
+ * Deterministic Range Sharding by Estimated Cost
+ *
+ * --shard i/k (search, search_batched) restricts a run to the i-th of k
+ * contiguous shards of [n_start, n_end), i = 1..k, so one range can be
+ * split across machines without computing boundaries by hand. The shards
+ * tile the range exactly: shard i ends where shard i + 1 starts.
+ *
+ * Shards have equal estimated cost, not equal length. The cost of one n
+ * grows with the size of N = 8n + 3: the expected walk length grows like
+ * log N (prime density) and so does each Miller-Rabin exponentiation.
+ * The model weights n by L², L = bit length of 8n + 3 = bit length of n
+ * plus 3; measured time per n divided by L² stays within about 15% from
+ * n = 10^9 (L = 33) to 10^19 (L = 67).
+ *
+ * Everything is integer arithmetic (weights are constant on each n in
+ * [2^j, 2^(j+1)), so the cost of any range is a sum of a few exact
+ * products), hence every machine computes the same boundaries regardless
+ * of compiler or floating-point flags. The merge tool (src/merge.c) checks
+ * the shards' results files for exact coverage afterwards.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Largest shard count (keeps total_cost * k within 128 bits) */
+#define SHARD_MAX 1000000
+
+/* ========================================================================== */
+/* Cost Model                                                                 */
+/* ========================================================================== */
+
+/* Bit length of 8n + 3 */
+static inline uint64_t shard_bits(uint64_t n) {
+    return n == 0 ? 2 : (uint64_t)(64 - __builtin_clzll(n)) + 3;
+}
+
+/* End of the run of n with the same weight as n: next power of two (capped) */
+static inline uint64_t shard_segment_end(uint64_t n, uint64_t end) {
+    if (n == 0) return end < 1 ? end : 1;
+    uint64_t bits = (uint64_t)(64 - __builtin_clzll(n));
+    if (bits == 64) return end;
+    uint64_t next = 1ULL << bits;
+    return next < end ? next : end;
+}
+
+/**
+ * Estimated cost of [lo, hi): the sum of L(n)² over the range
+ */
+static inline __uint128_t shard_cost(uint64_t lo, uint64_t hi) {
+    __uint128_t cost = 0;
+    while (lo < hi) {
+        uint64_t seg_end = shard_segment_end(lo, hi);
+        uint64_t w = shard_bits(lo) * shard_bits(lo);
+        cost += (__uint128_t)w * (seg_end - lo);
+        lo = seg_end;
+    }
+    return cost;
+}
+
+/* Smallest x in [lo, hi] with shard_cost(lo, x) >= target */
+static inline uint64_t shard_point(uint64_t lo, uint64_t hi, __uint128_t target) {
+    __uint128_t acc = 0;
+    while (lo < hi) {
+        uint64_t seg_end = shard_segment_end(lo, hi);
+        uint64_t w = shard_bits(lo) * shard_bits(lo);
+        __uint128_t seg_cost = (__uint128_t)w * (seg_end - lo);
+        if (acc + seg_cost >= target) {
+            __uint128_t need = target - acc;
+            return lo + (uint64_t)((need + w - 1) / w);
+        }
+        acc += seg_cost;
+        lo = seg_end;
+    }
+    return hi;
+}
+
+/* ========================================================================== */
+/* Shards                                                                     */
+/* ========================================================================== */
+
+/**
+ * Parse "i/k" with 1 <= i <= k <= SHARD_MAX. Returns false if malformed.
+ */
+static inline bool shard_parse(const char *str, uint32_t *index, uint32_t *count) {
+    char *slash;
+    unsigned long i = strtoul(str, &slash, 10);
+    if (slash == str || *slash != '/') return false;
+    char *end;
+    unsigned long k = strtoul(slash + 1, &end, 10);
+    if (end == slash + 1 || *end != '\0') return false;
+    if (k < 1 || k > SHARD_MAX || i < 1 || i > k) return false;
+    *index = (uint32_t)i;
+    *count = (uint32_t)k;
+    return true;
+}
+
+/**
+ * Bounds [*lo, *hi) of shard index (1-based) of count over [start, end).
+ * A shard can be empty (*lo == *hi) when the range has about as few n as
+ * there are shards.
+ */
+static inline void shard_bounds(uint64_t start, uint64_t end, uint32_t index,
+                                uint32_t count, uint64_t *lo, uint64_t *hi) {
+    __uint128_t total = shard_cost(start, end);
+    *lo = shard_point(start, end, total * (index - 1) / count);
+    *hi = index == count ? end : shard_point(start, end, total * index / count);
+}
+
+#endif /* SHARD_H */
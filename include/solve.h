@@ -19,6 +19,14 @@
 #include <stdbool.h>
 #include "arith.h"
 #include "prime.h"
+#include "prime32.h"
+#include "prime128.h"
+
+/* Define SOLVE_INTERLEAVED_TD before including this header to test
+   candidates below 2^52 with is_prime_fj64_interleaved() */
+#ifdef SOLVE_INTERLEAVED_TD
+#include "prime_interleaved.h"
+#endif
 
 /* Forward declaration for sieve support (include prime_sieve.h for full API) */
 typedef struct PrimeSieve PrimeSieve;
@@ -120,6 +128,9 @@ static inline bool is_candidate_prime(uint64_t candidate) {
     if (td == 0) return false;
     if (td == 1) return true;
     if (candidate <= 127) return true;
+#ifdef SOLVE_INTERLEAVED_TD
+    if (candidate < INTERLEAVED_LIMIT) return is_prime_fj64_interleaved(candidate);
+#endif
     return is_prime_fj64_fast(candidate);
 }
 
@@ -192,6 +203,179 @@ static inline uint64_t find_solution(uint64_t n, uint64_t* p_out) {
     return find_solution_from_N(N, a_max, p_out);
 }
 
+/* ========================================================================== */
+/* 32-bit Candidate Path                                                      */
+/* ========================================================================== */
+
+/*
+ * Candidates grow as a decreases, and (N - a²)/2 < 2^32 exactly when
+ * a² > N - 2^33. One bound per chunk of n therefore splits every walk in
+ * the chunk into a 32-bit part (a above the bound, single-witness FJ32 test)
+ * and a 64-bit remainder, with no per-candidate magnitude check. Below
+ * n ~ 1.07*10^9 the bound is 0 and whole walks are 32-bit; around 10^12 it
+ * is ~760 steps below a_max, far past where nearly every walk ends.
+ */
+
+/**
+ * Largest a for which some n < n_hi can have a candidate >= 2^32:
+ * every odd a > solve_a_floor32(n_hi) gives (8n+3 - a²)/2 < 2^32.
+ */
+static inline uint64_t solve_a_floor32(uint64_t n_hi) {
+    __uint128_t N_max = 8 * (__uint128_t)(n_hi - 1) + 3;
+    if (N_max < (1ULL << 33)) return 0;
+    return isqrt128(N_max - (1ULL << 33));
+}
+
+/**
+ * is_candidate_prime() for candidates below 2^32
+ */
+static inline bool is_candidate_prime32(uint64_t candidate) {
+    int td = trial_division_check(candidate);
+    if (td == 0) return false;
+    if (td == 1) return true;
+    if (candidate <= 127) return true;
+    return is_prime_fj32_fast((uint32_t)candidate);
+}
+
+/**
+ * find_solution_from_N() with FJ32 for every a > a_floor32
+ * (from solve_a_floor32() for the chunk containing N).
+ */
+static inline uint64_t find_solution_from_N_32(uint64_t N, uint64_t a_max,
+                                               uint64_t a_floor32, uint64_t* p_out) {
+    uint64_t a = a_max;
+    uint64_t candidate = (N - a * a) >> 1;
+    uint64_t delta = 2 * (a - 1);
+
+    while (a > a_floor32) {
+        if (candidate >= 2) {
+            SOLVE_TRACK_CANDIDATE(candidate);
+
+            if (is_candidate_prime32(candidate)) {
+                if (p_out) *p_out = candidate;
+                SOLVE_TRACK_SOLUTION_FOUND();
+                return a;
+            }
+        }
+
+        if (a < 3) {
+            SOLVE_TRACK_SOLUTION_FOUND();
+            return 0;  /* Counterexample! */
+        }
+
+        candidate += delta;
+        delta -= 4;
+        a -= 2;
+    }
+
+    /* Rest of the walk has 64-bit candidates */
+    return find_solution_from_N(N, a, p_out);
+}
+
+/* ========================================================================== */
+/* 128-bit N (n >= 2^61)                                                      */
+/* ========================================================================== */
+
+/*
+ * From n = 2^61 on, N = 8n + 3 needs 128 bits, but a_max < 2^34 and the
+ * candidate (N - a²)/2 stays below 2^63 for every a with a² > N - 2^64.
+ * Down to that bound (solve_a_floor63(), ~2^31 steps below a_max even at
+ * n ~ 2^64) the walk is the usual 64-bit one with Montgomery arithmetic;
+ * only below it do candidates need 128 bits and is_prime_128().
+ */
+
+#define SOLVE_N64_LIMIT (1ULL << 61)  /* n below this: N = 8n + 3 fits 64 bits */
+
+/**
+ * Odd a_max = largest odd a with a² <= N, for 128-bit N
+ */
+static inline uint64_t solve_a_max128(__uint128_t N) {
+    uint64_t a_max = isqrt128(N);
+    if ((a_max & 1) == 0) a_max--;
+    return a_max;
+}
+
+/**
+ * Every odd a > solve_a_floor63(n_hi) gives a candidate below 2^63 for all
+ * n < n_hi (0 when n_hi <= SOLVE_N64_LIMIT)
+ */
+static inline uint64_t solve_a_floor63(uint64_t n_hi) {
+    __uint128_t N_max = 8 * (__uint128_t)(n_hi - 1) + 3;
+    __uint128_t limit = (__uint128_t)1 << 64;
+    if (N_max < limit) return 0;
+    return isqrt128(N_max - limit);
+}
+
+/**
+ * Finish a walk with 128-bit candidates, from odd a down to 1.
+ * Adds the candidates tested to *checks.
+ * Returns the a of the first prime candidate, or 0 (counterexample).
+ */
+static inline uint64_t find_solution_tail128(__uint128_t N, uint64_t a,
+                                             __uint128_t* p_out, uint64_t* checks) {
+    __uint128_t candidate = (N - (__uint128_t)a * a) >> 1;
+    uint64_t delta = 2 * (a - 1);
+
+    while (1) {
+        if (candidate >= 2) {
+            (*checks)++;
+            if (is_prime_128(candidate)) {
+                if (p_out) *p_out = candidate;
+                return a;
+            }
+        }
+        if (a < 3) return 0;
+        candidate += delta;
+        delta -= 4;
+        a -= 2;
+    }
+}
+
+/**
+ * find_solution_from_N() for 128-bit N (any n < 2^64).
+ * a_floor63 is solve_a_floor63() of the range containing N.
+ */
+static inline uint64_t find_solution_from_N128(__uint128_t N, uint64_t a_max,
+                                               uint64_t a_floor63, __uint128_t* p_out) {
+    uint64_t a = a_max;
+    uint64_t candidate = (uint64_t)((N - (__uint128_t)a * a) >> 1);
+    uint64_t delta = 2 * (a - 1);
+
+    while (a > a_floor63) {
+        if (candidate >= 2) {
+            SOLVE_TRACK_CANDIDATE(candidate);
+
+            if (is_candidate_prime(candidate)) {
+                if (p_out) *p_out = candidate;
+                SOLVE_TRACK_SOLUTION_FOUND();
+                return a;
+            }
+        }
+
+        if (a < 3) {
+            SOLVE_TRACK_SOLUTION_FOUND();
+            return 0;  /* Counterexample! */
+        }
+
+        candidate += delta;
+        delta -= 4;
+        a -= 2;
+    }
+
+    /* Candidates from here on may reach 2^63 and beyond */
+    uint64_t checks = 0;
+    SOLVE_TRACK_SOLUTION_FOUND();
+    return find_solution_tail128(N, a, p_out, &checks);
+}
+
+/**
+ * find_solution() for any n < 2^64
+ */
+static inline uint64_t find_solution128(uint64_t n, __uint128_t* p_out) {
+    __uint128_t N = 8 * (__uint128_t)n + 3;
+    return find_solution_from_N128(N, solve_a_max128(N), solve_a_floor63(n + 1), p_out);
+}
+
 /* ========================================================================== */
 /* Sieve-Enabled Solution Finder                                              */
 /* ========================================================================== */
@@ -241,6 +425,9 @@ static inline bool is_candidate_prime_with_sieve(uint64_t candidate, const Prime
 
     /* Fall back to Miller-Rabin */
     SOLVE_TRACK_SIEVE_MISS();
+#ifdef SOLVE_INTERLEAVED_TD
+    if (candidate < INTERLEAVED_LIMIT) return is_prime_fj64_interleaved(candidate);
+#endif
     return is_prime_fj64_fast(candidate);
 }
 
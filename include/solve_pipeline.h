@@ -0,0 +1,295 @@
+/*
+ * Multi-n Pipelined Solution Finder
+ *
+ * find_solution_from_N() walks one n at a time, and each Miller-Rabin test
+ * it reaches is a latency-bound chain of dependent multiplies. The pipeline
+ * instead keeps several n searches in flight as small state machines
+ * ("lanes"). Every round:
+ *
+ *   1. each lane walks a downwards (trial division only) until its
+ *      candidate needs Miller-Rabin, or the lane is solved/exhausted.
+ *      Trial division covers 8 steps of the walk at once (trial_vector.h),
+ *      and the lane jumps straight to the next survivor;
+ *   2. the parked candidates of all lanes are tested together by
+ *      is_prime_fj64_batch(), which interleaves their exponentiations;
+ *   3. lanes whose candidate was prime take the next n from the feed,
+ *      the others move on to their next survivor.
+ *
+ * Each lane visits exactly the same candidates, in the same order, as
+ * find_solution_from_N() does for its n, so results and check counts are
+ * identical; only the order in which different n finish changes.
+ *
+ * The feed maintains N and a_max incrementally (as in the sequential
+ * search loops), so no isqrt is needed per n.
+ */
+
+#ifndef SOLVE_PIPELINE_H
+#define SOLVE_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith.h"
+#include "solve.h"
+#include "prime_batch.h"
+#include "trial_vector.h"
+#include "records.h"
+#include "dispatch.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define PIPELINE_MIN_WIDTH     4
+#define PIPELINE_MAX_WIDTH     MR_BATCH_MAX
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+/*
+ * One in-flight n search. After the few small candidates at the start of
+ * the walk, the lane advances in windows of TD_STEPS steps: (a, candidate,
+ * delta) is the first step of the window and mask holds the steps of the
+ * window that survived trial division and are not yet ruled out.
+ */
+typedef struct {
+    uint64_t n;
+    uint64_t a_max;         /* Start of the walk (records.h) */
+    uint64_t a;             /* Solving a once the lane is solved */
+    uint64_t candidate;     /* (N - a²) / 2 */
+    uint64_t delta;         /* Added to candidate when a decreases by 2 */
+    uint64_t parked;        /* Candidate waiting for Miller-Rabin */
+    uint8_t mask;           /* Untested survivors of the window (bit i = step i) */
+    uint8_t steps;          /* Steps in the window, 0 = scalar phase */
+} PipelineLane;
+
+/* Counters accumulated by pipeline_run() (added to, never reset) */
+typedef struct {
+    uint64_t n_processed;
+    uint64_t total_checks;
+    uint64_t counterexamples;
+    uint64_t sieve_hits;
+    uint64_t sieve_misses;
+} PipelineStats;
+
+/* Lane advance results */
+enum {
+    PIPE_PARKED = 0,        /* Candidate needs Miller-Rabin */
+    PIPE_SOLVED = 1,        /* Candidate is prime */
+    PIPE_FAILED = 2         /* a exhausted: counterexample */
+};
+
+/* ========================================================================== */
+/* Lane State Machine                                                         */
+/* ========================================================================== */
+
+/**
+ * Start a new window of up to TD_STEPS steps at the lane's position.
+ */
+static inline void pipeline_lane_window(PipelineLane *lane) {
+    uint64_t remaining = (lane->a - 1) / 2 + 1;  /* Steps left, including this one */
+    lane->steps = remaining < TD_STEPS ? (uint8_t)remaining : TD_STEPS;
+    lane->mask = td_survivors8(lane->candidate, lane->delta, lane->steps);
+}
+
+/**
+ * Walk the lane until its candidate needs Miller-Rabin or the n is decided.
+ * Small primes, trial-division composites and sieve lookups are resolved
+ * here without leaving the lane. A parked candidate is the lowest bit of
+ * mask; the driver clears that bit if it turns out to be composite.
+ */
+static inline int pipeline_lane_advance(PipelineLane *lane, const PrimeSieve *sieve,
+                                        PipelineStats *stats) {
+    /* Scalar trial division while candidates are small (they never decrease) */
+    if (lane->steps == 0) {
+        uint64_t a = lane->a;
+        uint64_t candidate = lane->candidate;
+        uint64_t delta = lane->delta;
+        uint64_t checks = 0;
+        int status = -1;
+
+        while (candidate <= 127) {
+            if (candidate >= 2) {
+                checks++;
+                if (trial_division_check(candidate) != 0) {
+                    status = PIPE_SOLVED;
+                    break;
+                }
+            }
+            if (a < 3) {
+                status = PIPE_FAILED;
+                break;
+            }
+            candidate += delta;
+            delta -= 4;
+            a -= 2;
+        }
+
+        lane->a = a;
+        lane->candidate = candidate;
+        lane->delta = delta;
+        stats->total_checks += checks;
+        if (status >= 0) return status;
+        pipeline_lane_window(lane);
+    }
+
+    while (1) {
+        uint8_t mask = lane->mask;
+        while (mask) {
+            uint64_t i = (uint64_t)__builtin_ctz(mask);
+            uint64_t c = lane->candidate + i * lane->delta - 2 * i * (i - 1);
+            if (sieve && sieve_in_range(sieve, c)) {
+                stats->sieve_hits++;
+                if (sieve_is_prime(sieve, c)) {
+                    stats->total_checks += i + 1;
+                    lane->a -= 2 * i;
+                    return PIPE_SOLVED;
+                }
+                mask &= mask - 1;
+                continue;
+            }
+            stats->sieve_misses++;
+            lane->mask = mask;
+            lane->parked = c;
+            return PIPE_PARKED;
+        }
+
+        /* Window exhausted: move to the next one */
+        stats->total_checks += lane->steps;
+        if (lane->steps < TD_STEPS || lane->a < 2 * TD_STEPS + 1) {
+            return PIPE_FAILED;
+        }
+        lane->candidate += TD_STEPS * lane->delta - 2 * TD_STEPS * (TD_STEPS - 1);
+        lane->delta -= 4 * TD_STEPS;
+        lane->a -= 2 * TD_STEPS;
+        pipeline_lane_window(lane);
+    }
+}
+
+/**
+ * Account for a parked candidate that Miller-Rabin found prime.
+ */
+static inline void pipeline_lane_solved(PipelineLane *lane, PipelineStats *stats) {
+    uint64_t i = (uint64_t)__builtin_ctz(lane->mask);
+    stats->total_checks += i + 1;
+    lane->a -= 2 * i;
+}
+
+/* ========================================================================== */
+/* Pipeline Driver                                                            */
+/* ========================================================================== */
+
+/**
+ * Solve every n in [n_lo, n_hi) with width lanes in flight
+ * (PIPELINE_MIN_WIDTH..PIPELINE_MAX_WIDTH, clamped).
+ *
+ * On a counterexample no further n are started, but the lanes already in
+ * flight are finished, so [n_lo, return value) is always fully processed.
+ * The smallest counterexample found is stored in *counterexample, which the
+ * caller initializes to 0 (left at 0 if none is found).
+ *
+ * Every solved n is passed to records (records.h) unless it is NULL.
+ *
+ * Returns the end of the processed prefix (n_hi unless a counterexample
+ * stopped the feed). Dispatched per call in portable builds (dispatch.h).
+ */
+DISPATCH_KERNEL
+static inline uint64_t pipeline_run(uint64_t n_lo, uint64_t n_hi, int width,
+                                    const PrimeSieve *sieve, PipelineStats *stats,
+                                    RecordTracker *records, uint64_t *counterexample) {
+    if (width < PIPELINE_MIN_WIDTH) width = PIPELINE_MIN_WIDTH;
+    if (width > PIPELINE_MAX_WIDTH) width = PIPELINE_MAX_WIDTH;
+    if (n_lo >= n_hi) return n_hi;
+
+    PipelineLane lanes[PIPELINE_MAX_WIDTH];
+    bool active[PIPELINE_MAX_WIDTH];
+    uint64_t batch[PIPELINE_MAX_WIDTH];
+    int batch_lane[PIPELINE_MAX_WIDTH];
+    bool batch_prime[PIPELINE_MAX_WIDTH];
+
+    /* Feed: N and odd a_max for next_n, maintained incrementally */
+    uint64_t next_n = n_lo;
+    uint64_t N = 8 * n_lo + 3;
+    uint64_t a_max = isqrt64(N);
+    if ((a_max & 1) == 0) a_max--;
+    bool stop = false;
+
+    int num_active = 0;
+    for (int i = 0; i < width; i++) active[i] = false;
+
+    while (1) {
+        int nb = 0;
+
+        for (int i = 0; i < width; i++) {
+            while (1) {
+                if (!active[i]) {
+                    /* Refill the lane from the feed */
+                    if (stop || next_n >= n_hi) break;
+                    PipelineLane *lane = &lanes[i];
+                    lane->n = next_n;
+                    lane->a_max = a_max;
+                    lane->a = a_max;
+                    lane->candidate = (N - a_max * a_max) >> 1;
+                    lane->delta = 2 * (a_max - 1);
+                    lane->mask = 0;
+                    lane->steps = 0;
+                    active[i] = true;
+                    num_active++;
+
+                    next_n++;
+                    N += 8;
+                    uint64_t next_a = a_max + 2;
+                    if (next_a * next_a <= N) a_max = next_a;
+                }
+
+                int status = pipeline_lane_advance(&lanes[i], sieve, stats);
+                if (status == PIPE_PARKED) {
+                    batch[nb] = lanes[i].parked;
+                    batch_lane[nb] = i;
+                    nb++;
+                    break;
+                }
+
+                /* Solved or counterexample: retire the lane and refill */
+                stats->n_processed++;
+                if (status == PIPE_FAILED) {
+                    stats->counterexamples++;
+                    if (*counterexample == 0 || lanes[i].n < *counterexample) {
+                        *counterexample = lanes[i].n;
+                    }
+                    stop = true;
+                } else if (records) {
+                    records_observe(records, lanes[i].n, lanes[i].a, lanes[i].a_max,
+                                    8 * (__uint128_t)lanes[i].n + 3);
+                }
+                active[i] = false;
+                num_active--;
+            }
+        }
+
+        if (num_active == 0) break;
+
+        is_prime_fj64_batch(batch, nb, batch_prime);
+
+        for (int j = 0; j < nb; j++) {
+            int i = batch_lane[j];
+            if (batch_prime[j]) {
+                pipeline_lane_solved(&lanes[i], stats);
+                stats->n_processed++;
+                if (records) {
+                    records_observe(records, lanes[i].n, lanes[i].a, lanes[i].a_max,
+                                    8 * (__uint128_t)lanes[i].n + 3);
+                }
+                active[i] = false;
+                num_active--;
+            } else {
+                /* Composite: rule it out, the lane resumes next round */
+                lanes[i].mask &= lanes[i].mask - 1;
+            }
+        }
+    }
+
+    return next_n;
+}
+
+#endif /* SOLVE_PIPELINE_H */
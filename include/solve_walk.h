@@ -0,0 +1,320 @@
+/*
+ * Per-n Walk of ./search and libsearch8n3
+ *
+ * solve_walk() finds the largest a with 8n + 3 = a^2 + 2p for one n,
+ * walking a down from a_max. It is the per-n engine of both ./search and
+ * libsearch8n3 (s8n3.c), so the two test and count exactly the same
+ * candidates. Trial division by 3-127 is done, in order of preference, by
+ *
+ *   wheel   the thread's a-walk wheel (trial_wheel.h): 64-step skip masks
+ *   vector  td_survivors8() 8 steps at a time where the CPU has AVX-512
+ *           (trial_vector.h)
+ *   scalar  trial_division_check() per candidate
+ *
+ * and the survivors are decided by the sieve when in its range, else by
+ * Miller-Rabin: FJ32 for a > a_floor32 (solve_a_floor32() of the chunk),
+ * is_prime_fj64_interleaved() below 2^52 with --interleaved-td, FJ64_262K
+ * otherwise. For a <= a_floor63 (solve_a_floor63(), only nonzero past
+ * n = 2^61) the walk continues with 128-bit candidates.
+ *
+ * The caller owns the per-thread state (SolveWalker): the statistics the
+ * walk adds to, the thread's wheel, and the thread id that keys the stage
+ * counters (search_counters.h).
+ */
+
+#ifndef SOLVE_WALK_H
+#define SOLVE_WALK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arith.h"
+#include "solve.h"
+#include "solve_pipeline.h"    /* PipelineStats */
+#include "trial_vector.h"
+#include "trial_wheel.h"
+#include "prime_interleaved.h"
+#include "search_counters.h"
+#include "dispatch.h"
+
+/* ========================================================================== */
+/* Per-Thread State                                                           */
+/* ========================================================================== */
+
+typedef struct {
+    const PrimeSieve *sieve;    /* Survivors in its range are looked up (NULL: none) */
+    TrialWheel *wheel;          /* The thread's a-walk wheel (NULL: trial division) */
+    PipelineStats *stats;       /* Added to: n_processed, total_checks, sieve_* */
+    int thread_id;              /* Stage counters (make counters) */
+    bool interleaved_td;        /* is_prime_fj64_interleaved() below INTERLEAVED_LIMIT */
+} SolveWalker;
+
+/* ========================================================================== */
+/* Candidate Tests                                                            */
+/* ========================================================================== */
+
+/**
+ * Miller-Rabin for a trial-division survivor > 127. below32 comes from the
+ * chunk's a bound (solve_a_floor32), not from the candidate itself.
+ */
+static inline bool solve_walk_mr(const SolveWalker *w, uint64_t candidate, bool below32) {
+    bool prime;
+    if (below32) {
+        prime = is_prime_fj32_fast((uint32_t)candidate);
+    } else if (w->interleaved_td && candidate < INTERLEAVED_LIMIT) {
+        prime = is_prime_fj64_interleaved(candidate);
+    } else {
+        prime = is_prime_fj64_fast(candidate);
+    }
+    SC_MR(w->thread_id, candidate, below32, prime);
+    return prime;
+}
+
+/**
+ * Primality of a trial-division survivor > 127: sieve lookup when in range,
+ * Miller-Rabin otherwise.
+ */
+static inline bool solve_walk_survivor_prime(const SolveWalker *w, uint64_t candidate,
+                                             bool below32) {
+    if (w->sieve && sieve_in_range(w->sieve, candidate)) {
+        w->stats->sieve_hits++;
+        SC_INC(w->thread_id, sieve_hits);
+        return sieve_is_prime(w->sieve, candidate);
+    }
+    w->stats->sieve_misses++;
+    return solve_walk_mr(w, candidate, below32);
+}
+
+/**
+ * Primality of a candidate >= 2: trial division, then the sieve or
+ * Miller-Rabin.
+ */
+static inline bool solve_walk_candidate_prime(const SolveWalker *w, uint64_t candidate,
+                                              bool below32) {
+    int td = trial_division_check(candidate);
+    if (td == 0) {              /* Composite */
+        SC_TD_REJECT(w->thread_id, candidate);
+        return false;
+    }
+    if (td == 1 || candidate <= 127) {
+        SC_INC(w->thread_id, small_primes);
+        return true;
+    }
+    return solve_walk_survivor_prime(w, candidate, below32);
+}
+
+/* ========================================================================== */
+/* Walk Start and End                                                         */
+/* ========================================================================== */
+
+/**
+ * Account for a finished n: its solving a, or 0 for a counterexample.
+ * checks: candidates tested and not yet added to the stats.
+ */
+static inline uint64_t solve_walk_done(const SolveWalker *w, uint64_t a, uint64_t checks) {
+    w->stats->total_checks += checks;
+    w->stats->n_processed++;
+    return a;
+}
+
+/**
+ * Candidates may reach 2^63 from a on: finish the walk with 128-bit
+ * arithmetic
+ */
+static inline uint64_t solve_walk_wide(const SolveWalker *w, __uint128_t N, uint64_t a,
+                                       uint64_t checks) {
+    uint64_t wide_checks = 0;
+    a = find_solution_tail128(N, a, NULL, &wide_checks);
+    SC_ADD(w->thread_id, wide, wide_checks);
+    return solve_walk_done(w, a, checks + wide_checks);
+}
+
+/**
+ * The first steps of a windowed walk, while candidates are <= 127 (they
+ * never decrease): trial division alone decides them, and a window's
+ * survivor test needs candidates > 127. Returns true if this decided the
+ * n, with *a the solving a or 0 (counterexample); otherwise the walk is
+ * at the first candidate > 127. Adds the candidates tested to *checks.
+ */
+static inline bool solve_walk_small(const SolveWalker *w, uint64_t *a, uint64_t *candidate,
+                                    uint64_t *delta, uint64_t *checks) {
+    while (*candidate <= 127) {
+        SC_INC(w->thread_id, a_steps);
+        if (*candidate >= 2) {
+            (*checks)++;
+            SC_INC(w->thread_id, candidates);
+            if (trial_division_check(*candidate) != 0) {
+                SC_INC(w->thread_id, small_primes);
+                return true;
+            }
+            SC_TD_REJECT(w->thread_id, *candidate);
+        }
+        if (*a < 3) {
+            *a = 0;
+            return true;
+        }
+        *candidate += *delta;
+        *delta -= 4;
+        *a -= 2;
+    }
+    (void)w;
+    return false;
+}
+
+/* ========================================================================== */
+/* Walks                                                                      */
+/* ========================================================================== */
+
+/**
+ * solve_walk() with trial division 8 steps at a time (trial_vector.h): only
+ * the survivors of each window reach the sieve or Miller-Rabin. Visits and
+ * counts exactly the same candidates as the scalar walk.
+ */
+DISPATCH_KERNEL
+static inline uint64_t solve_walk_windowed(const SolveWalker *w, __uint128_t N, uint64_t a_max,
+                                           uint64_t a_floor32, uint64_t a_floor63) {
+    uint64_t a = a_max;
+    uint64_t candidate = (uint64_t)((N - (__uint128_t)a * a) >> 1);
+    uint64_t delta = 2 * (a - 1);
+    uint64_t checks = 0;
+
+    if (solve_walk_small(w, &a, &candidate, &delta, &checks)) {
+        return solve_walk_done(w, a, checks);
+    }
+
+    while (1) {
+        uint64_t remaining = (a - 1) / 2 + 1;  /* Steps left, including this one */
+        int steps = remaining < TD_STEPS ? (int)remaining : TD_STEPS;
+        uint64_t a_last = a - 2 * (uint64_t)(steps - 1);
+        if (a_last <= a_floor63) return solve_walk_wide(w, N, a, checks);
+        uint8_t mask = td_survivors8(candidate, delta, steps);
+        bool below32 = a_last > a_floor32;
+#ifdef SEARCH_COUNTERS
+        const uint8_t mask0 = mask;
+#endif
+
+        while (mask) {
+            uint64_t i = (uint64_t)__builtin_ctz(mask);
+            uint64_t c = candidate + i * delta - 2 * i * (i - 1);
+            if (solve_walk_survivor_prime(w, c, below32)) {
+                SC_TD_WINDOW(w->thread_id, candidate, delta, mask0, i + 1);
+                return solve_walk_done(w, a - 2 * i, checks + i + 1);
+            }
+            mask &= mask - 1;
+        }
+
+        SC_TD_WINDOW(w->thread_id, candidate, delta, mask0, (uint64_t)steps);
+        checks += (uint64_t)steps;
+        if (remaining <= TD_STEPS) return solve_walk_done(w, 0, checks);
+        candidate += TD_STEPS * delta - 2 * TD_STEPS * (TD_STEPS - 1);
+        delta -= 4 * TD_STEPS;
+        a -= 2 * TD_STEPS;
+    }
+
+}
+
+/**
+ * solve_walk() with the thread's a-walk wheel (trial_wheel.h): the steps
+ * whose candidate 3-127 divides are cleared from 64-step masks without
+ * trial division, and only the survivors reach the sieve or Miller-Rabin.
+ * Visits and counts exactly the same candidates as the scalar walk.
+ */
+DISPATCH_KERNEL
+static inline uint64_t solve_walk_wheel(const SolveWalker *w, uint64_t n, __uint128_t N,
+                                        uint64_t a_max, uint64_t a_floor32,
+                                        uint64_t a_floor63) {
+    uint64_t a = a_max;
+    uint64_t candidate = (uint64_t)((N - (__uint128_t)a * a) >> 1);
+    uint64_t delta = 2 * (a - 1);
+    uint64_t checks = 0;
+
+    if (solve_walk_small(w, &a, &candidate, &delta, &checks)) {
+        return solve_walk_done(w, a, checks);
+    }
+
+    trial_wheel_seek(w->wheel, n, a_max);
+
+    while (1) {
+        if (a <= a_floor63) return solve_walk_wide(w, N, a, checks);
+
+        /* The rest of the current 64-step window, stopping short of a_floor63 */
+        uint64_t step = (a_max - a) / 2;
+        uint64_t remaining = (a - 1) / 2 + 1;  /* Steps left, including this one */
+        uint64_t below63 = (a - a_floor63 - 1) / 2 + 1;
+        uint64_t first = step % WHEEL_STEPS;
+        uint64_t steps = WHEEL_STEPS - first;
+        if (remaining < steps) steps = remaining;
+        if (below63 < steps) steps = below63;
+
+        uint64_t mask = trial_wheel_survivors64(w->wheel, step / WHEEL_STEPS) >> first;
+        if (steps < WHEEL_STEPS) mask &= (1ULL << steps) - 1;
+#ifdef SEARCH_COUNTERS
+        const uint64_t mask0 = mask;
+#endif
+
+        while (mask) {
+            uint64_t i = (uint64_t)__builtin_ctzll(mask);
+            uint64_t c = candidate + i * delta - 2 * i * (i - 1);
+            if (solve_walk_survivor_prime(w, c, a - 2 * i > a_floor32)) {
+                SC_TD_WINDOW(w->thread_id, candidate, delta, mask0, i + 1);
+                return solve_walk_done(w, a - 2 * i, checks + i + 1);
+            }
+            mask &= mask - 1;
+        }
+
+        SC_TD_WINDOW(w->thread_id, candidate, delta, mask0, steps);
+        checks += steps;
+        if (remaining <= steps) return solve_walk_done(w, 0, checks);
+        candidate += steps * delta - 2 * steps * (steps - 1);
+        delta -= 4 * steps;
+        a -= 2 * steps;
+    }
+
+}
+
+/**
+ * Find a solution to 8n + 3 = a^2 + 2p
+ * a_floor32 / a_floor63 are solve_a_floor32() / solve_a_floor63() of the
+ * chunk. Returns the largest valid a, or 0 if no solution exists
+ * (counterexample). The walk's start a_max is stored in *a_max_out (for
+ * records.h).
+ */
+DISPATCH_KERNEL
+static inline uint64_t solve_walk(const SolveWalker *w, uint64_t n, uint64_t a_floor32,
+                                  uint64_t a_floor63, uint64_t *a_max_out) {
+    /* N needs 128 bits from n = 2^61 on; a_max and candidates fit 64 bits */
+    __uint128_t N = 8 * (__uint128_t)n + 3;
+    uint64_t a_max = solve_a_max128(N);
+    *a_max_out = a_max;
+
+    /* The wheel by default; vector trial division where the CPU has AVX-512 */
+    if (w->wheel) {
+        return solve_walk_wheel(w, n, N, a_max, a_floor32, a_floor63);
+    }
+    if (trial_vector_available()) {
+        return solve_walk_windowed(w, N, a_max, a_floor32, a_floor63);
+    }
+
+    uint64_t a = a_max;
+    uint64_t candidate = (uint64_t)((N - (__uint128_t)a * a) >> 1);
+    uint64_t delta = 2 * (a - 1);
+
+    while (1) {
+        if (a <= a_floor63) return solve_walk_wide(w, N, a, 0);
+
+        SC_INC(w->thread_id, a_steps);
+        if (candidate >= 2) {
+            w->stats->total_checks++;
+            SC_INC(w->thread_id, candidates);
+            if (solve_walk_candidate_prime(w, candidate, a > a_floor32)) {
+                return solve_walk_done(w, a, 0);
+            }
+        }
+
+        if (a < 3) return solve_walk_done(w, 0, 0);
+        candidate += delta;
+        delta -= 4;
+        a -= 2;
+    }
+}
+
+#endif /* SOLVE_WALK_H */
@@ -0,0 +1,570 @@
+/*
+ * Spool Directory: Work Units, Leases and Results for Worker Fleets
+ *
+ * A long campaign is split into work units that live as files in a spool
+ * directory. Workers (search --spool-work DIR), on one host or on several
+ * sharing the filesystem, claim units, search them and publish results;
+ * no server or job scheduler is involved:
+ *
+ *   DIR/spool.conf                 range, unit count, lease length
+ *   DIR/queue/<unit>               units waiting for a worker
+ *   DIR/leases/<unit>@<worker>     units being searched by <worker>
+ *   DIR/done/<unit>.csv            published results (--results CSV format)
+ *
+ * <unit> is "<lo>-<hi>" with both bounds as 20-digit decimals, so names
+ * sort like the ranges; the units are shard_bounds() pieces of equal
+ * estimated cost. <worker> is "<host>.<pid>".
+ *
+ * Protocol (every step is a single rename or unlink, atomic on a local
+ * filesystem and on NFS):
+ *
+ *   claim    rename queue/<unit> -> leases/<unit>@<worker>. Of several
+ *            workers racing for a unit exactly one rename succeeds; the
+ *            others get ENOENT and try the next unit.
+ *   renew    a keeper thread sets the lease file's mtime to now every
+ *            lease/SPOOL_RENEW_FRACTION seconds while the unit runs.
+ *   publish  results are written to done/<unit>.csv.<worker>.tmp, synced
+ *            and renamed to done/<unit>.csv; then the lease is unlinked.
+ *   requeue  a lease whose newest of mtime and ctime (rename updates the
+ *            ctime) is older than the lease length belonged to a crashed
+ *            or stalled worker: it is renamed back to queue/<unit>, or
+ *            unlinked if the unit was published meanwhile. Workers do this
+ *            when the queue runs dry, and so does --spool-coordinate.
+ *   release  a worker stopped by SIGINT/SIGTERM renames its lease back to
+ *            the queue at once instead of waiting for expiry.
+ *
+ * Publishing is idempotent: if a lease expired while its worker was only
+ * slow, the unit may be searched twice and done/<unit>.csv is replaced by
+ * an equivalent file. A claimed unit whose results already exist is
+ * dropped. Temporary files of crashed workers stay in done/ until the
+ * coordinator sees every unit published. Lease ages compare file times
+ * with the local clock, so hosts sharing a spool need synchronized clocks
+ * (NTP) and a lease length well above their skew.
+ *
+ * The done/ files of a finished campaign combine with the merge tool:
+ *
+ *   ./merge --range START END DIR/done/[0-9]*.csv
+ *
+ * Requires POSIX (rename, utimensat, fsync, readdir) and POSIX threads:
+ * define _GNU_SOURCE or _POSIX_C_SOURCE 200809L before including and link
+ * with -pthread.
+ */
+
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "shard.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define SPOOL_VERSION 1
+
+/* Default number of work units */
+#define SPOOL_DEFAULT_UNITS 1000
+
+/* Default lease length in seconds (a unit should take well under this) */
+#define SPOOL_DEFAULT_LEASE 300.0
+
+/* Leases are renewed SPOOL_RENEW_FRACTION times per lease length */
+#define SPOOL_RENEW_FRACTION 4
+
+/* Longest path built inside the spool directory */
+#define SPOOL_PATH_MAX 4096
+
+/* "<20 digits>-<20 digits>" plus NUL */
+#define SPOOL_UNIT_MAX 42
+
+/* ========================================================================== */
+/* Data Structures                                                            */
+/* ========================================================================== */
+
+typedef struct {
+    uint64_t n_start;           /* Campaign range */
+    uint64_t n_end;
+    uint32_t units;             /* Number of work units */
+    double lease_seconds;       /* Lease length */
+} SpoolConfig;
+
+/* A unit claimed by this worker */
+typedef struct {
+    char unit[SPOOL_UNIT_MAX];
+    uint64_t lo;
+    uint64_t hi;
+    char lease_path[SPOOL_PATH_MAX];
+} SpoolClaim;
+
+typedef struct {
+    int queued;
+    int leased;
+    int expired;                /* Leases requeued by this call */
+    int done;
+} SpoolStatus;
+
+/* Keeps one lease alive from a background thread */
+typedef struct {
+    const char *path;
+    double interval;            /* Seconds between renewals */
+    pthread_t thread;
+    bool running;
+    pthread_mutex_t lock;       /* Guards stop and lost */
+    pthread_cond_t wake;
+    bool stop;
+    bool lost;                  /* Lease file vanished (requeued by another) */
+} SpoolLease;
+
+/* ========================================================================== */
+/* Paths and Names                                                            */
+/* ========================================================================== */
+
+/* "<dir>/<sub>/<name><suffix>" into buf; false if it does not fit */
+static inline bool spool_path(char *buf, const char *dir, const char *sub,
+                              const char *name, const char *suffix) {
+    int len = snprintf(buf, SPOOL_PATH_MAX, "%s/%s%s%s%s", dir, sub,
+                       name[0] ? "/" : "", name, suffix);
+    return len > 0 && len < SPOOL_PATH_MAX;
+}
+
+static inline void spool_unit_name(char buf[SPOOL_UNIT_MAX], uint64_t lo, uint64_t hi) {
+    snprintf(buf, SPOOL_UNIT_MAX, "%020llu-%020llu",
+             (unsigned long long)lo, (unsigned long long)hi);
+}
+
+/* Parse a unit name (optionally followed by '@' or '.'); false if not one */
+static inline bool spool_parse_unit(const char *name, uint64_t *lo, uint64_t *hi) {
+    char *dash, *end;
+    if (name[0] < '0' || name[0] > '9') return false;
+    *lo = strtoull(name, &dash, 10);
+    if (*dash != '-' || dash - name != 20) return false;
+    *hi = strtoull(dash + 1, &end, 10);
+    if (end - dash - 1 != 20 || (*end != '\0' && *end != '@' && *end != '.')) return false;
+    return *lo < *hi;
+}
+
+/* "<host>.<pid>" of this process */
+static inline void spool_worker_id(char *buf, size_t size) {
+    char host[256];
+    if (gethostname(host, sizeof(host)) != 0) snprintf(host, sizeof(host), "host");
+    host[sizeof(host) - 1] = '\0';
+    for (char *c = host; *c; c++) {
+        if (*c == '/' || *c == '@') *c = '_';
+    }
+    snprintf(buf, size, "%s.%ld", host, (long)getpid());
+}
+
+/* ========================================================================== */
+/* Directory Listing                                                          */
+/* ========================================================================== */
+
+static int spool_name_cmp(const void *x, const void *y) {
+    return strcmp(*(char *const *)x, *(char *const *)y);
+}
+
+static inline void spool_free_names(char **names, int count) {
+    for (int i = 0; i < count; i++) free(names[i]);
+    free(names);
+}
+
+/**
+ * Sorted entries of dir/sub that start with a unit name (malloc'd; free
+ * with spool_free_names). Returns NULL with *count = -1 on error.
+ */
+static inline char** spool_list(const char *dir, const char *sub, int *count) {
+    char path[SPOOL_PATH_MAX];
+    *count = -1;
+    if (!spool_path(path, dir, sub, "", "")) return NULL;
+    DIR *d = opendir(path);
+    if (!d) return NULL;
+
+    char **names = NULL;
+    int num = 0, cap = 0;
+    struct dirent *e;
+    bool ok = true;
+    while (ok && (e = readdir(d)) != NULL) {
+        uint64_t lo, hi;
+        if (!spool_parse_unit(e->d_name, &lo, &hi)) continue;
+        if (num == cap) {
+            cap = cap ? 2 * cap : 64;
+            char **grown = (char **)realloc(names, (size_t)cap * sizeof(char *));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            names = grown;
+        }
+        names[num] = strdup(e->d_name);
+        ok = names[num] != NULL;
+        if (ok) num++;
+    }
+    closedir(d);
+    if (!ok) {
+        spool_free_names(names, num);
+        return NULL;
+    }
+    if (num > 1) qsort(names, (size_t)num, sizeof(char *), spool_name_cmp);
+    *count = num;
+    return names ? names : (char **)calloc(1, sizeof(char *));
+}
+
+/* ========================================================================== */
+/* Spool Creation / Configuration                                             */
+/* ========================================================================== */
+
+/**
+ * Create the spool directory with up to cfg->units units of equal estimated
+ * cost over the range (fewer if some would be empty; cfg->units is set to
+ * the number created). spool.conf is written last (atomically), so a spool
+ * without it is incomplete. Returns false and sets *err on failure,
+ * including when dir already holds a spool.
+ */
+static inline bool spool_create(const char *dir, SpoolConfig *cfg, const char **err) {
+    char path[SPOOL_PATH_MAX], tmp[SPOOL_PATH_MAX];
+    *err = "path too long";
+    if (!spool_path(path, dir, "spool.conf", "", "") ||
+        !spool_path(tmp, dir, "spool.conf", "", ".tmp")) {
+        return false;
+    }
+    if (access(path, F_OK) == 0) {
+        *err = "already a spool directory";
+        return false;
+    }
+
+    *err = "cannot create directories";
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return false;
+    const char *subs[] = {"queue", "leases", "done"};
+    for (int i = 0; i < 3; i++) {
+        char sub[SPOOL_PATH_MAX];
+        if (!spool_path(sub, dir, subs[i], "", "")) return false;
+        if (mkdir(sub, 0777) != 0 && errno != EEXIST) return false;
+    }
+
+    *err = "cannot create unit files";
+    uint32_t made = 0;
+    for (uint32_t i = 1; i <= cfg->units; i++) {
+        uint64_t lo, hi;
+        shard_bounds(cfg->n_start, cfg->n_end, i, cfg->units, &lo, &hi);
+        if (lo >= hi) continue;
+        char unit[SPOOL_UNIT_MAX], unit_path[SPOOL_PATH_MAX];
+        spool_unit_name(unit, lo, hi);
+        if (!spool_path(unit_path, dir, "queue", unit, "")) return false;
+        int fd = open(unit_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0) return false;
+        close(fd);
+        made++;
+    }
+    cfg->units = made;
+
+    *err = "cannot write spool.conf";
+    FILE *f = fopen(tmp, "w");
+    if (!f) return false;
+    fprintf(f, "# 8n+3 search spool\n");
+    fprintf(f, "version %d\n", SPOOL_VERSION);
+    fprintf(f, "range %llu %llu\n",
+            (unsigned long long)cfg->n_start, (unsigned long long)cfg->n_end);
+    fprintf(f, "units %u\n", cfg->units);
+    fprintf(f, "lease %.0f\n", cfg->lease_seconds);
+    fprintf(f, "end\n");
+    bool ok = (fflush(f) == 0) && (fsync(fileno(f)) == 0);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Load dir/spool.conf. Returns false if it is missing or malformed.
+ */
+static inline bool spool_load_config(const char *dir, SpoolConfig *cfg) {
+    char path[SPOOL_PATH_MAX];
+    if (!spool_path(path, dir, "spool.conf", "", "")) return false;
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    memset(cfg, 0, sizeof(*cfg));
+    char line[256];
+    bool have_range = false, have_end = false;
+    int version = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long a, b;
+        unsigned u;
+        double secs;
+
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (strncmp(line, "end", 3) == 0) {
+            have_end = true;
+            break;
+        } else if (sscanf(line, "version %d", &version) == 1) {
+            if (version != SPOOL_VERSION) break;
+        } else if (sscanf(line, "range %llu %llu", &a, &b) == 2) {
+            cfg->n_start = a;
+            cfg->n_end = b;
+            have_range = true;
+        } else if (sscanf(line, "units %u", &u) == 1) {
+            cfg->units = u;
+        } else if (sscanf(line, "lease %lf", &secs) == 1) {
+            cfg->lease_seconds = secs;
+        } else {
+            break;
+        }
+    }
+    fclose(f);
+    return have_range && have_end && version == SPOOL_VERSION &&
+           cfg->n_start < cfg->n_end && cfg->lease_seconds > 0;
+}
+
+/* ========================================================================== */
+/* Claim / Publish / Release                                                  */
+/* ========================================================================== */
+
+static inline bool spool_is_done(const char *dir, const char *unit) {
+    char path[SPOOL_PATH_MAX];
+    return spool_path(path, dir, "done", unit, ".csv") && access(path, F_OK) == 0;
+}
+
+/* Set the lease's mtime to now; false if the lease file is gone */
+static inline bool spool_touch(const char *lease_path) {
+    return utimensat(AT_FDCWD, lease_path, NULL, 0) == 0;
+}
+
+/**
+ * Claim the lowest queued unit for worker. Returns false when the queue is
+ * empty (or unreadable); units already published are dropped on the way.
+ */
+static inline bool spool_claim(const char *dir, const char *worker, SpoolClaim *claim) {
+    int count;
+    char **names = spool_list(dir, "queue", &count);
+    if (!names) return false;
+
+    char suffix[SPOOL_PATH_MAX];
+    snprintf(suffix, sizeof(suffix), "@%s", worker);
+    bool claimed = false;
+    for (int i = 0; i < count && !claimed; i++) {
+        char from[SPOOL_PATH_MAX];
+        if (!spool_path(from, dir, "queue", names[i], "") ||
+            !spool_path(claim->lease_path, dir, "leases", names[i], suffix)) {
+            continue;
+        }
+        if (rename(from, claim->lease_path) != 0) continue;     /* Lost the race */
+        if (spool_is_done(dir, names[i])) {
+            unlink(claim->lease_path);      /* Requeued after it was published */
+            continue;
+        }
+        spool_touch(claim->lease_path);     /* The unit file's mtime is old */
+        snprintf(claim->unit, sizeof(claim->unit), "%s", names[i]);
+        spool_parse_unit(names[i], &claim->lo, &claim->hi);
+        claimed = true;
+    }
+    spool_free_names(names, count);
+    return claimed;
+}
+
+/* Temporary results path of worker for the claimed unit */
+static inline bool spool_results_tmp(char *buf, const char *dir, const SpoolClaim *claim,
+                                     const char *worker) {
+    char suffix[SPOOL_PATH_MAX];
+    snprintf(suffix, sizeof(suffix), ".csv.%s.tmp", worker);
+    return spool_path(buf, dir, "done", claim->unit, suffix);
+}
+
+/**
+ * Publish the results written to tmp_path (sync, rename into done/) and
+ * drop the lease. Returns false if the results cannot be published.
+ */
+static inline bool spool_publish(const char *dir, const SpoolClaim *claim,
+                                 const char *tmp_path) {
+    char path[SPOOL_PATH_MAX];
+    if (!spool_path(path, dir, "done", claim->unit, ".csv")) return false;
+    int fd = open(tmp_path, O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp_path, path) != 0) return false;
+    unlink(claim->lease_path);      /* ENOENT if requeued meanwhile: harmless */
+    return true;
+}
+
+/**
+ * Give the claimed unit back to the queue (interrupted worker)
+ */
+static inline void spool_release(const char *dir, const SpoolClaim *claim) {
+    char path[SPOOL_PATH_MAX];
+    if (spool_path(path, dir, "queue", claim->unit, "")) {
+        rename(claim->lease_path, path);
+    }
+}
+
+/* ========================================================================== */
+/* Lease Expiry and Status                                                    */
+/* ========================================================================== */
+
+/**
+ * Requeue the expired leases and count the units in each state.
+ * Returns false if the spool cannot be read.
+ */
+static inline bool spool_scan(const char *dir, double lease_seconds, SpoolStatus *st) {
+    memset(st, 0, sizeof(*st));
+    int count;
+    char **names = spool_list(dir, "leases", &count);
+    if (!names) return false;
+
+    time_t now = time(NULL);
+    for (int i = 0; i < count; i++) {
+        char lease[SPOOL_PATH_MAX], queued[SPOOL_PATH_MAX];
+        struct stat sb;
+        char unit[SPOOL_UNIT_MAX];
+        snprintf(unit, sizeof(unit), "%.*s", SPOOL_UNIT_MAX - 1, names[i]);
+        if (!spool_path(lease, dir, "leases", names[i], "") ||
+            !spool_path(queued, dir, "queue", unit, "") ||
+            stat(lease, &sb) != 0) {
+            continue;
+        }
+        time_t touched = sb.st_mtime > sb.st_ctime ? sb.st_mtime : sb.st_ctime;
+        if (difftime(now, touched) <= lease_seconds) {
+            st->leased++;
+            continue;
+        }
+        if (spool_is_done(dir, unit)) {
+            unlink(lease);
+        } else if (rename(lease, queued) == 0) {
+            st->expired++;
+        }
+    }
+    spool_free_names(names, count);
+
+    names = spool_list(dir, "queue", &count);
+    if (!names) return false;
+    st->queued = count;
+    spool_free_names(names, count);
+
+    /* Published units: names ending in exactly ".csv" */
+    names = spool_list(dir, "done", &count);
+    if (!names) return false;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i] + SPOOL_UNIT_MAX - 1, ".csv") == 0) st->done++;
+    }
+    spool_free_names(names, count);
+    return true;
+}
+
+/**
+ * Number of counterexample rows in the published results
+ */
+static inline uint64_t spool_count_counterexamples(const char *dir) {
+    int count;
+    char **names = spool_list(dir, "done", &count);
+    if (!names) return 0;
+    uint64_t found = 0;
+    for (int i = 0; i < count; i++) {
+        char path[SPOOL_PATH_MAX], line[512];
+        if (strcmp(names[i] + SPOOL_UNIT_MAX - 1, ".csv") != 0 ||
+            !spool_path(path, dir, "done", names[i], "")) {
+            continue;
+        }
+        FILE *f = fopen(path, "r");
+        if (!f) continue;
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "counterexample,", 15) == 0) found++;
+        }
+        fclose(f);
+    }
+    spool_free_names(names, count);
+    return found;
+}
+
+/**
+ * Remove the temporary results files that crashed workers left in done/.
+ * Returns the number removed.
+ */
+static inline int spool_remove_stale(const char *dir) {
+    int count, removed = 0;
+    char **names = spool_list(dir, "done", &count);
+    if (!names) return 0;
+    for (int i = 0; i < count; i++) {
+        char path[SPOOL_PATH_MAX];
+        size_t len = strlen(names[i]);
+        if (len > 4 && strcmp(names[i] + len - 4, ".tmp") == 0 &&
+            spool_path(path, dir, "done", names[i], "") && unlink(path) == 0) {
+            removed++;
+        }
+    }
+    spool_free_names(names, count);
+    return removed;
+}
+
+/* ========================================================================== */
+/* Lease Keeper Thread                                                        */
+/* ========================================================================== */
+
+static void *spool_lease_run(void *arg) {
+    SpoolLease *l = (SpoolLease *)arg;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    pthread_mutex_lock(&l->lock);
+    while (1) {
+        long ms = (long)(l->interval * 1000.0);
+        deadline.tv_sec += ms / 1000;
+        deadline.tv_nsec += (ms % 1000) * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        int rc = 0;
+        while (!l->stop && rc == 0) {
+            rc = pthread_cond_timedwait(&l->wake, &l->lock, &deadline);
+        }
+        if (l->stop) break;
+        if (!spool_touch(l->path) && errno == ENOENT) l->lost = true;
+    }
+    pthread_mutex_unlock(&l->lock);
+    return NULL;
+}
+
+/**
+ * Renew the lease at path every lease_seconds / SPOOL_RENEW_FRACTION until
+ * spool_lease_stop(). If the thread cannot be started the lease is only
+ * set once, at claim time.
+ */
+static inline void spool_lease_start(SpoolLease *l, const char *path, double lease_seconds) {
+    memset(l, 0, sizeof(*l));
+    l->path = path;
+    l->interval = lease_seconds / SPOOL_RENEW_FRACTION;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&l->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&l->lock, NULL);
+    l->running = pthread_create(&l->thread, NULL, spool_lease_run, l) == 0;
+}
+
+/**
+ * Stop renewing. Returns false if the lease was found requeued meanwhile
+ * (another worker may be searching the same unit).
+ */
+static inline bool spool_lease_stop(SpoolLease *l) {
+    pthread_mutex_lock(&l->lock);
+    l->stop = true;
+    pthread_cond_signal(&l->wake);
+    pthread_mutex_unlock(&l->lock);
+    if (l->running) pthread_join(l->thread, NULL);
+    pthread_cond_destroy(&l->wake);
+    pthread_mutex_destroy(&l->lock);
+    return !l->lost;
+}
+
+#endif /* SPOOL_H */
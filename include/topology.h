@@ -0,0 +1,409 @@
+/*
+ * CPU Topology, Thread Placement and CPU Quota (Linux)
+ *
+ * Scaling measurements are only comparable if thread k always lands on the
+ * same kind of CPU, and a long search should neither share a core between
+ * two threads while another core idles nor start more threads than its
+ * container may run. topology_detect() reads the package, core and NUMA node
+ * of every CPU the process may run on (sched_getaffinity, sysfs) and the
+ * cgroup v2 CPU quota, and orders the CPUs for pinning:
+ *
+ *   1. one CPU per physical core, by package, then core id
+ *   2. the remaining SMT siblings, in the same order
+ *
+ * so thread counts up to the number of physical cores never share a core,
+ * and the SMT gain shows up separately beyond that. topology_set_affinity()
+ * replaces this order by one of the --affinity policies of search.c:
+ *
+ *   compact     all SMT siblings of a core, then the next core; packages
+ *               (and so NUMA nodes) are filled one after another
+ *   scatter     one CPU per core first, round-robin across packages, then
+ *               the siblings in the same way
+ *   cores-only  one CPU per physical core, no SMT siblings
+ *
+ * Pin slot k is order[k % num_slots]; order_node[k] is the NUMA node of that
+ * CPU as a dense index in [0, num_nodes), for placing per-node data.
+ *
+ * cpu_quota is the tightest cpu.max (quota / period) of the process's cgroup
+ * and its ancestors, in CPUs. A container limited to 2.5 CPUs on a 64-CPU
+ * host gets topology_default_threads() = 3 instead of 64 threads that the
+ * CFS bandwidth controller would throttle in turn.
+ *
+ * Where sysfs is unavailable every CPU counts as its own core on node 0; on
+ * non-Linux systems the online CPUs are taken in order and pinning is a
+ * no-op.
+ *
+ * Requires the GNU CPU_SET API: define _GNU_SOURCE before including.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+/* ========================================================================== */
+/* Data Structure                                                             */
+/* ========================================================================== */
+
+#define TOPOLOGY_MAX_CPUS  1024
+#define TOPOLOGY_MAX_NODES 64
+
+typedef enum {
+    TOPOLOGY_DEFAULT = 0,               /* Cores first, then siblings (package-major) */
+    TOPOLOGY_COMPACT,
+    TOPOLOGY_SCATTER,
+    TOPOLOGY_CORES_ONLY
+} TopologyAffinity;
+
+typedef struct {
+    int cpu;                            /* Kernel CPU number */
+    int package;
+    int core;
+    int node;                           /* Dense NUMA node index */
+    bool first;                         /* Lowest-numbered CPU of its core */
+} TopologyCpu;
+
+typedef struct {
+    int num_cpus;                       /* CPUs available to this process */
+    int num_cores;                      /* Distinct physical cores among them */
+    int num_packages;                   /* Distinct packages (sockets) */
+    int num_nodes;                      /* Distinct NUMA nodes */
+    double cpu_quota;                   /* cgroup v2 cpu.max in CPUs, 0 = unlimited */
+    TopologyCpu cpus[TOPOLOGY_MAX_CPUS];    /* Sorted by package, core, CPU */
+    TopologyAffinity policy;            /* Policy of the current pin order */
+    int num_slots;                      /* Pin slots of the current policy */
+    int order[TOPOLOGY_MAX_CPUS];       /* Pin order (CPU numbers) */
+    int order_node[TOPOLOGY_MAX_CPUS];  /* NUMA node of each pin slot */
+} CpuTopology;
+
+/* ========================================================================== */
+/* Placement Policies                                                         */
+/* ========================================================================== */
+
+/**
+ * Parse an --affinity policy name. Returns false if unknown.
+ */
+static inline bool topology_parse_affinity(const char *name, TopologyAffinity *out) {
+    if (strcmp(name, "compact") == 0) {
+        *out = TOPOLOGY_COMPACT;
+    } else if (strcmp(name, "scatter") == 0) {
+        *out = TOPOLOGY_SCATTER;
+    } else if (strcmp(name, "cores-only") == 0) {
+        *out = TOPOLOGY_CORES_ONLY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static inline const char* topology_affinity_name(TopologyAffinity policy) {
+    switch (policy) {
+    case TOPOLOGY_COMPACT:    return "compact";
+    case TOPOLOGY_SCATTER:    return "scatter";
+    case TOPOLOGY_CORES_ONLY: return "cores-only";
+    default:                  return "cores first";
+    }
+}
+
+/**
+ * Replace the pin order of t by that of policy
+ */
+static inline void topology_set_affinity(CpuTopology *t, TopologyAffinity policy) {
+    int n = t->num_cpus;
+    int pos = 0;
+
+    if (policy == TOPOLOGY_COMPACT || policy == TOPOLOGY_CORES_ONLY) {
+        /* Sorted order keeps siblings together and packages contiguous */
+        for (int k = 0; k < n; k++) {
+            if (policy == TOPOLOGY_CORES_ONLY && !t->cpus[k].first) continue;
+            t->order_node[pos] = t->cpus[k].node;
+            t->order[pos++] = t->cpus[k].cpu;
+        }
+    } else if (policy == TOPOLOGY_SCATTER) {
+        /*
+         * Rank every CPU within (pass, package), then emit by pass, rank and
+         * package: core 0 of each package, core 1 of each package, ...
+         */
+        int rank[TOPOLOGY_MAX_CPUS];
+        for (int k = 0; k < n; k++) {
+            rank[k] = 0;
+            for (int j = 0; j < k; j++) {
+                if (t->cpus[j].package == t->cpus[k].package &&
+                    t->cpus[j].first == t->cpus[k].first) {
+                    rank[k]++;
+                }
+            }
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            for (int r = 0; pos < n; r++) {
+                bool any = false;
+                for (int k = 0; k < n; k++) {
+                    if (t->cpus[k].first != (pass == 0) || rank[k] != r) continue;
+                    t->order_node[pos] = t->cpus[k].node;
+                    t->order[pos++] = t->cpus[k].cpu;
+                    any = true;
+                }
+                if (!any) break;
+            }
+        }
+    } else {
+        for (int pass = 0; pass < 2; pass++) {
+            for (int k = 0; k < n; k++) {
+                if (t->cpus[k].first != (pass == 0)) continue;
+                t->order_node[pos] = t->cpus[k].node;
+                t->order[pos++] = t->cpus[k].cpu;
+            }
+        }
+    }
+    t->num_slots = pos;
+    t->policy = policy;
+}
+
+/* ========================================================================== */
+/* Detection                                                                  */
+/* ========================================================================== */
+
+/* Read one integer from a sysfs file; -1 if missing */
+static inline int topology_read_int(int cpu, const char *name) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int value = -1;
+    if (fscanf(f, "%d", &value) != 1) value = -1;
+    fclose(f);
+    return value;
+}
+
+/* NUMA node of a CPU (the nodeN link in its sysfs directory); 0 if unknown */
+static inline int topology_read_node(int cpu) {
+#ifdef __linux__
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+    int node = 0;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) {
+        if (strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' &&
+            e->d_name[4] <= '9') {
+            node = atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+/*
+ * Tightest cgroup v2 cpu.max along the process's cgroup path, in CPUs;
+ * 0 if there is no limit (or no cgroup v2 hierarchy)
+ */
+static inline double topology_read_cpu_quota(void) {
+#ifdef __linux__
+    /* The unified hierarchy is the "0::" line */
+    char cgroup[512] = "";
+    FILE *f = fopen("/proc/self/cgroup", "r");
+    if (!f) return 0.0;
+    char line[640];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            snprintf(cgroup, sizeof(cgroup), "%.511s", line + 3);
+            cgroup[strcspn(cgroup, "\n")] = '\0';
+            break;
+        }
+    }
+    fclose(f);
+    if (cgroup[0] != '/') return 0.0;
+
+    /* Pure v2 mounts it at /sys/fs/cgroup, hybrid setups at .../unified */
+    static const char *const mounts[] = {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"};
+    double quota = 0.0;
+    for (int m = 0; m < 2 && quota == 0.0; m++) {
+        char dir[512];
+        snprintf(dir, sizeof(dir), "%s", cgroup);
+        while (1) {
+            char path[1100];
+            snprintf(path, sizeof(path), "%s%s/cpu.max", mounts[m],
+                     strcmp(dir, "/") == 0 ? "" : dir);
+            f = fopen(path, "r");
+            if (f) {
+                char max[32];
+                long long period = 0;
+                if (fscanf(f, "%31s %lld", max, &period) == 2 &&
+                    strcmp(max, "max") != 0 && period > 0) {
+                    double cpus = (double)atoll(max) / (double)period;
+                    if (cpus > 0 && (quota == 0.0 || cpus < quota)) quota = cpus;
+                }
+                fclose(f);
+            }
+            char *slash = strrchr(dir, '/');
+            if (!slash || slash == dir) {
+                if (strcmp(dir, "/") == 0) break;
+                strcpy(dir, "/");
+            } else {
+                *slash = '\0';
+            }
+        }
+    }
+    return quota;
+#else
+    return 0.0;
+#endif
+}
+
+/**
+ * Fill t with the CPUs this process may run on, their NUMA nodes and the
+ * CPU quota; the pin order is the default (cores first, then siblings)
+ */
+static inline void topology_detect(CpuTopology *t) {
+    int cpus[TOPOLOGY_MAX_CPUS];
+    int package[TOPOLOGY_MAX_CPUS], core[TOPOLOGY_MAX_CPUS], node[TOPOLOGY_MAX_CPUS];
+    int n = 0;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE && c < TOPOLOGY_MAX_CPUS; c++) {
+            if (CPU_ISSET(c, &set)) cpus[n++] = c;
+        }
+    }
+#endif
+    if (n == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        if (online < 1) online = 1;
+        if (online > TOPOLOGY_MAX_CPUS) online = TOPOLOGY_MAX_CPUS;
+        for (int c = 0; c < online; c++) cpus[n++] = c;
+    }
+
+    for (int i = 0; i < n; i++) {
+        package[i] = topology_read_int(cpus[i], "physical_package_id");
+        core[i] = topology_read_int(cpus[i], "core_id");
+        node[i] = topology_read_node(cpus[i]);
+        if (package[i] < 0) package[i] = 0;
+        if (core[i] < 0) core[i] = cpus[i];     /* Unknown: its own core */
+    }
+
+    /* Stable sort of CPU indices by (package, core); ties keep CPU order */
+    int idx[TOPOLOGY_MAX_CPUS];
+    for (int i = 0; i < n; i++) {
+        int j = i;
+        while (j > 0 && (package[idx[j - 1]] > package[i] ||
+                         (package[idx[j - 1]] == package[i] && core[idx[j - 1]] > core[i]))) {
+            idx[j] = idx[j - 1];
+            j--;
+        }
+        idx[j] = i;
+    }
+
+    /* Mark the first CPU of each core; number the NUMA nodes densely */
+    int node_ids[TOPOLOGY_MAX_NODES];
+    int cores = 0, packages = 0, nodes = 0;
+    for (int k = 0; k < n; k++) {
+        int i = idx[k];
+        bool new_package = k == 0 || package[idx[k - 1]] != package[i];
+        TopologyCpu *c = &t->cpus[k];
+        c->cpu = cpus[i];
+        c->package = package[i];
+        c->core = core[i];
+        c->first = new_package || core[idx[k - 1]] != core[i];
+        if (new_package) packages++;
+        if (c->first) cores++;
+
+        int d = 0;
+        while (d < nodes && node_ids[d] != node[i]) d++;
+        if (d == nodes && nodes < TOPOLOGY_MAX_NODES) node_ids[nodes++] = node[i];
+        c->node = d < nodes ? d : 0;
+    }
+    t->num_cpus = n;
+    t->num_cores = cores;
+    t->num_packages = packages;
+    t->num_nodes = nodes > 0 ? nodes : 1;
+    t->cpu_quota = topology_read_cpu_quota();
+
+    topology_set_affinity(t, TOPOLOGY_DEFAULT);
+}
+
+/**
+ * Default thread count: one per pin slot, capped by the cgroup CPU quota
+ * (rounded up, so a 2.5-CPU quota runs 3 threads)
+ */
+static inline int topology_default_threads(const CpuTopology *t) {
+    int threads = t->num_slots;
+    if (t->cpu_quota > 0) {
+        int quota = (int)t->cpu_quota;
+        if (quota < t->cpu_quota) quota++;
+        if (quota < threads) threads = quota;
+    }
+    return threads > 0 ? threads : 1;
+}
+
+/* ========================================================================== */
+/* Pinning                                                                    */
+/* ========================================================================== */
+
+/**
+ * Pin the calling thread to CPU order[slot % num_slots].
+ * Returns false if the kernel refused (or on non-Linux systems).
+ */
+static inline bool topology_pin_thread(const CpuTopology *t, int slot) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(t->order[slot % t->num_slots], &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)t;
+    (void)slot;
+    return false;
+#endif
+}
+
+/**
+ * Physical cores used by the first num_threads pin slots
+ */
+static inline int topology_cores_used(const CpuTopology *t, int num_threads) {
+    if (num_threads > t->num_slots) num_threads = t->num_slots;
+    int cores = 0;
+    for (int s = 0; s < num_threads; s++) {
+        const TopologyCpu *c = NULL;
+        for (int k = 0; k < t->num_cpus && !c; k++) {
+            if (t->cpus[k].cpu == t->order[s]) c = &t->cpus[k];
+        }
+        bool seen = false;
+        for (int r = 0; r < s && !seen && c; r++) {
+            for (int k = 0; k < t->num_cpus; k++) {
+                if (t->cpus[k].cpu == t->order[r]) {
+                    seen = t->cpus[k].package == c->package && t->cpus[k].core == c->core;
+                    break;
+                }
+            }
+        }
+        if (!seen) cores++;
+    }
+    return cores;
+}
+
+/**
+ * NUMA node (dense index) of the CPU behind pin slot
+ */
+static inline int topology_slot_node(const CpuTopology *t, int slot) {
+    return t->order_node[slot % t->num_slots];
+}
+
+#endif /* TOPOLOGY_H */
@@ -0,0 +1,151 @@
+/*
+ * Vector Trial Division over 8 Steps of the a-Walk
+ *
+ * The a-walk visits candidates c_0, c_1, ... with c_{i+1} = c_i + delta_i,
+ * delta_{i+1} = delta_i - 4, i.e.  c_i = c_0 + i*delta_0 - 2*i*(i-1).
+ * td_survivors8() builds the next 8 candidates in one AVX-512 register and
+ * tests all 30 trial primes (3..127) on every lane without division:
+ *
+ *   q | c   <=>   c * q^-1 (mod 2^64) <= (2^64 - 1) / q      (q odd)
+ *
+ * One vpmullq + one compare per prime marks the lanes it divides; the
+ * result is the bitmask of steps that survive trial division. The walk
+ * then sends only the survivors, in order, to Miller-Rabin.
+ *
+ * Every candidate must be > 127 (a candidate equal to a trial prime would
+ * be reported as composite); the walk handles the few small candidates at
+ * the start of each n with the scalar trial_division_check().
+ *
+ * The AVX-512 kernel is compiled with target attributes and selected at
+ * run time; td_survivors8_scalar() is the portable equivalent.
+ */
+
+#ifndef TRIAL_VECTOR_H
+#define TRIAL_VECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TRIAL_VECTOR_SUPPORTED 1
+#include <immintrin.h>
+#else
+#define TRIAL_VECTOR_SUPPORTED 0
+#endif
+
+/* Steps tested per call */
+#define TD_STEPS 8
+
+/* ========================================================================== */
+/* Divisibility Constants                                                     */
+/* ========================================================================== */
+
+/* q^-1 mod 2^64 and floor((2^64 - 1) / q) for the 30 trial primes */
+static const struct { uint64_t inv; uint64_t lim; } TD_INVERSE[30] = {
+    {0xaaaaaaaaaaaaaaabULL, 0x5555555555555555ULL},  /* 3 */
+    {0xcccccccccccccccdULL, 0x3333333333333333ULL},  /* 5 */
+    {0x6db6db6db6db6db7ULL, 0x2492492492492492ULL},  /* 7 */
+    {0x2e8ba2e8ba2e8ba3ULL, 0x1745d1745d1745d1ULL},  /* 11 */
+    {0x4ec4ec4ec4ec4ec5ULL, 0x13b13b13b13b13b1ULL},  /* 13 */
+    {0xf0f0f0f0f0f0f0f1ULL, 0x0f0f0f0f0f0f0f0fULL},  /* 17 */
+    {0x86bca1af286bca1bULL, 0x0d79435e50d79435ULL},  /* 19 */
+    {0xd37a6f4de9bd37a7ULL, 0x0b21642c8590b216ULL},  /* 23 */
+    {0x34f72c234f72c235ULL, 0x08d3dcb08d3dcb08ULL},  /* 29 */
+    {0xef7bdef7bdef7bdfULL, 0x0842108421084210ULL},  /* 31 */
+    {0x14c1bacf914c1badULL, 0x06eb3e45306eb3e4ULL},  /* 37 */
+    {0x8f9c18f9c18f9c19ULL, 0x063e7063e7063e70ULL},  /* 41 */
+    {0x82fa0be82fa0be83ULL, 0x05f417d05f417d05ULL},  /* 43 */
+    {0x51b3bea3677d46cfULL, 0x0572620ae4c415c9ULL},  /* 47 */
+    {0x21cfb2b78c13521dULL, 0x04d4873ecade304dULL},  /* 53 */
+    {0xcbeea4e1a08ad8f3ULL, 0x0456c797dd49c341ULL},  /* 59 */
+    {0x4fbcda3ac10c9715ULL, 0x04325c53ef368eb0ULL},  /* 61 */
+    {0xf0b7672a07a44c6bULL, 0x03d226357e16ece5ULL},  /* 67 */
+    {0x193d4bb7e327a977ULL, 0x039b0ad12073615aULL},  /* 71 */
+    {0x7e3f1f8fc7e3f1f9ULL, 0x0381c0e070381c0eULL},  /* 73 */
+    {0x9b8b577e613716afULL, 0x033d91d2a2067b23ULL},  /* 79 */
+    {0xa3784a062b2e43dbULL, 0x03159721ed7e7534ULL},  /* 83 */
+    {0xf47e8fd1fa3f47e9ULL, 0x02e05c0b81702e05ULL},  /* 89 */
+    {0xa3a0fd5c5f02a3a1ULL, 0x02a3a0fd5c5f02a3ULL},  /* 97 */
+    {0x3a4c0a237c32b16dULL, 0x0288df0cac5b3f5dULL},  /* 101 */
+    {0xdab7ec1dd3431b57ULL, 0x027c45979c95204fULL},  /* 103 */
+    {0x77a04c8f8d28ac43ULL, 0x02647c69456217ecULL},  /* 107 */
+    {0xa6c0964fda6c0965ULL, 0x02593f69b02593f6ULL},  /* 109 */
+    {0x90fdbc090fdbc091ULL, 0x0243f6f0243f6f02ULL},  /* 113 */
+    {0x7efdfbf7efdfbf7fULL, 0x0204081020408102ULL},  /* 127 */
+};
+
+/* ========================================================================== */
+/* Portable Kernel                                                            */
+/* ========================================================================== */
+
+/**
+ * Bitmask of the first `steps` (<= 8) candidates starting at (candidate,
+ * delta) that no trial prime divides. Candidates must be > 127.
+ */
+static inline uint8_t td_survivors8_scalar(uint64_t candidate, uint64_t delta, int steps) {
+    uint8_t mask = 0;
+    for (int i = 0; i < steps; i++) {
+        bool survives = true;
+        for (int j = 0; j < 30; j++) {
+            if (candidate * TD_INVERSE[j].inv <= TD_INVERSE[j].lim) {
+                survives = false;
+                break;
+            }
+        }
+        if (survives) mask |= (uint8_t)(1u << i);
+        candidate += delta;
+        delta -= 4;
+    }
+    return mask;
+}
+
+/* ========================================================================== */
+/* AVX-512 Kernel                                                             */
+/* ========================================================================== */
+
+/**
+ * True if the CPU can run the AVX-512 kernel (AVX-512F + DQ for vpmullq).
+ */
+static inline bool trial_vector_available(void) {
+#if TRIAL_VECTOR_SUPPORTED
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+    }
+    return cached != 0;
+#else
+    return false;
+#endif
+}
+
+#if TRIAL_VECTOR_SUPPORTED
+__attribute__((target("avx512f,avx512dq")))
+static inline uint8_t td_survivors8_avx512(uint64_t candidate, uint64_t delta, int steps) {
+    /* c_i = c_0 + i*delta - 2*i*(i-1) */
+    const __m512i idx = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i tri = _mm512_set_epi64(84, 60, 40, 24, 12, 4, 0, 0);
+    __m512i c = _mm512_add_epi64(_mm512_set1_epi64((long long)candidate),
+                                 _mm512_mullo_epi64(idx, _mm512_set1_epi64((long long)delta)));
+    c = _mm512_sub_epi64(c, tri);
+
+    __mmask8 divisible = 0;
+    for (int j = 0; j < 30; j++) {
+        __m512i prod = _mm512_mullo_epi64(c, _mm512_set1_epi64((long long)TD_INVERSE[j].inv));
+        divisible |= _mm512_cmple_epu64_mask(prod, _mm512_set1_epi64((long long)TD_INVERSE[j].lim));
+    }
+    return (uint8_t)(~divisible & (uint8_t)((1u << steps) - 1));
+}
+#endif
+
+/**
+ * Dispatching entry point: survivors among the next `steps` (<= 8) steps.
+ */
+static inline uint8_t td_survivors8(uint64_t candidate, uint64_t delta, int steps) {
+#if TRIAL_VECTOR_SUPPORTED
+    if (trial_vector_available()) return td_survivors8_avx512(candidate, delta, steps);
+#endif
+    return td_survivors8_scalar(candidate, delta, steps);
+}
+
+#endif /* TRIAL_VECTOR_H */
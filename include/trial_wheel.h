@@ -0,0 +1,182 @@
+/*
+ * Table-Driven a-Walk Wheel for the Trial Primes 3-127
+ *
+ * For an odd prime q, the candidate p = (N - a^2) / 2 is divisible by q
+ * exactly when a^2 = N (mod q), i.e. a = +-s for a square root s of N mod
+ * q. The walk visits a_i = a_0 - 2i, so with h = (q + 1) / 2 (the inverse
+ * of 2 mod q) the steps with q | p are
+ *
+ *   i = (a_0 -+ s) h = A + R  (mod q),   A = a_0 h,  R = -+s h
+ *
+ * a pattern of period q fixed by two residues: N mod q (through R) and
+ * a_0 mod q (through A). The roots come from a table built once by
+ * trial_wheel_init(), not from Tonelli-Shanks per N as in the root-class
+ * sieve that failed.
+ *
+ * a_0 = a_max changes rarely (every ~sqrt(n / 2) n), so each thread keeps
+ * a TrialWheel with the 64-step skip mask of every residue of every q for
+ * its current a_0, rebuilt when a_0 changes, and N mod q, which grows by 8
+ * per n (one add and compare per q). The skip mask of the first 64 steps
+ * of an n is then one load and OR per prime. Later windows (walks longer
+ * than 64 steps are rare) are computed from the root table directly.
+ *
+ * The survivors are exactly those of trial division by 3-127, provided
+ * every candidate in the window is > 127 (a candidate equal to a trial
+ * prime would be reported as composite), as in trial_vector.h.
+ */
+
+#ifndef TRIAL_WHEEL_H
+#define TRIAL_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WHEEL_PRIMES 30
+#define WHEEL_STEPS 64                  /* Steps per mask */
+#define WHEEL_TABLE_SIZE 1718           /* Sum of the 30 primes */
+
+/* ========================================================================== */
+/* Tables                                                                     */
+/* ========================================================================== */
+
+static const uint8_t WHEEL_Q[WHEEL_PRIMES] = {
+    3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127
+};
+
+/* Start of each prime's residues in the tables (sum of the smaller primes) */
+static const uint16_t WHEEL_OFFSET[WHEEL_PRIMES] = {
+    0, 3, 8, 15, 26, 39, 56, 75, 98, 127, 158, 195, 236, 279, 326,
+    379, 438, 499, 566, 637, 710, 789, 872, 961, 1058, 1159, 1262, 1369, 1478, 1591
+};
+
+/* 8 mod q: N mod q grows by this per n */
+static const uint8_t WHEEL_N_STEP[WHEEL_PRIMES] = {
+    2, 3, 1, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+};
+
+/*
+ * Per prime q and residue r = N mod q: the phases R of the two roots in
+ * bits 0-7 and 8-15, and bit 16 set if r is a square mod q (for r = 0 the
+ * one root 0, twice). Filled by trial_wheel_init().
+ */
+static uint32_t wheel_phase[WHEEL_TABLE_SIZE];
+
+static bool wheel_ready = false;
+
+/**
+ * Build the root table (once, before the worker threads start)
+ */
+static inline void trial_wheel_init(void) {
+    if (wheel_ready) return;
+    for (int j = 0; j < WHEEL_PRIMES; j++) {
+        uint32_t q = WHEEL_Q[j], h = (q + 1) / 2;
+        uint32_t *phase = &wheel_phase[WHEEL_OFFSET[j]];
+        for (uint32_t r = 0; r < q; r++) phase[r] = 0;
+        for (uint32_t s = 0; s <= q / 2; s++) {
+            uint32_t r1 = (q - s) % q * h % q;      /* -s h */
+            uint32_t r2 = s * h % q;                /* +s h */
+            phase[s * s % q] = r1 | (r2 << 8) | (1u << 16);
+        }
+    }
+    wheel_ready = true;
+}
+
+/* Bits 0, q, 2q, ... below 64 */
+static inline uint64_t wheel_comb(uint32_t q) {
+    uint64_t comb = 0;
+    for (uint32_t i = 0; i < WHEEL_STEPS; i += q) comb |= 1ULL << i;
+    return comb;
+}
+
+/**
+ * Steps 0-63 with q | p, for phase table entry e and a-phase A < q
+ */
+static inline uint64_t wheel_pattern(uint32_t q, uint64_t comb, uint32_t e, uint32_t A) {
+    if (!(e >> 16)) return 0;
+    uint32_t k1 = A + (e & 0xFF);
+    uint32_t k2 = A + ((e >> 8) & 0xFF);
+    k1 = k1 >= q ? k1 - q : k1;
+    k2 = k2 >= q ? k2 - q : k2;
+    return (k1 < WHEEL_STEPS ? comb << k1 : 0) | (k2 < WHEEL_STEPS ? comb << k2 : 0);
+}
+
+/* ========================================================================== */
+/* Per-Thread State                                                           */
+/* ========================================================================== */
+
+typedef struct {
+    uint64_t skip[WHEEL_TABLE_SIZE];    /* Per (q, N mod q): steps with q | p */
+    uint64_t n;                         /* n of n_mod (UINT64_MAX: none) */
+    uint64_t a;                         /* a_0 of skip (0: none) */
+    uint8_t n_mod[WHEEL_PRIMES];        /* N mod q */
+    uint8_t a_phase[WHEEL_PRIMES];      /* a_0 h mod q */
+} TrialWheel;
+
+static inline void trial_wheel_reset(TrialWheel *w) {
+    w->n = UINT64_MAX;
+    w->a = 0;
+}
+
+/**
+ * Move the wheel to n, whose walk starts at a_0 (odd). The next n updates
+ * N mod q in place; a new a_0 rebuilds the skip masks (1718 of them).
+ */
+static inline void trial_wheel_seek(TrialWheel *w, uint64_t n, uint64_t a0) {
+    if (n == w->n + 1) {
+        for (int j = 0; j < WHEEL_PRIMES; j++) {
+            uint32_t r = w->n_mod[j] + (uint32_t)WHEEL_N_STEP[j];
+            w->n_mod[j] = (uint8_t)(r >= WHEEL_Q[j] ? r - WHEEL_Q[j] : r);
+        }
+    } else if (n != w->n) {
+        /* N mod q = (8 (n mod q) + 3) mod q */
+        for (int j = 0; j < WHEEL_PRIMES; j++) {
+            uint32_t q = WHEEL_Q[j];
+            w->n_mod[j] = (uint8_t)((8 * (uint32_t)(n % q) + 3) % q);
+        }
+    }
+    w->n = n;
+
+    if (a0 != w->a) {
+        for (int j = 0; j < WHEEL_PRIMES; j++) {
+            uint32_t q = WHEEL_Q[j];
+            uint32_t A = (uint32_t)(a0 % q) * ((q + 1) / 2) % q;
+            uint64_t comb = wheel_comb(q);
+            const uint32_t *phase = &wheel_phase[WHEEL_OFFSET[j]];
+            uint64_t *skip = &w->skip[WHEEL_OFFSET[j]];
+            w->a_phase[j] = (uint8_t)A;
+            for (uint32_t r = 0; r < q; r++) skip[r] = wheel_pattern(q, comb, phase[r], A);
+        }
+        w->a = a0;
+    }
+}
+
+/* ========================================================================== */
+/* Survivor Mask                                                              */
+/* ========================================================================== */
+
+/**
+ * Bitmask of the 64 steps starting `window` windows (64 steps each) after
+ * the walk's start a_0 (bit i: a_0 - 128 window - 2i) whose candidate no
+ * trial prime divides.
+ */
+static inline uint64_t trial_wheel_survivors64(const TrialWheel *w, uint64_t window) {
+    uint64_t divisible = 0;
+    if (window == 0) {
+        for (int j = 0; j < WHEEL_PRIMES; j++) {
+            divisible |= w->skip[WHEEL_OFFSET[j] + w->n_mod[j]];
+        }
+        return ~divisible;
+    }
+
+    /* The phase A drops by 64 per window */
+    for (int j = 0; j < WHEEL_PRIMES; j++) {
+        uint32_t q = WHEEL_Q[j];
+        uint32_t A = (w->a_phase[j] + q - (uint32_t)(WHEEL_STEPS * (window % q) % q)) % q;
+        divisible |= wheel_pattern(q, wheel_comb(q), wheel_phase[WHEEL_OFFSET[j] + w->n_mod[j]], A);
+    }
+    return ~divisible;
+}
+
+#endif /* TRIAL_WHEEL_H */
@@ -0,0 +1,14 @@
+/*
+ * Project Version
+ *
+ * The one place the release number is kept: ./search prints it and
+ * libsearch8n3 reports it (S8N3_VERSION, s8n3_version()). Bump it with
+ * each new CHANGELOG.md release; make test-lib fails while the two differ.
+ */
+
+#ifndef VERSION_H
+#define VERSION_H
+
+#define SEARCH8N3_VERSION "2.25.1"
+
+#endif /* VERSION_H */
@@ -0,0 +1,172 @@
+/*
+ * Dynamic Work Queue for Parallel Range Search
+ *
+ * Hands out [start, end) chunks of the n range from a shared atomic cursor.
+ * Threads that finish early simply claim another chunk, so heterogeneous
+ * cores (P/E cores, SMT siblings, noisy neighbours) no longer stretch the
+ * wall-clock time to that of the slowest thread.
+ *
+ * Chunk sizes are guided: each claim takes remaining / (GUIDED_FACTOR *
+ * num_threads) values, clamped to [min_chunk, max_chunk]. Early chunks are
+ * large (low claim overhead), the tail is split finely (low idle time).
+ *
+ * Cancellation is an atomic flag that workers poll with a relaxed load;
+ * once set, no further chunks are handed out.
+ *
+ * The queue can also serve a list of disjoint ranges (e.g. the unfinished
+ * parts of a resumed checkpoint). The cursor then walks the concatenation
+ * of the ranges and chunks never straddle a range boundary.
+ *
+ * Usage:
+ *   WorkQueue q;
+ *   work_queue_init(&q, n_start, n_end, num_threads);
+ *   uint64_t lo, hi;
+ *   while (work_queue_next(&q, &lo, &hi)) {
+ *       for (uint64_t n = lo; n < hi && !work_queue_cancelled(&q); n++) ...
+ *   }
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Smallest chunk handed out (~1-2 ms of work at 10^12) */
+#define WORK_QUEUE_MIN_CHUNK 4096
+
+/* Largest chunk handed out (bounds the work lost to a slow straggler) */
+#define WORK_QUEUE_MAX_CHUNK (1ULL << 22)
+
+/* Each claim takes 1 / (GUIDED_FACTOR * num_threads) of the remaining range */
+#define WORK_QUEUE_GUIDED_FACTOR 4
+
+/* ========================================================================== */
+/* Data Structure                                                             */
+/* ========================================================================== */
+
+/* Half-open range [lo, hi) of n values */
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+} WorkRange;
+
+typedef struct {
+    _Atomic uint64_t next;      /* First unclaimed offset into the ranges */
+    uint64_t n_end;             /* Total length of all ranges (cursor limit) */
+    const WorkRange *ranges;    /* Disjoint ranges, ascending (NULL = single) */
+    int num_ranges;
+    uint64_t single_start;      /* Start of the range when ranges == NULL */
+    uint64_t min_chunk;         /* Lower bound on chunk size */
+    uint64_t max_chunk;         /* Upper bound on chunk size */
+    uint64_t divisor;           /* GUIDED_FACTOR * num_threads */
+    _Atomic int cancelled;      /* Set once to stop all workers */
+} WorkQueue;
+
+/* ========================================================================== */
+/* API                                                                        */
+/* ========================================================================== */
+
+static inline void work_queue_init(WorkQueue *q, uint64_t n_start, uint64_t n_end,
+                                   int num_threads) {
+    atomic_init(&q->next, 0);
+    atomic_init(&q->cancelled, 0);
+    q->n_end = n_end - n_start;
+    q->ranges = NULL;
+    q->num_ranges = 0;
+    q->single_start = n_start;
+    q->min_chunk = WORK_QUEUE_MIN_CHUNK;
+    q->max_chunk = WORK_QUEUE_MAX_CHUNK;
+    q->divisor = (uint64_t)WORK_QUEUE_GUIDED_FACTOR * (num_threads > 0 ? num_threads : 1);
+}
+
+/**
+ * Initialize the queue over several disjoint ranges (ascending order).
+ * The ranges array must outlive the queue.
+ */
+static inline void work_queue_init_ranges(WorkQueue *q, const WorkRange *ranges,
+                                          int num_ranges, int num_threads) {
+    work_queue_init(q, 0, 0, num_threads);
+    q->ranges = ranges;
+    q->num_ranges = num_ranges;
+    for (int i = 0; i < num_ranges; i++) {
+        q->n_end += ranges[i].hi - ranges[i].lo;
+    }
+}
+
+/**
+ * Map a cursor offset to its n value and the offset at which its range ends.
+ */
+static inline uint64_t work_queue_locate(const WorkQueue *q, uint64_t offset,
+                                         uint64_t *range_end_offset) {
+    if (!q->ranges) {
+        *range_end_offset = q->n_end;
+        return q->single_start + offset;
+    }
+    uint64_t base = 0;
+    for (int i = 0; i < q->num_ranges; i++) {
+        uint64_t len = q->ranges[i].hi - q->ranges[i].lo;
+        if (offset < base + len) {
+            *range_end_offset = base + len;
+            return q->ranges[i].lo + (offset - base);
+        }
+        base += len;
+    }
+    *range_end_offset = q->n_end;
+    return 0;  /* Unreachable for offset < n_end */
+}
+
+/**
+ * Claim the next chunk. Returns false when the range is exhausted or the
+ * queue has been cancelled.
+ */
+static inline bool work_queue_next(WorkQueue *q, uint64_t *start, uint64_t *end) {
+    uint64_t cur = atomic_load_explicit(&q->next, memory_order_relaxed);
+
+    while (1) {
+        if (cur >= q->n_end) return false;
+        if (atomic_load_explicit(&q->cancelled, memory_order_relaxed)) return false;
+
+        uint64_t remaining = q->n_end - cur;
+        uint64_t size = remaining / q->divisor;
+        if (size < q->min_chunk) size = q->min_chunk;
+        if (size > q->max_chunk) size = q->max_chunk;
+        if (size > remaining) size = remaining;
+
+        /* Never hand out a chunk that straddles two ranges */
+        uint64_t range_end;
+        uint64_t n = work_queue_locate(q, cur, &range_end);
+        if (cur + size > range_end) size = range_end - cur;
+
+        if (atomic_compare_exchange_weak_explicit(&q->next, &cur, cur + size,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            *start = n;
+            *end = n + size;
+            return true;
+        }
+        /* cur was reloaded by the failed CAS - retry */
+    }
+}
+
+/**
+ * Stop all workers: no further chunks are handed out and
+ * work_queue_cancelled() returns true from now on.
+ */
+static inline void work_queue_cancel(WorkQueue *q) {
+    atomic_store_explicit(&q->cancelled, 1, memory_order_relaxed);
+}
+
+/**
+ * Poll for cancellation (a plain load on x86/ARM; cheap enough per n).
+ */
+static inline bool work_queue_cancelled(WorkQueue *q) {
+    return atomic_load_explicit(&q->cancelled, memory_order_relaxed) != 0;
+}
+
+#endif /* WORK_QUEUE_H */
@@ -0,0 +1,538 @@
+/*
+ * Shard Merge: Coverage Check and Combined Summary
+ *
+ * Reads the --results CSV files of the shards of one search (search or
+ * search_batched with --shard i/k, or any runs over disjoint ranges) and
+ *
+ *   - checks that the chunk rows cover the expected range exactly once:
+ *     every n in it is in exactly one chunk, with no gap and no overlap
+ *   - drops the chunk rows a resumed run redid: rows of a run that was
+ *     killed before its checkpoint covered them (the checkpoint is saved
+ *     every --checkpoint-interval seconds, chunk rows as chunks finish).
+ *     Within one run chunks are disjoint and a resumed run appends to the
+ *     file, so an earlier row that later rows of the same file cover
+ *     completely was redone; it counts neither for coverage nor in the
+ *     statistics. Overlaps between files, or partial ones, are errors
+ *   - sums the chunk statistics and the run times of the summary rows
+ *   - lists counterexamples and merges the top-K record tables
+ *
+ * The expected range is --range START END, or else the span of the files'
+ * summary rows (each summary covers its shard's range). A missing shard
+ * at either end of the range therefore only shows up with --range.
+ *
+ * With --output FILE the combined results are written in the same CSV
+ * format: all chunk rows sorted by n, the counterexamples, one summary row
+ * for the whole range (thread = sum of the runs' thread counts, seconds =
+ * sum of their wall times) and the merged record tables.
+ *
+ * Only local files are read; shards are gathered by whatever copies them.
+ *
+ * Compile: make merge
+ * Usage:   ./merge [--range START END] [--output FILE] FILE...
+ *
+ * Exit codes: 0 range covered exactly once, 1 coverage error or bad input,
+ *             2 counterexample listed in any file
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* pthreads (result_log.h) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fmt.h"
+#include "records.h"
+#include "result_log.h"     /* CSV row format and writer */
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+/* Gaps and overlaps printed individually (all are counted) */
+#define MERGE_MAX_LISTED 10
+
+/* CSV columns: type,thread,n_lo,n_hi,n_processed,checks,sieve_hits,
+   sieve_misses,counterexamples,start_s,seconds,a,p,steps */
+#define MERGE_COLUMNS 14
+
+/* ========================================================================== */
+/* Data                                                                       */
+/* ========================================================================== */
+
+typedef struct {
+    ResultRecord *rows;
+    size_t count;
+    size_t capacity;
+} RowList;
+
+/* A chunk row and where it came from */
+typedef struct {
+    ResultRecord row;
+    int file;                   /* Index of the file it was read from */
+    size_t seq;                 /* Order read: later rows, later runs */
+    bool redone;                /* Covered by later rows of its file */
+} MergeChunk;
+
+typedef struct {
+    MergeChunk *rows;
+    size_t count;
+    size_t capacity;
+} ChunkList;
+
+typedef struct {
+    ChunkList chunks;
+    RowList counterexamples;
+    NRecord *candidates;        /* Record rows of all files (n may repeat) */
+    size_t num_candidates;
+    size_t cap_candidates;
+    RecordTracker records;      /* Merged from the candidates */
+    CheckpointStats stats;      /* Sum over the chunk rows not redone */
+    uint64_t redone;            /* Chunk rows redone by a resumed run */
+    uint64_t range_lo;          /* Span of the summary rows */
+    uint64_t range_hi;
+    int runs;                   /* Summary rows */
+    int threads;                /* Sum of their thread counts */
+    double seconds;             /* Sum of their wall times */
+} MergeState;
+
+static bool row_list_add(RowList *list, const ResultRecord *row) {
+    if (list->count == list->capacity) {
+        size_t cap = list->capacity ? 2 * list->capacity : 1024;
+        ResultRecord *grown = (ResultRecord *)realloc(list->rows, cap * sizeof(ResultRecord));
+        if (!grown) return false;
+        list->rows = grown;
+        list->capacity = cap;
+    }
+    list->rows[list->count++] = *row;
+    return true;
+}
+
+static bool chunk_list_add(ChunkList *list, const ResultRecord *row, int file) {
+    if (list->count == list->capacity) {
+        size_t cap = list->capacity ? 2 * list->capacity : 1024;
+        MergeChunk *grown = (MergeChunk *)realloc(list->rows, cap * sizeof(MergeChunk));
+        if (!grown) return false;
+        list->rows = grown;
+        list->capacity = cap;
+    }
+    MergeChunk chunk = {*row, file, list->count, false};
+    list->rows[list->count++] = chunk;
+    return true;
+}
+
+/* ========================================================================== */
+/* CSV Parsing                                                                */
+/* ========================================================================== */
+
+/* Split line at commas in place; empty fields stay empty. Returns the count. */
+static int split_csv(char *line, char *fields[MERGE_COLUMNS]) {
+    int n = 0;
+    char *p = line;
+    while (n < MERGE_COLUMNS) {
+        fields[n++] = p;
+        char *comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+    return n;
+}
+
+static bool parse_u64(const char *s, uint64_t *out) {
+    char *end;
+    if (*s == '\0') return false;
+    *out = strtoull(s, &end, 10);
+    return *end == '\0';
+}
+
+static bool parse_u128(const char *s, __uint128_t *out) {
+    if (*s == '\0') return false;
+    __uint128_t v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return false;
+        v = v * 10 + (unsigned)(*s - '0');
+    }
+    *out = v;
+    return true;
+}
+
+/**
+ * Read one results file into st. Returns false (with a message) if the file
+ * cannot be read or a row is malformed.
+ */
+static bool merge_read_file(MergeState *st, const char *path, int file) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: cannot read %s\n", path);
+        return false;
+    }
+
+    char line[512];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || strncmp(line, "type,", 5) == 0) continue;
+
+        char *fields[MERGE_COLUMNS];
+        ResultRecord row = {0};
+        uint64_t cols[9];
+        bool parsed = split_csv(line, fields) == MERGE_COLUMNS;
+        for (int c = 2; parsed && c < 9; c++) {
+            parsed = parse_u64(fields[c], &cols[c]);
+        }
+        if (parsed) {
+            row.thread = atoi(fields[1]);
+            row.n_lo = cols[2];
+            row.n_hi = cols[3];
+            row.stats.n_processed = cols[4];
+            row.stats.total_checks = cols[5];
+            row.stats.sieve_hits = cols[6];
+            row.stats.sieve_misses = cols[7];
+            row.stats.counterexamples = cols[8];
+            row.start = atof(fields[9]);
+            row.seconds = atof(fields[10]);
+        }
+
+        const char *type = fields[0];
+        if (!parsed) {
+            ok = false;
+        } else if (strcmp(type, "chunk") == 0) {
+            row.type = RESULT_CHUNK;
+            ok = row.n_lo < row.n_hi && chunk_list_add(&st->chunks, &row, file);
+        } else if (strcmp(type, "counterexample") == 0) {
+            row.type = RESULT_COUNTEREXAMPLE;
+            ok = row_list_add(&st->counterexamples, &row);
+        } else if (strcmp(type, "summary") == 0) {
+            if (st->runs == 0 || row.n_lo < st->range_lo) st->range_lo = row.n_lo;
+            if (st->runs == 0 || row.n_hi > st->range_hi) st->range_hi = row.n_hi;
+            st->runs++;
+            st->threads += row.thread;
+            st->seconds += row.seconds;
+        } else if (strcmp(type, "record_steps") == 0 || strcmp(type, "record_p") == 0) {
+            NRecord r = {row.n_lo, 0, 0, 0};
+            ok = parse_u64(fields[11], &r.a) && parse_u128(fields[12], &r.p) &&
+                 parse_u64(fields[13], &r.steps);
+            if (ok && st->num_candidates == st->cap_candidates) {
+                size_t cap = st->cap_candidates ? 2 * st->cap_candidates : 64;
+                NRecord *grown = (NRecord *)realloc(st->candidates, cap * sizeof(NRecord));
+                ok = grown != NULL;
+                if (ok) {
+                    st->candidates = grown;
+                    st->cap_candidates = cap;
+                }
+            }
+            if (ok) st->candidates[st->num_candidates++] = r;
+        } else {
+            ok = false;
+        }
+        if (!ok) fprintf(stderr, "Error: %s:%d: malformed row\n", path, line_no);
+    }
+    fclose(f);
+    return ok;
+}
+
+/* ========================================================================== */
+/* Records                                                                    */
+/* ========================================================================== */
+
+static int cmp_record_n(const void *x, const void *y) {
+    uint64_t a = ((const NRecord *)x)->n, b = ((const NRecord *)y)->n;
+    return (a > b) - (a < b);
+}
+
+/*
+ * Merge the record rows into st->records. An n appears in both tables of
+ * its file (and in several files after a resume), so offer each n once.
+ */
+static void merge_records(MergeState *st) {
+    qsort(st->candidates, st->num_candidates, sizeof(NRecord), cmp_record_n);
+    for (size_t i = 0; i < st->num_candidates; i++) {
+        if (i > 0 && st->candidates[i].n == st->candidates[i - 1].n) continue;
+        records_offer(&st->records, &st->candidates[i]);
+    }
+}
+
+/* ========================================================================== */
+/* Coverage                                                                   */
+/* ========================================================================== */
+
+static int cmp_chunk(const void *x, const void *y) {
+    const ResultRecord *a = &((const MergeChunk *)x)->row, *b = &((const MergeChunk *)y)->row;
+    if (a->n_lo != b->n_lo) return a->n_lo < b->n_lo ? -1 : 1;
+    return (a->n_hi > b->n_hi) - (a->n_hi < b->n_hi);
+}
+
+/**
+ * Mark the chunk rows (sorted by n) that later rows of the same file cover
+ * completely: the later run redid them. The latest row holding an n is
+ * never marked, so coverage is unchanged. Sums the statistics of the rows
+ * not marked. Rows only overlap after a resume, in small groups.
+ */
+static void drop_redone_chunks(MergeState *st) {
+    MergeChunk *rows = st->chunks.rows;
+    size_t count = st->chunks.count;
+    size_t i = 0;
+    while (i < count) {
+        /* Group [i, end): rows that overlap transitively */
+        size_t end = i + 1;
+        uint64_t group_hi = rows[i].row.n_hi;
+        while (end < count && rows[end].row.n_lo < group_hi) {
+            if (rows[end].row.n_hi > group_hi) group_hi = rows[end].row.n_hi;
+            end++;
+        }
+
+        for (size_t k = i; end - i > 1 && k < end; k++) {
+            /* Sweep the later rows of k's file, in n order, over k */
+            uint64_t pos = rows[k].row.n_lo;
+            for (size_t j = i; j < end && pos < rows[k].row.n_hi; j++) {
+                if (rows[j].file != rows[k].file || rows[j].seq <= rows[k].seq) continue;
+                if (rows[j].row.n_lo > pos) break;
+                if (rows[j].row.n_hi > pos) pos = rows[j].row.n_hi;
+            }
+            if (pos >= rows[k].row.n_hi) {
+                rows[k].redone = true;
+                st->redone++;
+            }
+        }
+        i = end;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        if (rows[k].redone) continue;
+        const CheckpointStats *c = &rows[k].row.stats;
+        st->stats.n_processed += c->n_processed;
+        st->stats.total_checks += c->total_checks;
+        st->stats.counterexamples += c->counterexamples;
+        st->stats.sieve_hits += c->sieve_hits;
+        st->stats.sieve_misses += c->sieve_misses;
+    }
+}
+
+static void report_interval(const char *what, uint64_t lo, uint64_t hi, uint64_t *count,
+                            uint64_t *total) {
+    if ((*count)++ < MERGE_MAX_LISTED) {
+        printf("  %-8s [%s, %s) (%s n)\n", what, fmt_num(lo), fmt_num(hi), fmt_num(hi - lo));
+    }
+    *total += hi - lo;
+}
+
+/**
+ * Check that the sorted chunks not redone cover [lo, hi) exactly once.
+ * Returns true if there is no gap, no overlap and nothing outside.
+ */
+static bool check_coverage(const ChunkList *chunks, uint64_t redone, uint64_t lo, uint64_t hi,
+                           uint64_t *covered) {
+    uint64_t gaps = 0, gap_n = 0, overlaps = 0, overlap_n = 0, outside = 0, outside_n = 0;
+    uint64_t pos = lo;      /* Everything in [lo, pos) is covered */
+    *covered = 0;
+
+    printf("Coverage of [%s, %s):\n", fmt_num(lo), fmt_num(hi));
+    for (size_t i = 0; i < chunks->count; i++) {
+        if (chunks->rows[i].redone) continue;
+        uint64_t c_lo = chunks->rows[i].row.n_lo, c_hi = chunks->rows[i].row.n_hi;
+
+        /* Parts outside the expected range */
+        if (c_lo < lo) {
+            report_interval("outside", c_lo, c_hi < lo ? c_hi : lo, &outside, &outside_n);
+            c_lo = lo;
+        }
+        if (c_hi > hi) {
+            uint64_t o_lo = c_lo > hi ? c_lo : hi;
+            report_interval("outside", o_lo, c_hi, &outside, &outside_n);
+            c_hi = hi;
+        }
+        if (c_lo >= c_hi) continue;
+
+        if (c_lo < pos) {
+            report_interval("overlap", c_lo, c_hi < pos ? c_hi : pos, &overlaps, &overlap_n);
+            c_lo = pos;
+        } else if (c_lo > pos) {
+            report_interval("gap", pos, c_lo, &gaps, &gap_n);
+        }
+        if (c_hi > c_lo) {
+            *covered += c_hi - c_lo;
+            pos = c_hi;
+        }
+    }
+    if (pos < hi) report_interval("gap", pos, hi, &gaps, &gap_n);
+    if (redone > 0) {
+        printf("  %s chunk rows redone by a resumed run (ignored)\n", fmt_num(redone));
+    }
+
+    if (gaps + overlaps + outside == 0) {
+        printf("  complete: every n covered exactly once (%s chunks)\n",
+               fmt_num(chunks->count - redone));
+        return true;
+    }
+    if (gaps + overlaps + outside > MERGE_MAX_LISTED) printf("  ...\n");
+    printf("  %s gaps (%s n), %s overlaps (%s n), %s outside (%s n)\n",
+           fmt_num(gaps), fmt_num(gap_n), fmt_num(overlaps), fmt_num(overlap_n),
+           fmt_num(outside), fmt_num(outside_n));
+    return false;
+}
+
+/* ========================================================================== */
+/* Output                                                                     */
+/* ========================================================================== */
+
+static bool write_combined(const MergeState *st, const char *path, uint64_t lo, uint64_t hi) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "type,thread,n_lo,n_hi,n_processed,checks,sieve_hits,"
+               "sieve_misses,counterexamples,start_s,seconds,a,p,steps\n");
+    for (size_t i = 0; i < st->chunks.count; i++) {
+        if (!st->chunks.rows[i].redone) result_log_write_row(f, &st->chunks.rows[i].row);
+    }
+    for (size_t i = 0; i < st->counterexamples.count; i++) {
+        result_log_write_row(f, &st->counterexamples.rows[i]);
+    }
+    ResultRecord summary = {RESULT_SUMMARY, st->threads, lo, hi, st->stats,
+                            0.0, st->seconds, NULL};
+    result_log_write_row(f, &summary);
+    for (int kind = 0; kind < 2; kind++) {
+        NRecord sorted[RECORDS_TOP_K];
+        int count = records_sorted(&st->records, (RecordKind)kind, sorted);
+        for (int i = 0; i < count; i++) {
+            ResultRecord row = {kind == RECORD_P ? RESULT_RECORD_P : RESULT_RECORD_STEPS,
+                                -1, sorted[i].n, sorted[i].n + 1, {0}, 0.0, 0.0,
+                                &sorted[i]};
+            result_log_write_row(f, &row);
+        }
+    }
+    bool ok = !ferror(f);
+    return (fclose(f) == 0) && ok;
+}
+
+/* ========================================================================== */
+/* Main                                                                       */
+/* ========================================================================== */
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [--range START END] [--output FILE] FILE...\n", program);
+    printf("\n");
+    printf("Merge the --results CSV files of a sharded search: check that every n of\n");
+    printf("the range is covered exactly once and print the combined summary.\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  --range START END  Expected range [START, END) (default: the span of\n");
+    printf("                     the files' summary rows)\n");
+    printf("  --output FILE      Write the combined results as one CSV file\n");
+    printf("\n");
+    printf("Example:\n");
+    printf("  for i in 1 2 3 4; do ./search 1e12 2e12 --shard $i/4 --results s$i.csv; done\n");
+    printf("  %s --range 1e12 2e12 s1.csv s2.csv s3.csv s4.csv\n", program);
+    printf("\n");
+    printf("Exit codes:\n");
+    printf("  0  Range covered exactly once, no counterexamples\n");
+    printf("  1  Gap, overlap or chunk outside the range; unreadable or malformed file\n");
+    printf("  2  Counterexample found\n");
+}
+
+static uint64_t parse_number(const char *str) {
+    char *endptr;
+    double val = strtod(str, &endptr);
+    if (*endptr != '\0') {
+        return strtoull(str, NULL, 10);
+    }
+    if (val >= 18446744073709551616.0) return UINT64_MAX;  /* 2^64: clamp */
+    return (uint64_t)val;
+}
+
+int main(int argc, char **argv) {
+    const char *output_path = NULL;
+    bool have_range = false;
+    uint64_t range_lo = 0, range_hi = 0;
+    const char **files = (const char **)malloc((size_t)argc * sizeof(char *));
+    int num_files = 0;
+    if (!files) return 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "--range") == 0 && i + 2 < argc) {
+            range_lo = parse_number(argv[i + 1]);
+            range_hi = parse_number(argv[i + 2]);
+            have_range = true;
+            i += 2;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            files[num_files++] = argv[i];
+        }
+    }
+    if (num_files == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    static MergeState st;
+    records_init(&st.records);
+    for (int i = 0; i < num_files; i++) {
+        if (!merge_read_file(&st, files[i], i)) return 1;
+    }
+    merge_records(&st);
+    if (!have_range) {
+        if (st.runs == 0) {
+            fprintf(stderr, "Error: no summary rows (unfinished runs?); give --range\n");
+            return 1;
+        }
+        range_lo = st.range_lo;
+        range_hi = st.range_hi;
+    }
+    if (range_lo >= range_hi) {
+        fprintf(stderr, "Error: empty range\n");
+        return 1;
+    }
+
+    qsort(st.chunks.rows, st.chunks.count, sizeof(MergeChunk), cmp_chunk);
+    drop_redone_chunks(&st);
+
+    printf("Files: %d, runs: %d, chunks: %s\n\n", num_files, st.runs,
+           fmt_num(st.chunks.count - st.redone));
+    uint64_t covered;
+    bool complete = check_coverage(&st.chunks, st.redone, range_lo, range_hi, &covered);
+
+    printf("\nCombined summary:\n");
+    printf("  Covered:            %s of %s n (%.2f%%)\n", fmt_num(covered),
+           fmt_num(range_hi - range_lo), 100.0 * covered / (range_hi - range_lo));
+    printf("  n processed:        %s\n", fmt_num(st.stats.n_processed));
+    if (st.stats.total_checks > 0) {
+        printf("  Avg checks per n:   %.2f\n",
+               (double)st.stats.total_checks / st.stats.n_processed);
+    }
+    if (st.stats.sieve_hits + st.stats.sieve_misses > 0) {
+        printf("  Sieve hits:         %s of %s primes\n", fmt_num(st.stats.sieve_hits),
+               fmt_num(st.stats.sieve_hits + st.stats.sieve_misses));
+    }
+    printf("  Run time (sum):     %.1f seconds over %d runs\n", st.seconds, st.runs);
+    printf("  Counterexamples:    %s\n", fmt_num(st.counterexamples.count));
+    for (size_t i = 0; i < st.counterexamples.count; i++) {
+        printf("    n = %s\n", fmt_num(st.counterexamples.rows[i].n_lo));
+    }
+
+    records_print(&st.records);
+
+    if (output_path) {
+        if (!write_combined(&st, output_path, range_lo, range_hi)) {
+            fprintf(stderr, "Error: cannot write %s\n", output_path);
+            return 1;
+        }
+        printf("\nCombined results written to %s\n", output_path);
+    }
+
+    free(st.chunks.rows);
+    free(st.counterexamples.rows);
+    free(st.candidates);
+    free(files);
+    if (st.counterexamples.count > 0) return 2;
+    return complete ? 0 : 1;
+}
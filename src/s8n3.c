@@ -0,0 +1,353 @@
+/*
+ * libsearch8n3: Embeddable Search API (implementation)
+ *
+ * The engines of search.c and search_batched.c behind the interface of
+ * s8n3.h. Threads claim guided chunks from a WorkQueue exactly as in
+ * ./search; each chunk is searched by the selected engine:
+ *
+ *   per-n     solve_walk() of ./search (solve_walk.h), with a wheel per
+ *             worker
+ *   pipeline  pipeline_run() in slices (solve_pipeline.h)
+ *   batched   batch_process() over batch_size pieces (batch_sieve.h); n the
+ *             batch leaves unsolved are re-checked with the per-n walk
+ *
+ * Per-chunk statistics are accumulated by the worker and published, with
+ * the callbacks, in one critical section per chunk.
+ *
+ * Build: make lib (libsearch8n3.a, libsearch8n3.so)
+ */
+
+#define _GNU_SOURCE  /* mmap (sieve_file.h), CPU_SET (topology.h), clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "s8n3.h"
+#include "arith.h"
+#include "prime.h"
+#include "prime_sieve_fast.h"
+#include "sieve_file.h"
+#include "work_queue.h"
+#include "solve_pipeline.h"
+#include "solve_walk.h"
+#include "batch_sieve.h"
+#include "topology.h"
+
+/* ========================================================================== */
+/* Configuration                                                              */
+/* ========================================================================== */
+
+#define S8N3_DEFAULT_PIPELINE_WIDTH 8
+
+/* n per pipeline_run() call (cancellation latency, as in search.c) */
+#define S8N3_PIPELINE_SLICE 4096
+
+/* ========================================================================== */
+/* Context                                                                    */
+/* ========================================================================== */
+
+/* Per-thread state kept across searches */
+typedef struct {
+    _Alignas(64) TrialWheel wheel;  /* a-walk wheel of the per-n walk */
+    BatchSieve *batch;          /* Batched engine, created on first use */
+    uint64_t batch_size;
+} S8n3Worker;
+
+struct s8n3_context {
+    PrimeSieve *sieve;
+    int threads;
+    S8n3Worker *workers;
+    WorkQueue *_Atomic active;  /* Queue of the running search, or NULL */
+};
+
+static double s8n3_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void s8n3_opts_init(s8n3_opts *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->engine = S8N3_ENGINE_PER_N;
+    opts->pipeline_width = S8N3_DEFAULT_PIPELINE_WIDTH;
+    opts->batch_size = BATCH_DEFAULT_SIZE;
+}
+
+s8n3_context *s8n3_create(const s8n3_opts *opts, int *err) {
+    s8n3_opts defaults;
+    if (!opts) {
+        s8n3_opts_init(&defaults);
+        opts = &defaults;
+    }
+    if (err) *err = S8N3_ERR_MEMORY;
+    s8n3_context *ctx = (s8n3_context *)calloc(1, sizeof(*ctx));
+    if (!ctx) return NULL;
+
+    /* Threads: as ./search, one per pin slot within the cgroup CPU quota */
+    int threads = opts->threads;
+#ifdef _OPENMP
+    if (threads <= 0) {
+        CpuTopology *topo = (CpuTopology *)malloc(sizeof(CpuTopology));
+        threads = omp_get_max_threads();
+        if (topo) {
+            topology_detect(topo);
+            int fit = topology_default_threads(topo);
+            if (threads > fit) threads = fit;
+            free(topo);
+        }
+    }
+#else
+    threads = 1;
+#endif
+    ctx->threads = threads > 0 ? threads : 1;
+
+    ctx->workers = (S8n3Worker *)aligned_alloc(64, (size_t)ctx->threads * sizeof(S8n3Worker));
+    if (!ctx->workers) {
+        free(ctx);
+        return NULL;
+    }
+    memset(ctx->workers, 0, (size_t)ctx->threads * sizeof(S8n3Worker));
+    trial_wheel_init();
+    for (int t = 0; t < ctx->threads; t++) trial_wheel_reset(&ctx->workers[t].wheel);
+    atomic_init(&ctx->active, NULL);
+
+    if (opts->sieve_file) {
+        const char *msg;
+        ctx->sieve = sieve_file_open(opts->sieve_file, false, &msg);
+    } else if (opts->sieve_threshold > 0) {
+        ctx->sieve = sieve_create(opts->sieve_threshold);
+    }
+    if ((opts->sieve_file || opts->sieve_threshold > 0) && !ctx->sieve) {
+        if (err) *err = S8N3_ERR_SIEVE;
+        s8n3_destroy(ctx);
+        return NULL;
+    }
+    if (err) *err = S8N3_OK;
+    return ctx;
+}
+
+void s8n3_destroy(s8n3_context *ctx) {
+    if (!ctx) return;
+    for (int t = 0; t < ctx->threads; t++) batch_sieve_destroy(ctx->workers[t].batch);
+    free(ctx->workers);
+    sieve_destroy(ctx->sieve);
+    free(ctx);
+}
+
+int s8n3_threads(const s8n3_context *ctx) {
+    return ctx->threads;
+}
+
+void s8n3_cancel(s8n3_context *ctx) {
+    WorkQueue *q = atomic_load_explicit(&ctx->active, memory_order_acquire);
+    if (q) work_queue_cancel(q);
+}
+
+const char *s8n3_version(void) {
+    return S8N3_VERSION;
+}
+
+/* ========================================================================== */
+/* Engines                                                                    */
+/* ========================================================================== */
+
+/**
+ * Per-n engine over [lo, hi). Returns the end of the finished prefix.
+ */
+static uint64_t s8n3_run_per_n(s8n3_context *ctx, int tid, WorkQueue *q, uint64_t lo,
+                               uint64_t hi, PipelineStats *st, uint64_t *counterexample) {
+    SolveWalker walker = {ctx->sieve, &ctx->workers[tid].wheel, st, tid, false};
+    uint64_t a_floor32 = solve_a_floor32(hi);
+    uint64_t a_floor63 = solve_a_floor63(hi);
+    for (uint64_t n = lo; n < hi; n++) {
+        uint64_t a_max;
+        if (work_queue_cancelled(q)) return n;
+        if (solve_walk(&walker, n, a_floor32, a_floor63, &a_max) == 0) {
+            st->counterexamples++;
+            *counterexample = n;
+            return n + 1;
+        }
+    }
+    return hi;
+}
+
+static uint64_t s8n3_run_pipeline(const s8n3_context *ctx, WorkQueue *q, uint64_t lo,
+                                  uint64_t hi, int width, PipelineStats *st,
+                                  uint64_t *counterexample) {
+    uint64_t n = lo;
+    while (n < hi && !work_queue_cancelled(q)) {
+        uint64_t slice_end = hi - n > S8N3_PIPELINE_SLICE ? n + S8N3_PIPELINE_SLICE : hi;
+        uint64_t before = st->counterexamples;
+        n = pipeline_run(n, slice_end, width, ctx->sieve, st, NULL, counterexample);
+        if (st->counterexamples > before) break;
+    }
+    return n;
+}
+
+static uint64_t s8n3_run_batched(s8n3_context *ctx, int tid, WorkQueue *q, uint64_t lo,
+                                 uint64_t hi, uint64_t batch_size, PipelineStats *st,
+                                 uint64_t *counterexample) {
+    S8n3Worker *w = &ctx->workers[tid];
+    if (!w->batch || w->batch_size != batch_size) {
+        batch_sieve_destroy(w->batch);
+        w->batch = batch_sieve_create(lo, batch_size);
+        w->batch_size = w->batch ? batch_size : 0;
+        if (!w->batch) return lo;
+    }
+
+    uint64_t n = lo;
+    while (n < hi && !work_queue_cancelled(q)) {
+        uint64_t size = hi - n < batch_size ? hi - n : batch_size;
+        batch_sieve_reset(w->batch, n);
+        w->batch->batch_size = size;
+        batch_process(w->batch);
+        st->n_processed += size;
+
+        /* The batch gives up on a few n; the per-n engine decides them */
+        for (uint64_t i = 0; w->batch->total_solved < size && i < size; i++) {
+            if (w->batch->solved[i]) continue;
+            PipelineStats recheck = {0};
+            uint64_t end = s8n3_run_per_n(ctx, tid, q, n + i, n + i + 1, &recheck,
+                                          counterexample);
+            st->total_checks += recheck.total_checks;
+            st->sieve_hits += recheck.sieve_hits;
+            st->sieve_misses += recheck.sieve_misses;
+            if (end == n + i) {
+                st->n_processed -= size - i;    /* Cancelled */
+                return n + i;
+            }
+            if (recheck.counterexamples) {
+                st->counterexamples++;
+                return n + size;
+            }
+        }
+        n += size;
+    }
+    return n;
+}
+
+/* ========================================================================== */
+/* Search                                                                     */
+/* ========================================================================== */
+
+int s8n3_search(s8n3_context *ctx, uint64_t n_start, uint64_t n_end,
+                const s8n3_opts *opts, const s8n3_callbacks *callbacks,
+                s8n3_result *result) {
+    s8n3_opts defaults;
+    if (!opts) {
+        s8n3_opts_init(&defaults);
+        opts = &defaults;
+    }
+    static const s8n3_callbacks no_callbacks = {0};
+    const s8n3_callbacks *cb = callbacks ? callbacks : &no_callbacks;
+    if (!ctx || n_start >= n_end) return S8N3_ERR_ARGS;
+    if (opts->engine == S8N3_ENGINE_BATCHED &&
+        (n_end > SOLVE_N64_LIMIT || opts->batch_size == 0)) {
+        return S8N3_ERR_ARGS;
+    }
+    if ((unsigned)opts->engine > S8N3_ENGINE_BATCHED) return S8N3_ERR_ARGS;
+
+    s8n3_stats total;
+    memset(&total, 0, sizeof(total));
+    total.n_lo = n_start;
+    total.n_hi = n_end;
+    total.thread = ctx->threads;
+    uint64_t done = 0;
+    double start = s8n3_now();
+    double last_progress = 0.0;
+    bool failed = false;
+
+    WorkQueue queue;
+    work_queue_init(&queue, n_start, n_end, ctx->threads);
+    atomic_store_explicit(&ctx->active, &queue, memory_order_release);
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(ctx->threads)
+#endif
+    {
+#ifdef _OPENMP
+        int tid = omp_get_thread_num();
+#else
+        int tid = 0;
+#endif
+        uint64_t lo, hi;
+        while (work_queue_next(&queue, &lo, &hi)) {
+            PipelineStats st = {0};
+            uint64_t counterexample = 0;
+            double chunk_start = s8n3_now();
+            uint64_t end;
+
+            bool use_pipeline = opts->engine == S8N3_ENGINE_PIPELINE && hi <= SOLVE_N64_LIMIT;
+            if (opts->engine == S8N3_ENGINE_BATCHED) {
+                end = s8n3_run_batched(ctx, tid, &queue, lo, hi, opts->batch_size,
+                                       &st, &counterexample);
+            } else if (use_pipeline) {
+                end = s8n3_run_pipeline(ctx, &queue, lo, hi, opts->pipeline_width,
+                                        &st, &counterexample);
+            } else {
+                end = s8n3_run_per_n(ctx, tid, &queue, lo, hi, &st, &counterexample);
+            }
+            double now = s8n3_now();
+
+#ifdef _OPENMP
+            #pragma omp critical(s8n3_callbacks)
+#endif
+            {
+                if (end == lo && opts->engine == S8N3_ENGINE_BATCHED &&
+                    !ctx->workers[tid].batch) {
+                    failed = true;      /* Batch sieve allocation */
+                    work_queue_cancel(&queue);
+                }
+                total.n_processed += st.n_processed;
+                total.checks += st.total_checks;
+                total.sieve_hits += st.sieve_hits;
+                total.sieve_misses += st.sieve_misses;
+                total.counterexamples += st.counterexamples;
+                done += end - lo;
+
+                if (end > lo && cb->chunk) {
+                    s8n3_stats chunk = {lo, end, st.n_processed, st.total_checks,
+                                        st.sieve_hits, st.sieve_misses,
+                                        st.counterexamples, now - chunk_start, tid};
+                    cb->chunk(cb->user, &chunk);
+                }
+                if (st.counterexamples > 0) {
+                    work_queue_cancel(&queue);
+                    if (cb->counterexample) cb->counterexample(cb->user, counterexample);
+                }
+                if (cb->progress && now - start - last_progress >= opts->progress_seconds) {
+                    last_progress = now - start;
+                    cb->progress(cb->user, done, n_end - n_start, last_progress);
+                }
+            }
+        }
+    }
+
+    atomic_store_explicit(&ctx->active, NULL, memory_order_release);
+    total.seconds = s8n3_now() - start;
+    if (result) *result = total;
+
+    if (failed) return S8N3_ERR_MEMORY;
+    if (total.counterexamples > 0) return S8N3_COUNTEREXAMPLE;
+    if (done < n_end - n_start) return S8N3_CANCELLED;
+    return S8N3_OK;
+}
+
+int s8n3_search_range(uint64_t n_start, uint64_t n_end, const s8n3_opts *opts,
+                      const s8n3_callbacks *callbacks, s8n3_result *result) {
+    int err;
+    s8n3_context *ctx = s8n3_create(opts, &err);
+    if (!ctx) return err;
+    int rc = s8n3_search(ctx, n_start, n_end, opts, callbacks, result);
+    s8n3_destroy(ctx);
+    return rc;
+}
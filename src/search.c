@@ -9,21 +9,68 @@
  * - Only 2 Miller-Rabin tests (vs 7 in standard deterministic test)
  * - 512KB precomputed hash table for witness selection
  * - 100% deterministic for all 64-bit integers
+ * Walk steps whose candidates are provably below 2^32 for the whole chunk
+ * use a single 32-bit Miller-Rabin test instead (prime32.h).
  *
- * Parallelized with OpenMP for multi-core systems.
+ * Parallelized with OpenMP for multi-core systems, using a dynamic chunk
+ * scheduler (work_queue.h) so fast threads take over the tail of the range.
+ *
+ * With --pipeline K each thread keeps K n searches in flight and tests their
+ * Miller-Rabin candidates together (solve_pipeline.h), hiding the latency
+ * of the Montgomery multiply chains.
  *
  * Reference: Forisek & Jancina (2015), "Fast Primality Testing for
  * Integers That Fit into a Machine Word"
  *
+ * With --results FILE, per-chunk statistics, counterexamples and a run
+ * summary are also written as CSV by a background writer (result_log.h);
+ * worker threads only push records into their own lock-free ring.
+ *
+ * A prime sieve can be built per run (--sieve-threshold) or generated once
+ * (--generate-sieve) and mapped read-only by every later run (--sieve-file).
+ *
+ * --affinity compact|scatter|cores-only pins the threads (topology.h); on
+ * multi-node machines a built sieve is then replicated into each NUMA node
+ * the threads use. Without --threads the thread count also respects the
+ * cgroup v2 CPU quota.
+ *
+ * --shard i/k searches only the i-th of k equal-cost pieces of the range
+ * (shard.h), for splitting one range across machines; the merge tool
+ * checks the shards' --results files for exact coverage.
+ *
+ * For long campaigns, --spool-init DIR splits the range into work-unit
+ * files that any number of --spool-work DIR processes (on any host that
+ * shares the directory) claim by rename, keep leased while searching and
+ * publish as results files; --spool-coordinate DIR requeues the units of
+ * crashed workers and reports progress (spool.h).
+ *
+ * `make portable` builds one binary for every x86-64 node type: the hot
+ * kernels are cloned for x86-64-v2/v3/v4 and resolved at startup
+ * (dispatch.h); --print-dispatch shows the variants chosen.
+ *
+ * --interleaved-td tests candidates between 2^32 and 2^52 with trial
+ * division by 131-467 on the FP units during the base-2 Miller-Rabin
+ * exponentiation (prime_interleaved.h).
+ *
+ * The per-n walk skips candidates divisible by 3-127 with a per-thread
+ * a-walk wheel (trial_wheel.h) instead of trial-dividing them; --no-wheel
+ * goes back to trial division.
+ *
  * Compile: make release
- * Usage:   ./search [n_start] [n_end] [--threads N]
+ * Usage:   ./search [n_start] [n_end] [--threads N] [--pipeline K] [--checkpoint FILE]
+ *          ./search --resume FILE
+ *          ./search n_start n_end --spool-init DIR; ./search --spool-work DIR
  */
 
+#define _GNU_SOURCE  /* fsync, fileno (checkpoint.h), mmap (sieve_file.h),
+                        pthreads (result_log.h), CPU_SET (topology.h) */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <signal.h>
 #include <time.h>
 
 #ifdef _OPENMP
@@ -31,29 +78,54 @@
 #endif
 
 /* Include shared headers */
+#include "version.h"
 #include "fmt.h"
 #include "arith.h"
 #include "prime.h"
 #include "prime_sieve_fast.h"  /* Optimized: wheel30 + OpenMP (~20x faster) */
+#include "sieve_file.h"        /* On-disk sieve, mmap shared across processes */
+#include "work_queue.h"        /* Dynamic chunk scheduler */
+#include "checkpoint.h"        /* Crash-safe checkpoint / resume */
+#include "result_log.h"        /* --results CSV via per-thread rings + writer */
+#include "records.h"           /* Top-K hardest n */
+#include "solve_pipeline.h"    /* Multi-n interleaved Miller-Rabin */
+#include "solve_walk.h"        /* Per-n walk (shared with libsearch8n3) */
+#include "trial_vector.h"      /* 8-step vector trial division */
+#include "trial_wheel.h"       /* a-walk wheel: 64-step skip masks for 3-127 */
+#include "search_counters.h"   /* Stage counters (make counters, else no-ops) */
+#include "topology.h"          /* --affinity pinning, NUMA nodes, CPU quota */
+#include "progress_monitor.h"  /* Progress lines from a sampling thread */
+#include "shard.h"             /* --shard i/k: equal-cost range pieces */
+#include "spool.h"             /* --spool-*: work units, leases, results */
+#include "dispatch.h"          /* make portable: per-ISA kernel clones */
+#include "prime_interleaved.h" /* --interleaved-td: FP trial division in MR */
 
 /* ========================================================================== */
 /* Configuration                                                              */
 /* ========================================================================== */
 
-/* Progress reporting interval in seconds */
-#define PROGRESS_SECONDS 5.0
-
 /* Default search range */
 #define DEFAULT_N_START 1000000000000ULL    /* 10^12 */
 #define DEFAULT_N_END   1000010000000ULL    /* 10^12 + 10^7 */
 
-/* Maximum number of threads supported */
-#define MAX_THREADS 256
+/* n values per pipeline_run() call in --pipeline mode (cancellation latency) */
+#define PIPELINE_SLICE 4096
 
 /* ========================================================================== */
 /* Time Formatting                                                            */
 /* ========================================================================== */
 
+/**
+ * Wall-clock seconds (CPU seconds without OpenMP)
+ */
+static double get_wall_time(void) {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
 /**
  * Format seconds into human-readable time string (e.g., "2h 15m 30s")
  * Uses a static buffer - not thread-safe, but only called from thread 0
@@ -84,138 +156,118 @@ static const char* fmt_time(double seconds) {
 /* ========================================================================== */
 
 typedef struct {
-    uint64_t n_processed;      /* Number of n values processed */
-    uint64_t total_checks;     /* Total a values checked */
-    uint64_t counterexamples;  /* Counterexamples found by this thread */
-    uint64_t sieve_hits;       /* Primes found via sieve lookup */
-    uint64_t sieve_misses;     /* Primes found via Miller-Rabin */
+    PipelineStats stats;       /* n processed, a values checked, counterexamples,
+                                  primes found by sieve lookup / Miller-Rabin */
     /* Padding to avoid false sharing (cache line is typically 64 bytes) */
-    char padding[64 - 5 * sizeof(uint64_t)];
+    char padding[64 - sizeof(PipelineStats)];
 } ThreadStats;
 
-static ThreadStats thread_stats[MAX_THREADS];
+/* One entry per thread, allocated in main() for the run's thread count */
+static ThreadStats *thread_stats;
+
+/* --interleaved-td: is_prime_fj64_interleaved() below INTERLEAVED_LIMIT */
+static bool interleaved_td = false;
+
+/* One a-walk wheel per thread (trial_wheel.h); NULL: --no-wheel */
+static TrialWheel *thread_wheels = NULL;
 
 /* ========================================================================== */
-/* Solution Finding (inlined for performance)                                 */
+/* Thread Placement                                                           */
 /* ========================================================================== */
 
+/* --affinity: pin slots, and the sieve copy that threads on each node read */
+typedef struct {
+    CpuTopology topo;
+    bool pin;                                   /* --affinity given */
+    PrimeSieve *replica[TOPOLOGY_MAX_NODES];    /* Node-local sieves, NULL = shared */
+    int num_replicas;
+} Placement;
+
 /**
- * Check if candidate is filtered by trial division
- * Returns: 0 = composite (filtered), 1 = is small prime, 2 = needs Miller-Rabin
+ * Give each NUMA node used by the first num_threads pin slots its own copy
+ * of sieve, written by a thread pinned to that node so that its pages are
+ * node-local. Only done when the pinned threads span several nodes.
+ * Returns the number of replicas (0: all threads share sieve).
  */
-static inline int trial_division_check_local(uint64_t candidate) {
-    static const uint32_t PRIMES[] = {
-        3, 5, 7, 11, 13, 17, 19, 23, 29, 31,
-        37, 41, 43, 47, 53, 59, 61, 67, 71, 73,
-        79, 83, 89, 97, 101, 103, 107, 109, 113, 127
-    };
+static int placement_replicate_sieve(Placement *pl, const PrimeSieve *sieve,
+                                     int num_threads) {
+    int nodes = pl->topo.num_nodes;
+    int slot_of[TOPOLOGY_MAX_NODES];
+    int used = 0;
+    for (int d = 0; d < nodes; d++) slot_of[d] = -1;
+    for (int slot = 0; slot < num_threads && slot < pl->topo.num_slots; slot++) {
+        int d = topology_slot_node(&pl->topo, slot);
+        if (slot_of[d] < 0) {
+            slot_of[d] = slot;
+            used++;
+        }
+    }
+    if (!pl->pin || used < 2) return 0;
 
-    /* Inline first 7 primes - catch ~65% of composites */
-    if (candidate % 3 == 0) return (candidate == 3) ? 1 : 0;
-    if (candidate % 5 == 0) return (candidate == 5) ? 1 : 0;
-    if (candidate % 7 == 0) return (candidate == 7) ? 1 : 0;
-    if (candidate % 11 == 0) return (candidate == 11) ? 1 : 0;
-    if (candidate % 13 == 0) return (candidate == 13) ? 1 : 0;
-    if (candidate % 17 == 0) return (candidate == 17) ? 1 : 0;
-    if (candidate % 19 == 0) return (candidate == 19) ? 1 : 0;
-
-    /* Check remaining primes 23-127 with 4x unrolled loop */
-    int i = 7;
-    while (i + 3 < 30) {
-        if (candidate % PRIMES[i] == 0)
-            return (candidate == PRIMES[i]) ? 1 : 0;
-        if (candidate % PRIMES[i+1] == 0)
-            return (candidate == PRIMES[i+1]) ? 1 : 0;
-        if (candidate % PRIMES[i+2] == 0)
-            return (candidate == PRIMES[i+2]) ? 1 : 0;
-        if (candidate % PRIMES[i+3] == 0)
-            return (candidate == PRIMES[i+3]) ? 1 : 0;
-        i += 4;
-    }
-    while (i < 30) {
-        if (candidate % PRIMES[i] == 0)
-            return (candidate == PRIMES[i]) ? 1 : 0;
-        i++;
-    }
-    return 2;
+    bool ok = true;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(nodes) reduction(&&:ok)
+#endif
+    for (int d = 0; d < nodes; d++) {
+        if (slot_of[d] < 0) continue;
+        topology_pin_thread(&pl->topo, slot_of[d]);
+        pl->replica[d] = sieve_clone(sieve);
+        ok = ok && pl->replica[d] != NULL;
+    }
+
+    if (!ok) {
+        for (int d = 0; d < nodes; d++) {
+            sieve_destroy(pl->replica[d]);
+            pl->replica[d] = NULL;
+        }
+        return 0;
+    }
+    pl->num_replicas = used;
+    return used;
 }
 
 /**
- * Test if a candidate prime is actually prime
+ * Free sieve and any node replicas (sieve may be one of them)
  */
-static inline bool is_candidate_prime_local(uint64_t candidate) {
-    int td = trial_division_check_local(candidate);
-    if (td == 0) return false;
-    if (td == 1) return true;
-    if (candidate <= 127) return true;
-    return is_prime_fj64_fast(candidate);
+static void placement_release(Placement *pl, PrimeSieve *sieve) {
+    for (int d = 0; d < TOPOLOGY_MAX_NODES; d++) {
+        if (pl->replica[d] == sieve) sieve = NULL;
+        sieve_destroy(pl->replica[d]);
+        pl->replica[d] = NULL;
+    }
+    if (sieve) sieve_destroy(sieve);
 }
 
+/* ========================================================================== */
+/* Checkpointing                                                              */
+/* ========================================================================== */
+
+/* Queue of the running search, cancelled by SIGINT/SIGTERM */
+static WorkQueue *volatile active_queue = NULL;
+static volatile sig_atomic_t stop_requested = 0;
+
 /**
- * Test if a candidate prime is actually prime, using sieve when available.
- * Falls back to Miller-Rabin for candidates outside sieve range.
+ * SIGINT/SIGTERM handler: stop handing out work so the partially finished
+ * chunks can be recorded and the checkpoint saved before exiting.
+ * (Lock-free atomic stores are async-signal-safe.)
  */
-static inline bool is_candidate_prime_with_sieve_local(uint64_t candidate,
-                                                        const PrimeSieve *sieve,
-                                                        int thread_id) {
-    int td = trial_division_check_local(candidate);
-    if (td == 0) return false;  /* Composite */
-    if (td == 1) return true;   /* Small prime (3-127) */
-
-    /* Candidate is > 127 and passed trial division */
-    /* Try sieve lookup first if candidate is in range */
-    if (sieve && sieve_in_range(sieve, candidate)) {
-        thread_stats[thread_id].sieve_hits++;
-        return sieve_is_prime(sieve, candidate);
-    }
-
-    /* Fall back to Miller-Rabin */
-    thread_stats[thread_id].sieve_misses++;
-    return is_prime_fj64_fast(candidate);
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+    if (active_queue) work_queue_cancel(active_queue);
 }
 
 /**
- * Find a solution to 8n + 3 = a^2 + 2p
- * Returns the largest valid a, or 0 if no solution exists (counterexample).
- * Also updates thread-local statistics.
+ * Snapshot of a thread's statistics, used to compute per-chunk deltas
  */
-static inline uint64_t find_solution_parallel(uint64_t n, int thread_id,
-                                               const PrimeSieve *sieve) {
-    uint64_t N = 8 * n + 3;
-    uint64_t a_max = isqrt64(N);
-
-    /* Ensure a_max is odd */
-    if ((a_max & 1) == 0) a_max--;
-
-    uint64_t a = a_max;
-    uint64_t candidate = (N - a * a) >> 1;
-    uint64_t delta = 2 * (a - 1);
-
-    while (1) {
-        if (candidate >= 2) {
-            thread_stats[thread_id].total_checks++;
-
-            bool is_prime;
-            if (sieve) {
-                is_prime = is_candidate_prime_with_sieve_local(candidate, sieve, thread_id);
-            } else {
-                is_prime = is_candidate_prime_local(candidate);
-            }
-
-            if (is_prime) {
-                thread_stats[thread_id].n_processed++;
-                return a;
-            }
-        }
-
-        if (a < 3) break;
-        candidate += delta;
-        delta -= 4;
-        a -= 2;
-    }
-
-    thread_stats[thread_id].n_processed++;
-    return 0;  /* Counterexample! */
+static inline CheckpointStats thread_stats_snapshot(int tid) {
+    CheckpointStats s;
+    s.n_processed = thread_stats[tid].stats.n_processed;
+    s.total_checks = thread_stats[tid].stats.total_checks;
+    s.counterexamples = thread_stats[tid].stats.counterexamples;
+    s.sieve_hits = thread_stats[tid].stats.sieve_hits;
+    s.sieve_misses = thread_stats[tid].stats.sieve_misses;
+    return s;
 }
 
 /* ========================================================================== */
@@ -223,16 +275,67 @@ static inline uint64_t find_solution_parallel(uint64_t n, int thread_id,
 /* ========================================================================== */
 
 /**
- * Run parallel search over a range of n values
+ * Report a counterexample (serialized across threads)
+ */
+static void report_counterexample(uint64_t n, int tid) {
+#ifdef _OPENMP
+    #pragma omp critical
+#endif
+    {
+        printf("\n*** COUNTEREXAMPLE FOUND! ***\n");
+        printf("n = %s (thread %d)\n", fmt_num(n), tid);
+        printf("N = 8n + 3 = %s\n", fmt_num128(8 * (__uint128_t)n + 3));
+        printf("No valid (a, p) pair exists!\n\n");
+        fflush(stdout);
+    }
+}
+
+/**
+ * Run parallel search over the unfinished parts of cp's range
+ *
+ * Threads claim guided-size chunks from a shared WorkQueue instead of one
+ * static slice each, so no thread idles while another still has work.
+ *
+ * Every finished chunk (or the finished prefix of a chunk interrupted by
+ * cancellation) is recorded in cp together with the statistics gathered
+ * over it. If checkpoint_path is set, cp is saved every checkpoint_interval
+ * seconds and once more when the search stops.
+ *
+ * pipeline_width > 0 selects the multi-n pipeline (solve_pipeline.h) with
+ * that many n in flight per thread; 0 searches one n at a time.
+ *
+ * If results is set, every recorded chunk and counterexample is also pushed
+ * to the calling thread's ring of the result log (never blocks).
+ *
+ * If placement->pin is set, thread t is pinned to pin slot t and reads the
+ * sieve replica of its NUMA node, if there is one.
+ *
+ * Each thread tracks the hardest n it solved (records.h); the per-thread
+ * tables are merged into records, which the caller initializes.
  */
-void run_search_parallel(uint64_t n_start, uint64_t n_end, int num_threads,
-                         const PrimeSieve *sieve,
+void run_search_parallel(Checkpoint *cp, int num_threads,
+                         const PrimeSieve *sieve, const Placement *placement,
+                         int pipeline_width,
+                         const char *checkpoint_path, double checkpoint_interval,
+                         ResultLog *results, RecordTracker *records,
                          uint64_t *out_counterexamples) {
     uint64_t total_counterexamples = 0;
-    uint64_t total = n_end - n_start;
+    uint64_t n_start = cp->n_start;
+    uint64_t total = cp->n_end - cp->n_start;
+    uint64_t prior_done = checkpoint_done_count(cp);
+
+    /* Only the gaps left by a previous run need to be searched */
+    int num_pending = 0;
+    WorkRange *pending = checkpoint_pending(cp, &num_pending);
+    if (!pending) {
+        fprintf(stderr, "Error: Failed to allocate pending ranges\n");
+        *out_counterexamples = 0;
+        return;
+    }
+    uint64_t pending_total = total - prior_done;
 
     /* Initialize per-thread statistics */
-    memset(thread_stats, 0, sizeof(thread_stats));
+    memset(thread_stats, 0, (size_t)num_threads * sizeof(ThreadStats));
 
     /* Get start time */
     double start_time;
@@ -242,11 +345,27 @@ void run_search_parallel(uint64_t n_start, uint64_t n_end, int num_threads,
     start_time = (double)clock() / CLOCKS_PER_SEC;
 #endif
 
-    /* Progress reporting timing - shared across threads */
-    volatile double last_report_time = 0.0;
+    /* Workers publish their progress; the monitor thread prints it */
+    ProgressMonitor monitor;
+    if (!progress_monitor_start(&monitor, num_threads, n_start, prior_done,
+                                pending_total, total)) {
+        fprintf(stderr, "Error: Failed to allocate progress counters\n");
+        free(pending);
+        *out_counterexamples = 0;
+        return;
+    }
+    double last_save_time = 0.0;
+    bool ledger_warned = false;
 
-    /* Early termination flag for counterexamples */
-    volatile int found_counterexample = 0;
+    /* Copy of cp written by periodic saves, outside critical(checkpoint) */
+    Checkpoint snapshot;
+    checkpoint_init(&snapshot, cp->n_start, cp->n_end);
+
+    /* Dynamic chunk scheduler; cancelled on counterexample or SIGINT/SIGTERM */
+    WorkQueue queue;
+    work_queue_init_ranges(&queue, pending, num_pending, num_threads);
+    active_queue = &queue;
+    if (stop_requested) work_queue_cancel(&queue);
 
 #ifdef _OPENMP
     omp_set_num_threads(num_threads);
@@ -255,97 +374,364 @@ void run_search_parallel(uint64_t n_start, uint64_t n_end, int num_threads,
     {
 #ifdef _OPENMP
         int tid = omp_get_thread_num();
-        int nthreads = omp_get_num_threads();
 #else
         int tid = 0;
-        int nthreads = 1;
 #endif
 
-        /* Calculate this thread's range */
-        uint64_t chunk_size = (total + nthreads - 1) / nthreads;
-        uint64_t my_start = n_start + (uint64_t)tid * chunk_size;
-        uint64_t my_end = my_start + chunk_size;
-        if (my_end > n_end) my_end = n_end;
-        if (my_start >= n_end) my_start = my_end;  /* Empty range */
+        /* Pin before the first chunk so the thread's memory stays local */
+        const PrimeSieve *local_sieve = sieve;
+        if (placement->pin) {
+            topology_pin_thread(&placement->topo, tid);
+            const PrimeSieve *replica =
+                placement->replica[topology_slot_node(&placement->topo, tid)];
+            if (replica) local_sieve = replica;
+        }
+        SolveWalker walker = {local_sieve, thread_wheels ? &thread_wheels[tid] : NULL,
+                              &thread_stats[tid].stats, tid, interleaved_td};
 
         uint64_t local_counterexamples = 0;
+        RecordTracker local_records;
+        records_init(&local_records);
         uint64_t local_progress = 0;
+        uint64_t chunk_start, chunk_end;
+
+        /* Claim chunks until the range is exhausted or the search is cancelled */
+        while (work_queue_next(&queue, &chunk_start, &chunk_end)) {
+            CheckpointStats before = thread_stats_snapshot(tid);
+            double chunk_time = results ? get_wall_time() : 0.0;
+            uint64_t n = chunk_start;
+
+            /* The pipeline feed is 64-bit: chunks past n = 2^61 run per n */
+            bool use_pipeline = pipeline_width > 0 && chunk_end <= SOLVE_N64_LIMIT;
+
+            if (use_pipeline) {
+                /* Pipeline in slices so cancellation is noticed promptly */
+                while (n < chunk_end && !work_queue_cancelled(&queue)) {
+                    uint64_t slice_end = chunk_end - n > PIPELINE_SLICE
+                        ? n + PIPELINE_SLICE : chunk_end;
+                    PipelineStats ps = {0};
+                    uint64_t counterexample = 0;
+                    uint64_t done = pipeline_run(n, slice_end, pipeline_width, local_sieve,
+                                                 &ps, &local_records, &counterexample);
+
+                    thread_stats[tid].stats.n_processed += ps.n_processed;
+                    thread_stats[tid].stats.total_checks += ps.total_checks;
+                    thread_stats[tid].stats.counterexamples += ps.counterexamples;
+                    thread_stats[tid].stats.sieve_hits += ps.sieve_hits;
+                    thread_stats[tid].stats.sieve_misses += ps.sieve_misses;
+
+                    local_progress += done - n;
+                    progress_monitor_publish(&monitor, tid, local_progress);
+                    n = done;
+
+                    if (ps.counterexamples > 0) {
+                        /* Counterexample found! Lanes in flight were drained */
+                        local_counterexamples += ps.counterexamples;
+                        work_queue_cancel(&queue);  /* Signal all threads to stop */
+                        report_counterexample(counterexample, tid);
+                        if (results) {
+                            result_log_counterexample(results, tid, counterexample,
+                                                      get_wall_time() - start_time);
+                        }
+                        break;
+                    }
+                }
+            }
+
+            /* Candidates for a above these bounds are below 2^32 / 2^63 in the whole chunk */
+            uint64_t a_floor32 = solve_a_floor32(chunk_end);
+            uint64_t a_floor63 = solve_a_floor63(chunk_end);
+
+            for (; !use_pipeline && n < chunk_end; n++) {
+                /* Check for early termination */
+                if (work_queue_cancelled(&queue)) break;
+
+                uint64_t a_max;
+                uint64_t a = solve_walk(&walker, n, a_floor32, a_floor63, &a_max);
+
+                if (a == 0) {
+                    /* Counterexample found! */
+                    local_counterexamples++;
+                    thread_stats[tid].stats.counterexamples++;
+                    work_queue_cancel(&queue);  /* Signal all threads to stop */
+                    report_counterexample(n, tid);
+                    if (results) {
+                        result_log_counterexample(results, tid, n,
+                                                  get_wall_time() - start_time);
+                    }
+                    n++;    /* This n is finished too */
+                    break;  /* This thread stops immediately */
+                }
 
-        /* Process this thread's range */
-        for (uint64_t n = my_start; n < my_end; n++) {
-            /* Check for early termination */
-            if (found_counterexample) break;
+                records_observe(&local_records, n, a, a_max, 8 * (__uint128_t)n + 3);
+                local_progress++;
+                progress_monitor_publish(&monitor, tid, local_progress);
+            }
 
-            uint64_t a = find_solution_parallel(n, tid, sieve);
+            /* Record the finished part of this chunk with its statistics */
+            CheckpointStats after = thread_stats_snapshot(tid);
+            CheckpointStats delta;
+            delta.n_processed = after.n_processed - before.n_processed;
+            delta.total_checks = after.total_checks - before.total_checks;
+            delta.counterexamples = after.counterexamples - before.counterexamples;
+            delta.sieve_hits = after.sieve_hits - before.sieve_hits;
+            delta.sieve_misses = after.sieve_misses - before.sieve_misses;
+
+            if (results && n > chunk_start) {
+                double now = get_wall_time();
+                result_log_chunk(results, tid, chunk_start, n, &delta,
+                                 chunk_time - start_time, now - chunk_time);
+            }
 
-            if (a == 0) {
-                /* Counterexample found! */
-                local_counterexamples++;
-                found_counterexample = 1;  /* Signal all threads to stop */
+            double save_elapsed = -1.0;
 #ifdef _OPENMP
-                #pragma omp critical
+            #pragma omp critical(checkpoint)
 #endif
-                {
-                    printf("\n*** COUNTEREXAMPLE FOUND! ***\n");
-                    printf("n = %s (thread %d)\n", fmt_num(n), tid);
-                    printf("N = 8n + 3 = %s\n", fmt_num(8*n + 3));
-                    printf("No valid (a, p) pair exists!\n\n");
-                    fflush(stdout);
+            {
+                /* An unrecorded chunk is redone on resume, but its stats are lost */
+                if (!checkpoint_add(cp, chunk_start, n, &delta) && !ledger_warned) {
+                    fprintf(stderr, "Warning: out of memory recording finished chunks; "
+                                    "checkpoint totals will be incomplete\n");
+                    ledger_warned = true;
                 }
-                break;  /* This thread stops immediately */
-            }
-
-            local_progress++;
 
-            /* Progress reporting (any thread can report, with locking) */
-            if ((local_progress & 0x3FFFF) == 0) {
-                double now;
+                if (checkpoint_path) {
+                    double now;
 #ifdef _OPENMP
-                now = omp_get_wtime();
+                    now = omp_get_wtime();
 #else
-                now = (double)clock() / CLOCKS_PER_SEC;
+                    now = (double)clock() / CLOCKS_PER_SEC;
 #endif
-                double elapsed = now - start_time;
+                    double elapsed = now - start_time;
+                    if (elapsed - last_save_time >= checkpoint_interval) {
+                        save_elapsed = elapsed;
+                        last_save_time = elapsed;
+                    }
+                }
+            }
 
-                /* Only one thread reports at a time */
-                if (elapsed - last_report_time >= PROGRESS_SECONDS) {
+            /* Write and fsync without holding up the other threads' records.
+               Copying inside the save section keeps the newest copy last. */
+            if (save_elapsed >= 0.0) {
 #ifdef _OPENMP
-                    #pragma omp critical
+                #pragma omp critical(checkpoint_save)
 #endif
-                    {
-                        /* Double-check timing inside critical section */
-                        if (elapsed - last_report_time >= PROGRESS_SECONDS) {
-                            /* Sum up all thread statistics */
-                            uint64_t sum_processed = 0;
-                            for (int t = 0; t < nthreads; t++) {
-                                sum_processed += thread_stats[t].n_processed;
-                            }
-
-                            double rate = sum_processed / elapsed;
-                            double pct = 100.0 * sum_processed / total;
-
-                            /* Calculate ETA */
-                            uint64_t remaining = total - sum_processed;
-                            double eta_seconds = (rate > 0) ? remaining / rate : 0;
-
-                            printf("[%d threads] n ~ %s (%.1f%%), rate = %s n/sec, ETA: %s\n",
-                                   nthreads, fmt_num(n_start + sum_processed), pct,
-                                   fmt_num((uint64_t)rate), fmt_time(eta_seconds));
-                            fflush(stdout);
-
-                            last_report_time = elapsed;
-                        }
+                {
+                    bool copied;
+#ifdef _OPENMP
+                    #pragma omp critical(checkpoint)
+#endif
+                    copied = checkpoint_copy(&snapshot, cp);
+
+                    if (!copied || !checkpoint_save(&snapshot, checkpoint_path, save_elapsed)) {
+                        fprintf(stderr, "Warning: failed to write checkpoint %s\n",
+                                checkpoint_path);
                     }
                 }
             }
         }
 
         total_counterexamples += local_counterexamples;
+
+#ifdef _OPENMP
+        #pragma omp critical(records)
+#endif
+        records_merge(records, &local_records);
+    }
+
+    active_queue = NULL;
+    progress_monitor_stop(&monitor);
+
+    double end_time;
+#ifdef _OPENMP
+    end_time = omp_get_wtime();
+#else
+    end_time = (double)clock() / CLOCKS_PER_SEC;
+#endif
+
+    /* Final save: covers completion, counterexamples and interruption */
+    if (checkpoint_path) {
+        if (checkpoint_save(cp, checkpoint_path, end_time - start_time)) {
+            printf("Checkpoint saved to %s (%s of %s n done)\n", checkpoint_path,
+                   fmt_num(checkpoint_done_count(cp)), fmt_num(total));
+        } else {
+            fprintf(stderr, "Warning: failed to write checkpoint %s\n", checkpoint_path);
+        }
     }
 
+    checkpoint_free(&snapshot);
+    free(pending);
     *out_counterexamples = total_counterexamples;
 }
 
+/* ========================================================================== */
+/* Spool Worker / Coordinator                                                 */
+/* ========================================================================== */
+
+/**
+ * Work through the units of a spool directory (spool.h): claim the lowest
+ * queued unit, search it with run_search_parallel() while a keeper thread
+ * renews its lease, and publish its results file. When the queue is empty
+ * the expired leases of other workers are requeued and claimed too; the
+ * worker exits once no unit is left to claim.
+ *
+ * A counterexample is published with its (partial) unit and stops the
+ * worker. On SIGINT/SIGTERM the current unit goes back to the queue.
+ * Totals over the published units go to totals, records and *units_done.
+ * Returns the exit code.
+ */
+static int run_spool_worker(const char *dir, const SpoolConfig *cfg, int num_threads,
+                            const PrimeSieve *sieve, const Placement *placement,
+                            int pipeline_width, CheckpointStats *totals,
+                            RecordTracker *records, int *units_done) {
+    char worker[320];
+    spool_worker_id(worker, sizeof(worker));
+    printf("Spool worker %s\n\n", worker);
+
+    while (!stop_requested) {
+        SpoolClaim claim;
+        if (!spool_claim(dir, worker, &claim)) {
+            SpoolStatus st;
+            if (!spool_scan(dir, cfg->lease_seconds, &st)) {
+                fprintf(stderr, "Error: cannot read spool %s\n", dir);
+                return 1;
+            }
+            if (st.expired > 0) continue;   /* Requeued a crashed worker's unit */
+            printf("Queue empty (%d units leased by other workers, %d of %u done)\n",
+                   st.leased, st.done, cfg->units);
+            return 0;
+        }
+        printf("Unit [%s, %s) claimed\n", fmt_num(claim.lo), fmt_num(claim.hi));
+
+        /* Results go to a private temporary file (a stale one is from a crash) */
+        char tmp_path[SPOOL_PATH_MAX];
+        ResultLog log;
+        bool opened = spool_results_tmp(tmp_path, dir, &claim, worker);
+        if (opened) {
+            remove(tmp_path);
+            opened = result_log_open(&log, tmp_path, num_threads);
+        }
+        if (!opened) {
+            fprintf(stderr, "Error: cannot write results for unit %s\n", claim.unit);
+            spool_release(dir, &claim);
+            return 1;
+        }
+
+        SpoolLease lease;
+        spool_lease_start(&lease, claim.lease_path, cfg->lease_seconds);
+
+        Checkpoint cp;
+        checkpoint_init(&cp, claim.lo, claim.hi);
+        RecordTracker unit_records;
+        records_init(&unit_records);
+        uint64_t counterexamples = 0;
+        double unit_start = get_wall_time();
+        run_search_parallel(&cp, num_threads, sieve, placement, pipeline_width,
+                            NULL, 0.0, &log, &unit_records, &counterexamples);
+        double unit_seconds = get_wall_time() - unit_start;
+        bool kept = spool_lease_stop(&lease);
+
+        ResultRecord summary = {RESULT_SUMMARY, num_threads, claim.lo, claim.hi,
+                                cp.stats, 0.0, unit_seconds, NULL};
+        bool written = result_log_close(&log, &summary, &unit_records);
+        bool finished = checkpoint_done_count(&cp) == claim.hi - claim.lo;
+        checkpoint_free(&cp);
+
+        /* Interrupted: the unit is redone by whoever claims it next */
+        if (counterexamples == 0 && (!finished || !written)) {
+            remove(tmp_path);
+            spool_release(dir, &claim);
+            if (!written) {
+                fprintf(stderr, "Error: results for unit %s are incomplete\n", claim.unit);
+                return 1;
+            }
+            printf("Unit [%s, %s) returned to the queue\n",
+                   fmt_num(claim.lo), fmt_num(claim.hi));
+            break;
+        }
+
+        if (!kept) {
+            fprintf(stderr, "Warning: lease of unit %s expired while searching "
+                            "(another worker may repeat it)\n", claim.unit);
+        }
+        if (!spool_publish(dir, &claim, tmp_path)) {
+            remove(tmp_path);
+            if (!kept && spool_is_done(dir, claim.unit)) {
+                continue;   /* The worker that took over published it first */
+            }
+            fprintf(stderr, "Error: cannot publish results for unit %s\n", claim.unit);
+            spool_release(dir, &claim);
+            return 1;
+        }
+        printf("Unit [%s, %s) published: %s n in %s (%s n/sec)\n\n",
+               fmt_num(claim.lo), fmt_num(claim.hi), fmt_num(cp.stats.n_processed),
+               fmt_time(unit_seconds),
+               fmt_num((uint64_t)(cp.stats.n_processed / (unit_seconds > 0 ? unit_seconds : 1))));
+
+        totals->n_processed += cp.stats.n_processed;
+        totals->total_checks += cp.stats.total_checks;
+        totals->counterexamples += cp.stats.counterexamples;
+        totals->sieve_hits += cp.stats.sieve_hits;
+        totals->sieve_misses += cp.stats.sieve_misses;
+        records_merge(records, &unit_records);
+        (*units_done)++;
+        if (counterexamples > 0) return 2;
+    }
+    return stop_requested ? 3 : 0;
+}
+
+/**
+ * Watch a spool directory: every lease / SPOOL_RENEW_FRACTION seconds,
+ * requeue expired leases and print the unit counts, until every unit is
+ * published. Returns the exit code (2 if any results list a counterexample).
+ */
+static int run_spool_coordinator(const char *dir) {
+    SpoolConfig cfg;
+    if (!spool_load_config(dir, &cfg)) {
+        fprintf(stderr, "Error: %s is not a spool directory (no valid spool.conf)\n", dir);
+        return 1;
+    }
+    printf("Spool %s: n in [%s, %s), %u units, lease %.0fs\n\n", dir,
+           fmt_num(cfg.n_start), fmt_num(cfg.n_end), cfg.units, cfg.lease_seconds);
+
+    double interval = cfg.lease_seconds / SPOOL_RENEW_FRACTION;
+    double start = get_wall_time();
+    int requeued = 0;
+    while (1) {
+        SpoolStatus st;
+        if (!spool_scan(dir, cfg.lease_seconds, &st)) {
+            fprintf(stderr, "Error: cannot read spool %s\n", dir);
+            return 1;
+        }
+        requeued += st.expired;
+        printf("[%s] %d queued, %d leased, %d of %u done (%.1f%%), %d requeued\n",
+               fmt_time(get_wall_time() - start), st.queued, st.leased, st.done,
+               cfg.units, 100.0 * st.done / cfg.units, requeued);
+        if (st.done >= (int)cfg.units) break;
+        if (st.queued == 0 && st.leased == 0 && st.expired == 0) {
+            fprintf(stderr, "Error: %u units are neither queued, leased nor done\n",
+                    cfg.units - (uint32_t)st.done);
+            return 1;
+        }
+
+        struct timespec pause = {(time_t)interval,
+                                 (long)((interval - (time_t)interval) * 1e9)};
+        nanosleep(&pause, NULL);
+    }
+
+    uint64_t counterexamples = spool_count_counterexamples(dir);
+    int stale = spool_remove_stale(dir);
+    printf("\nAll units done; %s counterexample%s\n", fmt_num(counterexamples),
+           counterexamples == 1 ? "" : "s");
+    if (stale > 0) {
+        printf("Removed %d temporary results file%s of crashed workers\n", stale,
+               stale == 1 ? "" : "s");
+    }
+    printf("Combine the results: ./merge --range %llu %llu %s/done/*.csv\n",
+           (unsigned long long)cfg.n_start, (unsigned long long)cfg.n_end, dir);
+    return counterexamples > 0 ? 2 : 0;
+}
+
 /* ========================================================================== */
 /* Verification                                                               */
 /* ========================================================================== */
@@ -364,6 +750,7 @@ bool verify_known_solutions(const PrimeSieve *sieve) {
     };
 
     bool all_pass = true;
+    SolveWalker walker = {sieve, thread_wheels, &thread_stats[0].stats, 0, interleaved_td};
 
     for (int i = 0; i < 4; i++) {
         uint64_t n = known[i].n;
@@ -377,7 +764,9 @@ bool verify_known_solutions(const PrimeSieve *sieve) {
         bool equation_valid = (lhs == rhs);
         bool p_is_prime = is_prime_64(expected_p);
 
-        uint64_t found_a = find_solution_parallel(n, 0, sieve);
+        uint64_t a_max;
+        uint64_t found_a = solve_walk(&walker, n, solve_a_floor32(n + 1),
+                                      solve_a_floor63(n + 1), &a_max);
 
         printf("  n=%llu: N=%llu, given (%llu,%llu), found a=%llu ... ",
                (unsigned long long)n, (unsigned long long)N,
@@ -408,6 +797,7 @@ uint64_t parse_number(const char* str) {
     if (*endptr != '\0') {
         return strtoull(str, NULL, 10);
     }
+    if (val >= 18446744073709551616.0) return UINT64_MAX;  /* 2^64: clamp */
     return (uint64_t)val;
 }
 
@@ -422,22 +812,75 @@ void print_usage(const char* program) {
     printf("Arguments:\n");
     printf("  n_start              Starting value of n (inclusive), default: 1e12\n");
     printf("  n_end                Ending value of n (exclusive), default: 1e12 + 1e7\n");
-    printf("  --threads N          Number of threads to use (default: all cores)\n");
+    printf("  --threads N          Number of threads to use (default: all CPUs,\n");
+    printf("                       capped by the cgroup CPU quota)\n");
+    printf("  --affinity POLICY    Pin threads to CPUs: compact (fill a core's SMT\n");
+    printf("                       siblings and one socket first), scatter (spread\n");
+    printf("                       over cores and sockets), cores-only (one thread\n");
+    printf("                       per physical core). A built sieve is replicated\n");
+    printf("                       into each NUMA node the threads use\n");
+    printf("  --pipeline K         Keep K n searches in flight per thread and batch\n");
+    printf("                       their Miller-Rabin tests (K = %d..%d, default: off;\n",
+           PIPELINE_MIN_WIDTH, PIPELINE_MAX_WIDTH);
+    printf("                       n >= 2^61 always runs one n at a time)\n");
     printf("  --sieve-threshold T  Pre-compute prime sieve up to T for O(1) lookups\n");
     printf("                       Recommended values: 1e7 (1MB), 1e8 (12MB), 1e9 (125MB)\n");
+    printf("  --generate-sieve FILE  Build the sieve for --sieve-threshold T, save it\n");
+    printf("                       to FILE and exit\n");
+    printf("  --sieve-file FILE    Map a sieve saved by --generate-sieve (read-only,\n");
+    printf("                       shared by concurrent runs, no build time)\n");
+    printf("  --sieve-verify       Check the sieve file's bitmap checksum on open\n");
+    printf("  --checkpoint FILE    Record finished sub-ranges in FILE (atomic, crash-safe)\n");
+    printf("  --checkpoint-interval S  Seconds between checkpoint saves (default: 60)\n");
+    printf("  --results FILE       Append per-chunk statistics, counterexamples and a\n");
+    printf("                       run summary to FILE as CSV (background writer)\n");
+    printf("  --shard I/K          Search only shard I (1..K) of K contiguous shards of\n");
+    printf("                       equal estimated cost (deterministic on every machine;\n");
+    printf("                       combine the shards' --results files with merge)\n");
+    printf("  --resume FILE        Resume the search recorded in FILE; only unfinished\n");
+    printf("                       sub-ranges are searched (keeps saving to FILE unless\n");
+    printf("                       --checkpoint is given)\n");
+    printf("  --spool-init DIR     Split [n_start, n_end) into work-unit files in DIR\n");
+    printf("                       for --spool-work processes, then exit\n");
+    printf("  --spool-units K      Units for --spool-init (default: %d)\n", SPOOL_DEFAULT_UNITS);
+    printf("  --spool-lease S      Lease length in seconds for --spool-init; a unit not\n");
+    printf("                       renewed for S seconds is requeued (default: %.0f)\n",
+           SPOOL_DEFAULT_LEASE);
+    printf("  --spool-work DIR     Claim, search and publish units of DIR until none is\n");
+    printf("                       left (any number of workers, on any host sharing DIR)\n");
+    printf("  --spool-coordinate DIR  Requeue expired leases and report progress until\n");
+    printf("                       every unit of DIR is done\n");
+    printf("  --no-wheel           Trial-divide every candidate instead of skipping the\n");
+    printf("                       multiples of 3-127 with the a-walk wheel\n");
+    printf("  --interleaved-td     Trial-divide candidates below 2^52 by 131-467 on the\n");
+    printf("                       FP units during Miller-Rabin (~1-7%% per test, off by default)\n");
+    printf("  --print-dispatch     Show the CPU level and the kernel variants chosen\n");
+    printf("                       (make portable builds x86-64-v2/v3/v4 clones)\n");
     printf("\n");
     printf("Numbers can be in scientific notation (e.g., 1e9, 2.5e6)\n");
+    printf("n can go up to 2^64 - 1 (N = 8n + 3 uses 128 bits past n = 2^61)\n");
     printf("\n");
     printf("Examples:\n");
     printf("  %s                        Search [10^12, 10^12 + 10^7) with all cores\n", program);
     printf("  %s 1 1e6                  Search [1, 10^6)\n", program);
     printf("  %s 1e9 2e9 --threads 4    Search [10^9, 2*10^9) with 4 threads\n", program);
+    printf("  %s 1e12 2e12 --affinity cores-only     One pinned thread per core\n", program);
     printf("  %s 1e12 1.001e12 --sieve-threshold 1e8  Use 12MB prime sieve\n", program);
+    printf("  %s --generate-sieve s1e10.bin --sieve-threshold 1e10  Save a sieve once\n", program);
+    printf("  %s 1e15 2e15 --sieve-file s1e10.bin    Share it across runs\n", program);
+    printf("  %s 1e12 1.001e12 --pipeline 8          Interleave 8 n per thread\n", program);
+    printf("  %s 1e15 2e15 --checkpoint run.ckpt     Checkpoint a multi-day run\n", program);
+    printf("  %s --resume run.ckpt                   Continue after a crash or Ctrl-C\n", program);
+    printf("  %s 1e12 2e12 --results run.csv         Machine-readable results\n", program);
+    printf("  %s 1e15 2e15 --shard 3/8 --results s3.csv  Third of 8 machines\n", program);
+    printf("  %s 1e15 2e15 --spool-init spool      Work units for a worker fleet\n", program);
+    printf("  %s --spool-work spool                Run one worker (start any number)\n", program);
     printf("\n");
     printf("Exit codes:\n");
     printf("  0  Search completed, no counterexamples found\n");
     printf("  1  Error (invalid arguments, verification failure)\n");
     printf("  2  Counterexample found\n");
+    printf("  3  Interrupted by SIGINT/SIGTERM (checkpoint saved, or spool unit requeued)\n");
 }
 
 /* ========================================================================== */
@@ -449,14 +892,30 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
 
     printf("==================================================================\n");
-    printf("     Counterexample Search: 8n + 3 = a^2 + 2p                     \n");
+    printf("     Counterexample Search: 8n + 3 = a^2 + 2p   v%s\n", SEARCH8N3_VERSION);
     printf("     Optimized with FJ64_262K primality test (OpenMP parallel)    \n");
     printf("==================================================================\n\n");
 
     uint64_t n_start = DEFAULT_N_START;
     uint64_t n_end = DEFAULT_N_END;
     int num_threads = 0;  /* 0 = auto-detect */
+    int pipeline_width = 0;  /* 0 = one n at a time */
     uint64_t sieve_threshold = 0;  /* 0 = no sieve */
+    const char *sieve_file_path = NULL;
+    const char *generate_sieve_path = NULL;
+    bool sieve_verify = false;
+    bool print_dispatch = false;
+    bool use_wheel = true;
+    const char *checkpoint_path = NULL;
+    const char *resume_path = NULL;
+    const char *results_path = NULL;
+    double checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+    uint32_t shard_index = 0, shard_count = 0;  /* 0 = whole range */
+    const char *spool_init_dir = NULL;
+    const char *spool_work_dir = NULL;
+    const char *spool_coordinate_dir = NULL;
+    SpoolConfig spool = {0, 0, SPOOL_DEFAULT_UNITS, SPOOL_DEFAULT_LEASE};
+    static Placement placement;     /* Large (CPU tables): not on the stack */
 
     /* Handle help flag */
     if (argc >= 2 && (strcmp(argv[1], "-h") == 0 ||
@@ -471,9 +930,84 @@ int main(int argc, char** argv) {
         if (strcmp(argv[arg_idx], "--threads") == 0 && arg_idx + 1 < argc) {
             num_threads = atoi(argv[arg_idx + 1]);
             arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--affinity") == 0 && arg_idx + 1 < argc) {
+            TopologyAffinity policy;
+            if (!topology_parse_affinity(argv[arg_idx + 1], &policy)) {
+                fprintf(stderr, "Error: unknown --affinity policy %s "
+                                "(compact, scatter or cores-only)\n", argv[arg_idx + 1]);
+                return 1;
+            }
+            topology_detect(&placement.topo);
+            topology_set_affinity(&placement.topo, policy);
+            placement.pin = true;
+            arg_idx += 2;
         } else if (strcmp(argv[arg_idx], "--sieve-threshold") == 0 && arg_idx + 1 < argc) {
             sieve_threshold = parse_number(argv[arg_idx + 1]);
             arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--sieve-file") == 0 && arg_idx + 1 < argc) {
+            sieve_file_path = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--generate-sieve") == 0 && arg_idx + 1 < argc) {
+            generate_sieve_path = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--sieve-verify") == 0) {
+            sieve_verify = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--print-dispatch") == 0) {
+            print_dispatch = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--interleaved-td") == 0) {
+            interleaved_td = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--no-wheel") == 0) {
+            use_wheel = false;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--pipeline") == 0 && arg_idx + 1 < argc) {
+            pipeline_width = atoi(argv[arg_idx + 1]);
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--checkpoint") == 0 && arg_idx + 1 < argc) {
+            checkpoint_path = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--checkpoint-interval") == 0 && arg_idx + 1 < argc) {
+            checkpoint_interval = atof(argv[arg_idx + 1]);
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--resume") == 0 && arg_idx + 1 < argc) {
+            resume_path = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--results") == 0 && arg_idx + 1 < argc) {
+            results_path = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--shard") == 0 && arg_idx + 1 < argc) {
+            if (!shard_parse(argv[arg_idx + 1], &shard_index, &shard_count)) {
+                fprintf(stderr, "Error: --shard needs I/K with 1 <= I <= K <= %d\n",
+                        SHARD_MAX);
+                return 1;
+            }
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--spool-init") == 0 && arg_idx + 1 < argc) {
+            spool_init_dir = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--spool-units") == 0 && arg_idx + 1 < argc) {
+            uint64_t units = parse_number(argv[arg_idx + 1]);
+            if (units < 1 || units > SHARD_MAX) {
+                fprintf(stderr, "Error: --spool-units needs 1..%d\n", SHARD_MAX);
+                return 1;
+            }
+            spool.units = (uint32_t)units;
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--spool-lease") == 0 && arg_idx + 1 < argc) {
+            spool.lease_seconds = atof(argv[arg_idx + 1]);
+            if (spool.lease_seconds < 1) {
+                fprintf(stderr, "Error: --spool-lease needs at least 1 second\n");
+                return 1;
+            }
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--spool-work") == 0 && arg_idx + 1 < argc) {
+            spool_work_dir = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--spool-coordinate") == 0 && arg_idx + 1 < argc) {
+            spool_coordinate_dir = argv[arg_idx + 1];
+            arg_idx += 2;
         } else if (argv[arg_idx][0] == '-') {
             fprintf(stderr, "Unknown option: %s\n", argv[arg_idx]);
             print_usage(argv[0]);
@@ -490,12 +1024,37 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (print_dispatch) {
+        dispatch_print(stdout);
+        dispatch_print_row(stdout, "vector trial division (8 steps)",
+                           trial_vector_available() ? "avx512f,avx512dq" : "scalar");
+        dispatch_print_row(stdout, "pipeline MR below 2^52 (8 lanes)",
+                           prime_ifma_available() ? "avx512ifma" : "scalar");
+        dispatch_print_row(stdout, "Montgomery kernel (MONTGOMERY_KERNEL)",
+                           MONTGOMERY_KERNEL_NAMES[MONTGOMERY_KERNEL]);
+        return 0;
+    }
+
     /* Re-parse positional args more carefully */
     arg_idx = 1;
     int pos_count = 0;
     while (arg_idx < argc) {
         if (strcmp(argv[arg_idx], "--threads") == 0 ||
-            strcmp(argv[arg_idx], "--sieve-threshold") == 0) {
+            strcmp(argv[arg_idx], "--affinity") == 0 ||
+            strcmp(argv[arg_idx], "--sieve-threshold") == 0 ||
+            strcmp(argv[arg_idx], "--sieve-file") == 0 ||
+            strcmp(argv[arg_idx], "--generate-sieve") == 0 ||
+            strcmp(argv[arg_idx], "--pipeline") == 0 ||
+            strcmp(argv[arg_idx], "--checkpoint") == 0 ||
+            strcmp(argv[arg_idx], "--checkpoint-interval") == 0 ||
+            strcmp(argv[arg_idx], "--resume") == 0 ||
+            strcmp(argv[arg_idx], "--results") == 0 ||
+            strcmp(argv[arg_idx], "--shard") == 0 ||
+            strcmp(argv[arg_idx], "--spool-init") == 0 ||
+            strcmp(argv[arg_idx], "--spool-units") == 0 ||
+            strcmp(argv[arg_idx], "--spool-lease") == 0 ||
+            strcmp(argv[arg_idx], "--spool-work") == 0 ||
+            strcmp(argv[arg_idx], "--spool-coordinate") == 0) {
             arg_idx += 2;
             continue;
         }
@@ -517,18 +1076,130 @@ int main(int argc, char** argv) {
         n_end = n_start + 10000000;
     }
 
-    if (n_start >= n_end) {
-        fprintf(stderr, "Error: n_start must be less than n_end\n");
+    /* Narrow to this shard (before --resume compares the checkpoint's range) */
+    uint64_t full_start = n_start, full_end = n_end;
+    if (shard_count > 0) {
+        if (n_start >= n_end) {
+            fprintf(stderr, "Error: n_start must be less than n_end\n");
+            return 1;
+        }
+        shard_bounds(full_start, full_end, shard_index, shard_count, &n_start, &n_end);
+        if (n_start >= n_end) {
+            fprintf(stderr, "Error: shard %u/%u of [%s, %s) is empty\n", shard_index,
+                    shard_count, fmt_num(full_start), fmt_num(full_end));
+            return 1;
+        }
+    }
+
+    /* Generator mode: build the sieve with sieve_create(), save it, exit */
+    if (generate_sieve_path) {
+        if (sieve_threshold == 0) {
+            fprintf(stderr, "Error: --generate-sieve needs --sieve-threshold T\n");
+            return 1;
+        }
+        printf("Creating prime sieve up to %s...\n", fmt_num(sieve_threshold));
+        double gen_start = get_wall_time();
+        PrimeSieve *gen = sieve_create(sieve_threshold);
+        if (!gen) {
+            fprintf(stderr, "Error: Failed to allocate prime sieve\n");
+            return 1;
+        }
+        printf("  Sieve created in %.2f seconds\n", get_wall_time() - gen_start);
+        printf("  Primes found: %s\n", fmt_num(sieve_prime_count(gen)));
+        bool saved = sieve_file_save(gen, generate_sieve_path);
+        sieve_destroy(gen);
+        if (!saved) {
+            fprintf(stderr, "Error: cannot write sieve file %s\n", generate_sieve_path);
+            return 1;
+        }
+        printf("  Saved to %s (%s bytes)\n", generate_sieve_path,
+               fmt_num(SIEVE_FILE_DATA_OFFSET + sieve_threshold / 30 + 1));
+        return 0;
+    }
+    if (sieve_file_path && sieve_threshold > 0) {
+        fprintf(stderr, "Error: --sieve-file and --sieve-threshold are exclusive "
+                        "(the file sets the threshold)\n");
         return 1;
     }
 
-    /* Determine number of threads */
+    /* Spool set-up and coordination modes: no search in this process */
+    if (spool_init_dir) {
+        if (n_start >= n_end) {
+            fprintf(stderr, "Error: n_start must be less than n_end\n");
+            return 1;
+        }
+        spool.n_start = n_start;
+        spool.n_end = n_end;
+        const char *err;
+        if (!spool_create(spool_init_dir, &spool, &err)) {
+            fprintf(stderr, "Error: spool %s: %s\n", spool_init_dir, err);
+            return 1;
+        }
+        printf("Spool %s: n in [%s, %s), %u units of equal estimated cost, lease %.0fs\n",
+               spool_init_dir, fmt_num(n_start), fmt_num(n_end), spool.units,
+               spool.lease_seconds);
+        printf("Start workers with: %s --spool-work %s\n", argv[0], spool_init_dir);
+        return 0;
+    }
+    if (spool_coordinate_dir) {
+        return run_spool_coordinator(spool_coordinate_dir);
+    }
+
+    /* A spool worker searches the spool's range, one claimed unit at a time */
+    if (spool_work_dir) {
+        if (resume_path || checkpoint_path || results_path || shard_count > 0) {
+            fprintf(stderr, "Error: --spool-work takes its range and results from the "
+                            "spool (no --resume, --checkpoint, --results or --shard)\n");
+            return 1;
+        }
+        if (!spool_load_config(spool_work_dir, &spool)) {
+            fprintf(stderr, "Error: %s is not a spool directory (no valid spool.conf)\n",
+                    spool_work_dir);
+            return 1;
+        }
+        n_start = spool.n_start;
+        n_end = spool.n_end;
+    }
+
+    /* Load the checkpoint to resume from, or start a fresh ledger */
+    Checkpoint cp;
+    if (resume_path) {
+        if (!checkpoint_load(&cp, resume_path)) {
+            fprintf(stderr, "Error: cannot read checkpoint %s\n", resume_path);
+            return 1;
+        }
+        if (pos_count > 0 && (n_start != cp.n_start || n_end != cp.n_end)) {
+            fprintf(stderr, "Error: range does not match checkpoint [%s, %s)\n",
+                    fmt_num(cp.n_start), fmt_num(cp.n_end));
+            checkpoint_free(&cp);
+            return 1;
+        }
+        n_start = cp.n_start;
+        n_end = cp.n_end;
+        if (!checkpoint_path) checkpoint_path = resume_path;
+    } else {
+        if (n_start >= n_end) {
+            fprintf(stderr, "Error: n_start must be less than n_end\n");
+            return 1;
+        }
+        checkpoint_init(&cp, n_start, n_end);
+    }
+
+    if (pipeline_width < 0) pipeline_width = 0;
+    if (pipeline_width > 0 && pipeline_width < PIPELINE_MIN_WIDTH) pipeline_width = PIPELINE_MIN_WIDTH;
+    if (pipeline_width > PIPELINE_MAX_WIDTH) pipeline_width = PIPELINE_MAX_WIDTH;
+
+    if (checkpoint_interval <= 0) {
+        checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+    }
+
+    /* Determine number of threads: by default one per pin slot within the CPU quota */
+    if (!placement.pin) topology_detect(&placement.topo);
 #ifdef _OPENMP
     if (num_threads <= 0) {
         num_threads = omp_get_max_threads();
-    }
-    if (num_threads > MAX_THREADS) {
-        num_threads = MAX_THREADS;
+        int fit = topology_default_threads(&placement.topo);
+        if (num_threads > fit) num_threads = fit;
     }
 #else
     num_threads = 1;
@@ -537,57 +1208,195 @@ int main(int argc, char** argv) {
     }
 #endif
 
+    thread_stats = (ThreadStats *)aligned_alloc(64, (size_t)num_threads * sizeof(ThreadStats));
+    if (!thread_stats || !SC_ALLOC(num_threads)) {
+        fprintf(stderr, "Error: Failed to allocate statistics for %d threads\n", num_threads);
+        checkpoint_free(&cp);
+        return 1;
+    }
+    memset(thread_stats, 0, (size_t)num_threads * sizeof(ThreadStats));
+
+    if (use_wheel) {
+        trial_wheel_init();
+        thread_wheels = (TrialWheel *)calloc((size_t)num_threads, sizeof(TrialWheel));
+        if (!thread_wheels) {
+            fprintf(stderr, "Error: Failed to allocate the a-walk wheels\n");
+            free(thread_stats);
+            checkpoint_free(&cp);
+            return 1;
+        }
+        for (int t = 0; t < num_threads; t++) trial_wheel_reset(&thread_wheels[t]);
+    }
+
     uint64_t total = n_end - n_start;
+    uint64_t prior_done = checkpoint_done_count(&cp);
+    uint64_t run_total = total - prior_done;
 
-    /* Create prime sieve if requested */
+    /* Map the sieve file, or create a prime sieve if requested */
     PrimeSieve *sieve = NULL;
-    if (sieve_threshold > 0) {
+    if (sieve_file_path) {
+        printf("Mapping prime sieve %s...\n", sieve_file_path);
+        double sieve_start = get_wall_time();
+        const char *err;
+        sieve = sieve_file_open(sieve_file_path, sieve_verify, &err);
+        if (!sieve) {
+            fprintf(stderr, "Error: sieve file %s: %s\n", sieve_file_path, err);
+            checkpoint_free(&cp);
+            return 1;
+        }
+        sieve_threshold = sieve->threshold;
+        printf("  Sieve mapped in %.3f seconds%s\n", get_wall_time() - sieve_start,
+               sieve_verify ? " (checksum verified)" : "");
+        printf("  Threshold: %s\n", fmt_num(sieve_threshold));
+        printf("  Shared mapping: %s\n", sieve_memory_str(sieve));
+        printf("  Primes: %s\n", fmt_num(sieve_prime_count(sieve)));
+        printf("\n");
+    } else if (sieve_threshold > 0) {
         printf("Creating prime sieve up to %s...\n", fmt_num(sieve_threshold));
-        double sieve_start;
-#ifdef _OPENMP
-        sieve_start = omp_get_wtime();
-#else
-        sieve_start = (double)clock() / CLOCKS_PER_SEC;
-#endif
+        double sieve_start = get_wall_time();
         sieve = sieve_create(sieve_threshold);
-        double sieve_end;
-#ifdef _OPENMP
-        sieve_end = omp_get_wtime();
-#else
-        sieve_end = (double)clock() / CLOCKS_PER_SEC;
-#endif
         if (!sieve) {
             fprintf(stderr, "Error: Failed to allocate prime sieve\n");
+            checkpoint_free(&cp);
             return 1;
         }
-        printf("  Sieve created in %.2f seconds\n", sieve_end - sieve_start);
+        printf("  Sieve created in %.2f seconds\n", get_wall_time() - sieve_start);
         printf("  Memory usage: %s\n", sieve_memory_str(sieve));
         printf("  Primes found: %s\n", fmt_num(sieve_prime_count(sieve)));
+
+        /* One copy per NUMA node the pinned threads use; the original goes */
+        int replicas = placement_replicate_sieve(&placement, sieve, num_threads);
+        if (replicas > 0) {
+            sieve_destroy(sieve);
+            sieve = placement.replica[topology_slot_node(&placement.topo, 0)];
+            printf("  Replicated on %d NUMA nodes (%s each)\n", replicas,
+                   sieve_memory_str(sieve));
+        }
         printf("\n");
     }
 
     printf("Configuration:\n");
     printf("  Range: n in [%s, %s)\n", fmt_num(n_start), fmt_num(n_end));
+    if (shard_count > 0) {
+        printf("  Shard: %u of %u of [%s, %s) (%.2f%% of the estimated cost)\n",
+               shard_index, shard_count, fmt_num(full_start), fmt_num(full_end),
+               100.0 * (double)shard_cost(n_start, n_end) /
+                       (double)shard_cost(full_start, full_end));
+    }
     printf("  Count: %s values\n", fmt_num(total));
+    if (n_end > SOLVE_N64_LIMIT) {
+        printf("  N = 8n + 3: up to %s (128-bit past n = 2^61)\n",
+               fmt_num128(8 * (__uint128_t)(n_end - 1) + 3));
+    }
+    if (resume_path) {
+        printf("  Resumed: %s already done (%.1f%%), %s remaining\n",
+               fmt_num(prior_done), 100.0 * prior_done / total, fmt_num(run_total));
+    }
+    if (checkpoint_path) {
+        printf("  Checkpoint: %s (every %.0fs and on SIGINT/SIGTERM)\n",
+               checkpoint_path, checkpoint_interval);
+    }
+    if (results_path) {
+        printf("  Results: %s (CSV, background writer)\n", results_path);
+    }
+    if (spool_work_dir) {
+        printf("  Spool: %s (%u units, lease %.0fs)\n", spool_work_dir, spool.units,
+               spool.lease_seconds);
+    }
     printf("  Threads: %d\n", num_threads);
+    if (placement.pin) {
+        const CpuTopology *topo = &placement.topo;
+        printf("  Affinity: %s, %d threads on %d core%s of %d (%d CPU%s, %d NUMA node%s)\n",
+               topology_affinity_name(topo->policy), num_threads,
+               topology_cores_used(topo, num_threads),
+               topology_cores_used(topo, num_threads) == 1 ? "" : "s",
+               topo->num_cores, topo->num_cpus, topo->num_cpus == 1 ? "" : "s",
+               topo->num_nodes, topo->num_nodes == 1 ? "" : "s");
+        if (num_threads > topo->num_slots) {
+            printf("  Warning: %d threads share %d pin slots\n", num_threads, topo->num_slots);
+        }
+    }
+    if (placement.topo.cpu_quota > 0) {
+        printf("  CPU quota: %.2f CPUs (cgroup cpu.max)\n", placement.topo.cpu_quota);
+    }
+    if (pipeline_width > 0) {
+        printf("  Pipeline: %d n in flight per thread (batched Miller-Rabin%s)\n",
+               pipeline_width, n_end > SOLVE_N64_LIMIT ? "; per-n past 2^61" : "");
+    }
     if (sieve) {
         printf("  Primality test: Sieve lookup (up to %s) + FJ64_262K\n",
                fmt_num(sieve_threshold));
     } else {
         printf("  Primality test: FJ64_262K (2 Miller-Rabin tests)\n");
     }
+    printf("  Trial division: %s\n", use_wheel ? "a-walk wheel (64-step skip masks, 3-127)"
+           : trial_vector_available() ? "8 steps at a time (AVX-512)" : "per candidate");
+    if (interleaved_td) {
+        printf("  Interleaved TD: primes 131-467 on the FP units for candidates < 2^52\n");
+    }
     printf("\n");
 
     /* Verify algorithm correctness */
     if (!verify_known_solutions(sieve)) {
         fprintf(stderr, "\nERROR: Verification failed!\n");
-        if (sieve) sieve_destroy(sieve);
+        placement_release(&placement, sieve);
+        checkpoint_free(&cp);
         return 1;
     }
     printf("\n");
 
+    /* Stop gracefully (and save the checkpoint) on Ctrl-C or kill */
+    if (checkpoint_path || spool_work_dir) {
+        signal(SIGINT, handle_stop_signal);
+        signal(SIGTERM, handle_stop_signal);
+    }
+
+    /* Spool worker: units until the queue is empty, then a summary */
+    if (spool_work_dir) {
+        CheckpointStats totals = {0};
+        RecordTracker records;
+        records_init(&records);
+        int units_done = 0;
+        SC_RESET();
+        double work_start = get_wall_time();
+        int exit_code = run_spool_worker(spool_work_dir, &spool, num_threads, sieve,
+                                         &placement, pipeline_width, &totals, &records,
+                                         &units_done);
+        double work_elapsed = get_wall_time() - work_start;
+
+        printf("\n");
+        printf("==================================================================\n");
+        printf("RESULTS (this worker)\n");
+        printf("==================================================================\n\n");
+        printf("Units published:      %d\n", units_done);
+        printf("n processed:          %s\n", fmt_num(totals.n_processed));
+        printf("Total time:           %s\n", fmt_time(work_elapsed));
+        printf("Total throughput:     %s n/sec\n",
+               fmt_num((uint64_t)(totals.n_processed / (work_elapsed > 0 ? work_elapsed : 1))));
+        printf("Counterexamples:      %s\n", fmt_num(totals.counterexamples));
+        records_print(&records);
+        if (exit_code == 3) {
+            printf("\nInterrupted: the unfinished unit is back in the queue\n");
+        }
+
+        placement_release(&placement, sieve);
+        free(thread_stats);
+        free(thread_wheels);
+        checkpoint_free(&cp);
+        return exit_code;
+    }
+
     /* Run search */
+    ResultLog results;
+    if (results_path && !result_log_open(&results, results_path, num_threads)) {
+        fprintf(stderr, "Error: cannot write results file %s\n", results_path);
+        placement_release(&placement, sieve);
+        checkpoint_free(&cp);
+        return 1;
+    }
+
     printf("Starting parallel search...\n\n");
+    SC_RESET();     /* Drop the counts of verify_known_solutions() */
 
     double global_start;
 #ifdef _OPENMP
@@ -597,7 +1406,11 @@ int main(int argc, char** argv) {
 #endif
 
     uint64_t total_counterexamples = 0;
-    run_search_parallel(n_start, n_end, num_threads, sieve, &total_counterexamples);
+    RecordTracker records;
+    records_init(&records);
+    run_search_parallel(&cp, num_threads, sieve, &placement, pipeline_width,
+                        checkpoint_path, checkpoint_interval,
+                        results_path ? &results : NULL, &records, &total_counterexamples);
 
     double global_end;
 #ifdef _OPENMP
@@ -611,13 +1424,24 @@ int main(int argc, char** argv) {
     uint64_t stat_n = 0, stat_checks = 0;
     uint64_t stat_sieve_hits = 0, stat_sieve_misses = 0;
     for (int t = 0; t < num_threads; t++) {
-        stat_n += thread_stats[t].n_processed;
-        stat_checks += thread_stats[t].total_checks;
-        stat_sieve_hits += thread_stats[t].sieve_hits;
-        stat_sieve_misses += thread_stats[t].sieve_misses;
+        stat_n += thread_stats[t].stats.n_processed;
+        stat_checks += thread_stats[t].stats.total_checks;
+        stat_sieve_hits += thread_stats[t].stats.sieve_hits;
+        stat_sieve_misses += thread_stats[t].stats.sieve_misses;
     }
     double avg_checks = (stat_n > 0) ? (double)stat_checks / stat_n : 0.0;
 
+    /* Drain the result log and append the run summary */
+    if (results_path) {
+        ResultRecord summary = {RESULT_SUMMARY, num_threads, n_start, n_end,
+                                {stat_n, stat_checks, total_counterexamples,
+                                 stat_sieve_hits, stat_sieve_misses},
+                                0.0, global_elapsed, NULL};
+        if (!result_log_close(&results, &summary, &records)) {
+            fprintf(stderr, "Warning: results file %s is incomplete\n", results_path);
+        }
+    }
+
     /* Print results */
     printf("\n");
     printf("==================================================================\n");
@@ -627,9 +1451,9 @@ int main(int argc, char** argv) {
     printf("Total time:           %.2f seconds\n", global_elapsed);
     printf("Threads used:         %d\n", num_threads);
     printf("Total throughput:     %s n/sec\n",
-           fmt_num((uint64_t)(total / global_elapsed)));
+           fmt_num((uint64_t)(stat_n / global_elapsed)));
     printf("Per-thread avg:       %s n/sec\n",
-           fmt_num((uint64_t)(total / global_elapsed / num_threads)));
+           fmt_num((uint64_t)(stat_n / global_elapsed / num_threads)));
     printf("Counterexamples:      %s\n", fmt_num(total_counterexamples));
     printf("Avg checks per n:     %.2f\n", avg_checks);
     printf("Total a's checked:    %s\n", fmt_num(stat_checks));
@@ -645,10 +1469,43 @@ int main(int argc, char** argv) {
         printf("  Sieve threshold:    %s\n", fmt_num(sieve_threshold));
     }
 
-    /* Clean up */
-    if (sieve) {
-        sieve_destroy(sieve);
+    /* Top-K hardest n of this run */
+    records_print(&records);
+
+#ifdef SEARCH_COUNTERS
+    search_counters_print(num_threads, stat_n);
+    if (pipeline_width > 0) {
+        printf("  (--pipeline batches are not counted)\n");
+    }
+#endif
+
+    /* Cumulative statistics across all runs of a resumed search */
+    if (resume_path) {
+        double cum_elapsed = cp.elapsed + global_elapsed;
+        double cum_avg_checks = (cp.stats.n_processed > 0)
+            ? (double)cp.stats.total_checks / cp.stats.n_processed : 0.0;
+        printf("\nCumulative (all runs):\n");
+        printf("  Done:               %s of %s n (%.1f%%)\n",
+               fmt_num(checkpoint_done_count(&cp)), fmt_num(total),
+               100.0 * checkpoint_done_count(&cp) / total);
+        printf("  Total time:         %s\n", fmt_time(cum_elapsed));
+        printf("  Throughput:         %s n/sec\n",
+               fmt_num((uint64_t)(cp.stats.n_processed / cum_elapsed)));
+        printf("  Counterexamples:    %s\n", fmt_num(cp.stats.counterexamples));
+        printf("  Avg checks per n:   %.2f\n", cum_avg_checks);
     }
 
-    return (total_counterexamples > 0) ? 2 : 0;
+    int exit_code = (cp.stats.counterexamples > 0) ? 2 : 0;
+    if (stop_requested && exit_code == 0) {
+        printf("\nInterrupted: resume with --resume %s\n", checkpoint_path);
+        exit_code = 3;
+    }
+
+    /* Clean up */
+    placement_release(&placement, sieve);
+    free(thread_stats);
+    free(thread_wheels);
+    checkpoint_free(&cp);
+
+    return exit_code;
 }
@@ -7,10 +7,15 @@
  * This approach is optimized for exhaustive verification (checking ALL n
  * in a range) rather than per-n early exit.
  *
+ * --shard i/k and --results FILE work as in search.c, so batched shards
+ * can be combined with the merge tool (one chunk row per batch).
+ *
  * Compile: make search_batched
- * Usage:   ./search_batched [n_start] [n_end] [--batch-size N]
+ * Usage:   ./search_batched [n_start] [n_end] [--batch-size N] [--shard I/K]
  */
 
+#define _POSIX_C_SOURCE 200809L  /* pthreads, nanosleep (result_log.h) */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -27,6 +32,9 @@
 #include "arith.h"
 #include "prime.h"
 #include "batch_sieve.h"
+#include "records.h"       /* Top-K hardest n */
+#include "result_log.h"    /* --results CSV */
+#include "shard.h"         /* --shard i/k */
 
 /* ========================================================================== */
 /* Configuration                                                              */
@@ -46,6 +54,17 @@
 /* Time Formatting                                                            */
 /* ========================================================================== */
 
+/**
+ * Wall-clock seconds (CPU seconds without OpenMP)
+ */
+static double get_wall_time(void) {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
 static const char* fmt_time(double seconds) {
     static char buf[64];
 
@@ -92,6 +111,8 @@ void print_usage(const char* program) {
     printf("  n_start            Starting value of n (inclusive), default: 1e9\n");
     printf("  n_end              Ending value of n (exclusive), default: 1e9 + 1e7\n");
     printf("  --batch-size N     Batch size (default: 65536)\n");
+    printf("  --shard I/K        Search only shard I (1..K) of K equal-cost shards\n");
+    printf("  --results FILE     Append per-batch rows and a summary to FILE as CSV\n");
     printf("\n");
     printf("Numbers can be in scientific notation (e.g., 1e9, 2.5e6)\n");
     printf("\n");
@@ -99,6 +120,7 @@ void print_usage(const char* program) {
     printf("  %s                        Search [10^9, 10^9 + 10^7)\n", program);
     printf("  %s 1 1e6                  Search [1, 10^6)\n", program);
     printf("  %s 1e9 2e9 --batch-size 131072  Use larger batches\n", program);
+    printf("  %s 1e9 2e9 --shard 2/4 --results s2.csv  Second of 4 shards\n", program);
     printf("\n");
     printf("Exit codes:\n");
     printf("  0  Search completed, no counterexamples found\n");
@@ -135,6 +157,8 @@ int main(int argc, char** argv) {
     uint64_t n_start = DEFAULT_N_START;
     uint64_t n_end = DEFAULT_N_END;
     uint64_t batch_size = DEFAULT_BATCH_SIZE;
+    uint32_t shard_index = 0, shard_count = 0;  /* 0 = whole range */
+    const char *results_path = NULL;
 
     /* Handle help flag */
     if (argc >= 2 && (strcmp(argv[1], "-h") == 0 ||
@@ -150,6 +174,16 @@ int main(int argc, char** argv) {
         if (strcmp(argv[arg_idx], "--batch-size") == 0 && arg_idx + 1 < argc) {
             batch_size = parse_number(argv[arg_idx + 1]);
             arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--shard") == 0 && arg_idx + 1 < argc) {
+            if (!shard_parse(argv[arg_idx + 1], &shard_index, &shard_count)) {
+                fprintf(stderr, "Error: --shard needs I/K with 1 <= I <= K <= %d\n",
+                        SHARD_MAX);
+                return 1;
+            }
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--results") == 0 && arg_idx + 1 < argc) {
+            results_path = argv[arg_idx + 1];
+            arg_idx += 2;
         } else if (argv[arg_idx][0] == '-') {
             fprintf(stderr, "Unknown option: %s\n", argv[arg_idx]);
             print_usage(argv[0]);
@@ -176,6 +210,16 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    uint64_t full_start = n_start, full_end = n_end;
+    if (shard_count > 0) {
+        shard_bounds(full_start, full_end, shard_index, shard_count, &n_start, &n_end);
+        if (n_start >= n_end) {
+            fprintf(stderr, "Error: shard %u/%u of [%s, %s) is empty\n", shard_index,
+                    shard_count, fmt_num(full_start), fmt_num(full_end));
+            return 1;
+        }
+    }
+
     if (batch_size < 1024) {
         fprintf(stderr, "Warning: batch_size too small, using 1024\n");
         batch_size = 1024;
@@ -186,6 +230,13 @@ int main(int argc, char** argv) {
 
     printf("Configuration:\n");
     printf("  Range: n in [%s, %s)\n", fmt_num(n_start), fmt_num(n_end));
+    if (shard_count > 0) {
+        printf("  Shard: %u of %u of [%s, %s)\n", shard_index, shard_count,
+               fmt_num(full_start), fmt_num(full_end));
+    }
+    if (results_path) {
+        printf("  Results: %s (CSV)\n", results_path);
+    }
     printf("  Count: %s values\n", fmt_num(total));
     printf("  Batch size: %s\n", fmt_num(batch_size));
     printf("  Number of batches: %s\n", fmt_num(num_batches));
@@ -198,11 +249,20 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    ResultLog results;
+    if (results_path && !result_log_open(&results, results_path, 1)) {
+        fprintf(stderr, "Error: cannot write results file %s\n", results_path);
+        batch_sieve_destroy(bs);
+        return 1;
+    }
+
     /* Statistics */
     uint64_t total_solved = 0;
     uint64_t total_mr_saved = 0;
     uint64_t total_mr_done = 0;
     uint64_t total_counterexamples = 0;
+    RecordTracker records;
+    records_init(&records);
 
     /* Run search */
     printf("Starting batched search...\n\n");
@@ -218,6 +278,9 @@ int main(int argc, char** argv) {
     uint64_t batches_processed = 0;
 
     for (uint64_t batch_start = n_start; batch_start < n_end; batch_start += batch_size) {
+        double batch_time = results_path ? get_wall_time() : 0.0;
+        uint64_t batch_counterexamples = total_counterexamples;
+
         /* Calculate actual batch size (may be smaller for last batch) */
         uint64_t actual_batch_size = batch_size;
         if (batch_start + batch_size > n_end) {
@@ -235,6 +298,19 @@ int main(int argc, char** argv) {
         total_mr_done += bs->mr_tests_done;
         batches_processed++;
 
+        /* Offer every solved n to the record tables (a_max tracked incrementally) */
+        uint64_t N_idx = 8 * batch_start + 3;
+        uint64_t a_max_idx = isqrt64(N_idx);
+        if ((a_max_idx & 1) == 0) a_max_idx--;
+        for (uint64_t idx = 0; idx < actual_batch_size; idx++) {
+            if (bs->solved[idx]) {
+                records_observe(&records, batch_start + idx, bs->solutions_a[idx],
+                                a_max_idx, N_idx);
+            }
+            N_idx += 8;
+            if ((a_max_idx + 2) * (a_max_idx + 2) <= N_idx) a_max_idx += 2;
+        }
+
         /* Check for counterexamples */
         if (bs->total_solved < actual_batch_size) {
             /* Verify unsolved n values */
@@ -268,11 +344,25 @@ int main(int argc, char** argv) {
                     if (!found) {
                         printf("CONFIRMED: No solution exists!\n");
                         total_counterexamples++;
+                        if (results_path) {
+                            result_log_counterexample(&results, 0, n,
+                                                      get_wall_time() - global_start);
+                        }
                     }
                 }
             }
         }
 
+        /* One chunk row per batch (no per-a statistics in the batched walk) */
+        if (results_path) {
+            CheckpointStats stats = {0};
+            stats.n_processed = actual_batch_size;
+            stats.counterexamples = total_counterexamples - batch_counterexamples;
+            double done_time = get_wall_time();
+            result_log_chunk(&results, 0, batch_start, batch_start + actual_batch_size,
+                             &stats, batch_time - global_start, done_time - batch_time);
+        }
+
         /* Progress reporting */
         double now;
 #ifdef _OPENMP
@@ -323,6 +413,17 @@ int main(int argc, char** argv) {
     printf("  MR tests saved:     %s (%.1f%%)\n", fmt_num(total_mr_saved), save_rate);
     printf("  MR tests performed: %s (%.1f%%)\n", fmt_num(total_mr_done), 100.0 - save_rate);
 
+    records_print(&records);
+
+    if (results_path) {
+        ResultRecord summary = {RESULT_SUMMARY, 1, n_start, n_end,
+                                {total, 0, total_counterexamples, 0, 0},
+                                0.0, global_elapsed, NULL};
+        if (!result_log_close(&results, &summary, &records)) {
+            fprintf(stderr, "Warning: results file %s is incomplete\n", results_path);
+        }
+    }
+
     /* Clean up */
     batch_sieve_destroy(bs);
 